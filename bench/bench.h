@@ -0,0 +1,34 @@
+// Microbenchmarks for the Oculus Rift renderer (imgui_impl_ovr)
+// Each suite runs standalone without an HMD, prints its results to stdout and records them for the JSON and CSV
+// reports. Suites that render create their own GL context, a software one unless asked otherwise.
+
+#pragma once
+
+#include <vector>
+
+// Options shared by every suite, set from the command line
+struct BenchOptions
+{
+	int Frames = 300;				// measured frames per case, for suites that render frames
+	int WarmupFrames = 30;			// frames rendered before measuring, to fill caches and settle allocations
+	bool SoftwareGL = true;			// ask for a software rasterizer (Mesa llvmpipe), so results don't depend on the GPU
+};
+
+extern BenchOptions g_BenchOptions;
+
+void Bench_Fonts();
+void Bench_HitTest();
+void Bench_Renderer();
+void Bench_Upload();
+
+// GL context without a window, see bench_gl.cpp
+bool Bench_CreateGLContext(bool software);
+void Bench_DestroyGLContext();
+void* Bench_GetCurrentGLContext();
+
+// Results, see bench_report.cpp
+void Bench_SetInfo(const char* key, const char* value);
+void Bench_Record(const char* suite, const char* benchCase, const char* metric, const char* unit, const std::vector<double>& samples);
+double Bench_Percentile(std::vector<double> samples, double percentile);
+bool Bench_WriteJson(const char* path);
+bool Bench_WriteCsv(const char* path);
@@ -0,0 +1,274 @@
+// Font atlas microbenchmark for the Oculus Rift renderer (imgui_impl_ovr)
+// Draws the same panel of text at several canvas resolutions with a coverage atlas baked at the drawn size, a coverage
+// atlas baked once and scaled, and a signed distance field atlas baked once and scaled. Each panel is rasterized into
+// the canvas and drawn into an eye buffer like a frame on the HMD, and compared with a reference drawn at a much higher
+// canvas resolution. Reports the atlas memory of each and the smallest canvas that reads like the reference.
+
+#include "bench.h"
+#include "GL.h"
+#include "imgui.h"
+#include "imgui_impl_ovr.h"
+#include "SimHmdBackend.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <cstdio>
+
+// Size of the eye buffer the panel is drawn into, a Rift CV1 eye buffer at 1 pixel per display pixel
+#define BENCH_FONTS_EYE_WIDTH 1344
+#define BENCH_FONTS_EYE_HEIGHT 1600
+
+// Virtual canvas size and pixels per unit at a canvas scale of 1. Other scales multiply both, so the panel keeps its
+// size in the world and only the canvas resolution changes. Half a meter away it's about 1.7 eye pixels per canvas pixel.
+#define BENCH_FONTS_CANVAS_WIDTH 512
+#define BENCH_FONTS_CANVAS_HEIGHT 256
+#define BENCH_FONTS_PIXELS_PER_UNIT 1600.f
+#define BENCH_FONTS_DISTANCE 0.5f
+
+// Font size at a canvas scale of 1, the size of ImGui's default font
+#define BENCH_FONTS_FONT_SIZE 13.f
+
+// Canvas scale of the reference, and the RMS difference from it in the eye buffer under which text counts as legible
+#define BENCH_FONTS_REFERENCE_SCALE 4.f
+#define BENCH_FONTS_LEGIBLE_RMS 0.04
+
+// GUI frames drawn for each measurement, so ImGui has laid out the window before the one that is read back
+#define BENCH_FONTS_FRAMES 3
+
+// How a configuration gets its text to the drawn size
+struct BenchFontsConfig
+{
+	const char* Name;
+	bool Sdf;				// signed distance field atlas, see ImGui_ImplOvr_SetSdfFontAtlas()
+	bool BakeAtScale;		// bake the font at the drawn size, rather than once at BENCH_FONTS_FONT_SIZE and scaled
+};
+
+static const BenchFontsConfig g_Configs[] = {
+	{ "coverage_baked", false, true },
+	{ "coverage_scaled", false, false },
+	{ "sdf_scaled", true, false },
+};
+
+static const float g_CanvasScales[] = { 0.5f, 0.75f, 1.f, 1.25f, 1.5f, 2.f, 3.f };
+
+static const char* const g_Text =
+	"The quick brown fox jumps over the lazy dog. 0123456789 (){}[]<>\n"
+	"Pack my box with five dozen liquor jugs! @#$%^&*-+=/\\|~;:'\",.?\n"
+	"Sphinx of black quartz, judge my vow. THE FIVE BOXING WIZARDS JUMP\n"
+	"How vexingly quick daft zebras jump; waltz, bad nymph, for quick\n"
+	"jigs vex. Glib jocks quiz nymph to vex dwarf. Jived fox nymph grabs\n"
+	"quick waltz. Bright vixens jump; dozy fowl quack. iIl1|! oO0 rnm\n"
+	"The quick brown fox jumps over the lazy dog. 0123456789 (){}[]<>\n"
+	"Pack my box with five dozen liquor jugs! @#$%^&*-+=/\\|~;:'\",.?\n"
+	"Sphinx of black quartz, judge my vow. THE FIVE BOXING WIZARDS JUMP\n"
+	"How vexingly quick daft zebras jump; waltz, bad nymph, for quick\n"
+	"jigs vex. Glib jocks quiz nymph to vex dwarf. Jived fox nymph grabs\n"
+	"quick waltz. Bright vixens jump; dozy fowl quack. iIl1|! oO0 rnm\n"
+	"The quick brown fox jumps over the lazy dog. 0123456789 (){}[]<>\n"
+	"Pack my box with five dozen liquor jugs! @#$%^&*-+=/\\|~;:'\",.?\n"
+	"Sphinx of black quartz, judge my vow. THE FIVE BOXING WIZARDS JUMP\n"
+	"How vexingly quick daft zebras jump; waltz, bad nymph, for quick\n";
+
+/**
+ * @brief Rebuild the font atlas with ImGui's default font at a size, and upload it as a coverage or distance field atlas.
+ *
+ * @param size The font size in pixels
+ * @param sdf True for a signed distance field atlas
+ * @return The memory used by the atlas texture in bytes
+ */
+static unsigned long long Bench_BuildFont(float size, bool sdf)
+{
+	ImGuiIO& io = ImGui::GetIO();
+	ImGui_ImplOvr_DestroyFontsTexture();
+	io.Fonts->Clear();
+	ImFontConfig config;
+	config.SizePixels = size;
+	io.Fonts->AddFontDefault(&config);
+	ImGui_ImplOvr_SetSdfFontAtlas(sdf);
+	ImGui_ImplOvr_CreateFontsTexture();
+
+	ImGui_ImplOvr_FontAtlasStats stats;
+	ImGui_ImplOvr_GetFontAtlasStats(&stats);
+	return stats.Bytes;
+}
+
+/**
+ * @brief Draw the text panel at a canvas scale into the eye buffer and read back the luminance of the panel's pixels.
+ *
+ * @param canvasScale Canvas resolution relative to BENCH_FONTS_CANVAS_WIDTH x BENCH_FONTS_CANVAS_HEIGHT
+ * @param fontScale io.FontGlobalScale, the drawn font size over the size the atlas was baked at
+ * @param eyeFBO The eye buffer
+ * @param frameIndex The frame index passed to ImGui_ImplOvr_Init()
+ * @param out_pixels Set to the red channel of the panel in the eye buffer, the text is white on the window background
+ */
+static void Bench_DrawPanel(float canvasScale, float fontScale, GLuint eyeFBO, long long* frameIndex, std::vector<unsigned char>* out_pixels)
+{
+	ImGui_ImplOvr_SetVirtualCanvasSize(glm::ivec2((int)roundf(BENCH_FONTS_CANVAS_WIDTH * canvasScale), (int)roundf(BENCH_FONTS_CANVAS_HEIGHT * canvasScale)));
+	ImGui_ImplOvr_SetPixelsPerUnit(BENCH_FONTS_PIXELS_PER_UNIT * canvasScale);
+	ImGui::GetIO().FontGlobalScale = fontScale;
+
+	const glm::mat4 model = glm::translate(glm::mat4(1), glm::vec3(0.f, 0.f, -BENCH_FONTS_DISTANCE));
+	const glm::mat4 view = glm::mat4(1);
+	const glm::mat4 proj = glm::perspective(glm::radians(100.f), (float)BENCH_FONTS_EYE_WIDTH / BENCH_FONTS_EYE_HEIGHT, 0.01f, 100.f);
+
+	for (int frame = 0; frame < BENCH_FONTS_FRAMES; frame++)
+	{
+		(*frameIndex)++;
+		ImGui_ImplOvr_NewFrame(model);
+		ImGui::NewFrame();
+		ImGui::SetNextWindowPos(ImVec2(0.f, 0.f), ImGuiCond_Always);
+		ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize, ImGuiCond_Always);
+		ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.f, 0.f));
+		ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.f);
+		ImGui::Begin("Text", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove
+			| ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoSavedSettings);
+		ImGui::TextUnformatted(g_Text);
+		ImGui::End();
+		ImGui::PopStyleVar(2);
+		ImGui_ImplOvr_Update();
+		ImGui::Render();
+		ImGui_ImplOvr_RenderDrawData(ImGui::GetDrawData());
+
+		glBindFramebuffer(GL_FRAMEBUFFER, eyeFBO);
+		glViewport(0, 0, BENCH_FONTS_EYE_WIDTH, BENCH_FONTS_EYE_HEIGHT);
+		glClearColor(0.f, 0.f, 0.f, 1.f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		ImGui_ImplOvr_RenderGUIQuad(proj, view, model);
+	}
+
+	// the panel's rectangle in the eye buffer, it's the same at every canvas scale
+	const glm::vec2 halfSize = glm::vec2(BENCH_FONTS_CANVAS_WIDTH, BENCH_FONTS_CANVAS_HEIGHT) / BENCH_FONTS_PIXELS_PER_UNIT;
+	const glm::vec4 corner = proj * glm::vec4(halfSize, -BENCH_FONTS_DISTANCE, 1.f);
+	const int width = (int)(corner.x / corner.w * BENCH_FONTS_EYE_WIDTH);
+	const int height = (int)(corner.y / corner.w * BENCH_FONTS_EYE_HEIGHT);
+
+	std::vector<unsigned char> rgba((size_t)width * height * 4);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels((BENCH_FONTS_EYE_WIDTH - width) / 2, (BENCH_FONTS_EYE_HEIGHT - height) / 2, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	out_pixels->resize((size_t)width * height);
+	for (size_t i = 0; i < out_pixels->size(); i++)
+	{
+		(*out_pixels)[i] = rgba[i * 4];
+	}
+}
+
+/**
+ * @brief The root mean square difference between two images of the panel.
+ *
+ * @param a The first image
+ * @param b The second image, the same size
+ * @return The RMS difference, 0 to 1
+ */
+static double Bench_RmsDifference(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b)
+{
+	double sum = 0.0;
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		const double difference = (a[i] - b[i]) / 255.0;
+		sum += difference * difference;
+	}
+	return a.empty() ? 0.0 : sqrt(sum / a.size());
+}
+
+/**
+ * @brief Draw the text panel with each font configuration at every canvas scale, and record the atlas memory and the
+ * difference from the reference at each, and the smallest canvas scale at which each is legible.
+ */
+void Bench_Fonts()
+{
+	if (!Bench_CreateGLContext(g_BenchOptions.SoftwareGL))
+	{
+		fprintf(stderr, "ERROR: Bench_Fonts: no GL context, skipping\n");
+		return;
+	}
+	printf("GL renderer: %s\n", reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+
+	SimHmdBackend hmd;
+	hmd.init();
+	long long frameIndex = 0;
+
+	ImGui::CreateContext();
+	ImGui::GetIO().Fonts->AddFontDefault();
+	ImGui_ImplOvr_SetCurrentContextFunc(Bench_GetCurrentGLContext);
+	ImGui_ImplOvr_SetGuiUpdateMode(ImGuiVrGuiUpdateMode_EveryFrame);
+	ImGui_ImplOvr_Init(&hmd, &frameIndex);
+
+	// the canvas is redrawn at exactly its virtual size whenever the font changes
+	ImGui_ImplOvr_SetCanvasCaching(false);
+	ImGui_ImplOvr_SetDamageTracking(false);
+	ImGui_ImplOvr_SetAdaptiveCanvasResolution(false);
+
+	GLuint eyeTextures[2], eyeFBO;
+	glGenTextures(2, eyeTextures);
+	glBindTexture(GL_TEXTURE_2D, eyeTextures[0]);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_SRGB8_ALPHA8, BENCH_FONTS_EYE_WIDTH, BENCH_FONTS_EYE_HEIGHT);
+	glBindTexture(GL_TEXTURE_2D, eyeTextures[1]);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT24, BENCH_FONTS_EYE_WIDTH, BENCH_FONTS_EYE_HEIGHT);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glGenFramebuffers(1, &eyeFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, eyeFBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, eyeTextures[0], 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, eyeTextures[1], 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	std::vector<unsigned char> reference, pixels;
+	Bench_BuildFont(BENCH_FONTS_FONT_SIZE * BENCH_FONTS_REFERENCE_SCALE, false);
+	Bench_DrawPanel(BENCH_FONTS_REFERENCE_SCALE, 1.f, eyeFBO, &frameIndex, &reference);
+
+	printf("%-20s %12s %12s %12s\n", "case", "canvas_scale", "atlas_bytes", "rms_error");
+	for (const BenchFontsConfig& config : g_Configs)
+	{
+		if (!config.BakeAtScale)
+		{
+			Bench_BuildFont(BENCH_FONTS_FONT_SIZE, config.Sdf);
+		}
+
+		float legibleScale = 0.f;
+		unsigned long long legibleAtlasBytes = 0;
+		for (float canvasScale : g_CanvasScales)
+		{
+			unsigned long long atlasBytes;
+			if (config.BakeAtScale)
+			{
+				atlasBytes = Bench_BuildFont(BENCH_FONTS_FONT_SIZE * canvasScale, config.Sdf);
+				Bench_DrawPanel(canvasScale, 1.f, eyeFBO, &frameIndex, &pixels);
+			}
+			else
+			{
+				ImGui_ImplOvr_FontAtlasStats stats;
+				ImGui_ImplOvr_GetFontAtlasStats(&stats);
+				atlasBytes = stats.Bytes;
+				Bench_DrawPanel(canvasScale, canvasScale, eyeFBO, &frameIndex, &pixels);
+			}
+			const double rms = Bench_RmsDifference(pixels, reference);
+			if (legibleScale == 0.f && rms < BENCH_FONTS_LEGIBLE_RMS)
+			{
+				legibleScale = canvasScale;
+				legibleAtlasBytes = atlasBytes;
+			}
+
+			char caseName[64];
+			snprintf(caseName, sizeof(caseName), "%s_%.2fx", config.Name, canvasScale);
+			printf("%-20s %12.2f %12llu %12.4f\n", caseName, canvasScale, atlasBytes, rms);
+			Bench_Record("fonts", caseName, "atlas_bytes", "bytes", { (double)atlasBytes });
+			Bench_Record("fonts", caseName, "rms_error", "fraction", { rms });
+		}
+
+		// 0 if the configuration never got within BENCH_FONTS_LEGIBLE_RMS of the reference
+		const double canvasPixels = legibleScale * legibleScale * BENCH_FONTS_CANVAS_WIDTH * BENCH_FONTS_CANVAS_HEIGHT;
+		printf("%-20s legible from a canvas scale of %.2f (%.0f canvas pixels, %llu atlas bytes)\n", config.Name, legibleScale, canvasPixels, legibleAtlasBytes);
+		Bench_Record("fonts", config.Name, "legible_canvas_scale", "x", { legibleScale });
+		Bench_Record("fonts", config.Name, "legible_canvas_pixels", "pixels", { canvasPixels });
+		Bench_Record("fonts", config.Name, "legible_atlas_bytes", "bytes", { (double)legibleAtlasBytes });
+	}
+
+	ImGui_ImplOvr_SetSdfFontAtlas(false);
+	glDeleteFramebuffers(1, &eyeFBO);
+	glDeleteTextures(2, eyeTextures);
+	ImGui_ImplOvr_Shutdown();
+	ImGui::DestroyContext();
+	Bench_DestroyGLContext();
+}
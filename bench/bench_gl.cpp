@@ -0,0 +1,145 @@
+// GL context for the Oculus Rift renderer microbenchmarks (imgui_impl_ovr)
+// Suites render into FBOs only, so the context has no window: a surfaceless EGL context on Linux, a hidden GLFW
+// window elsewhere. A software rasterizer keeps results comparable between machines; on Linux Mesa's llvmpipe is
+// picked with LIBGL_ALWAYS_SOFTWARE, on Windows put Mesa's opengl32.dll next to the executable.
+
+#include "bench.h"
+#include "GL.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef __linux__
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+static EGLDisplay g_Display = EGL_NO_DISPLAY;
+static EGLContext g_Context = EGL_NO_CONTEXT;
+#else
+static GLFWwindow* g_Window = nullptr;
+#endif
+
+/**
+ * @brief Create a GL 4.3 core context without a window and make it current.
+ *
+ * @param software True to ask for a software rasterizer
+ * @return True if the context is current
+ */
+bool Bench_CreateGLContext(bool software)
+{
+#ifdef __linux__
+	if (software)
+	{
+		setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1);
+	}
+
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+	if (getPlatformDisplay)
+	{
+		g_Display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	}
+	if (g_Display == EGL_NO_DISPLAY || !eglInitialize(g_Display, nullptr, nullptr))
+	{
+		fprintf(stderr, "ERROR: Bench_CreateGLContext: can't init a surfaceless EGL display\n");
+		g_Display = EGL_NO_DISPLAY;
+		return false;
+	}
+
+	const EGLint contextAttribs[] =
+	{
+		EGL_CONTEXT_MAJOR_VERSION, 4,
+		EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+	eglBindAPI(EGL_OPENGL_API);
+	g_Context = eglCreateContext(g_Display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttribs);
+	if (g_Context == EGL_NO_CONTEXT || !eglMakeCurrent(g_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, g_Context))
+	{
+		fprintf(stderr, "ERROR: Bench_CreateGLContext: can't create a GL 4.3 context\n");
+		Bench_DestroyGLContext();
+		return false;
+	}
+
+	if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(eglGetProcAddress)))
+	{
+		fprintf(stderr, "ERROR: Bench_CreateGLContext: can't load GL functions\n");
+		Bench_DestroyGLContext();
+		return false;
+	}
+#else
+	// the rasterizer is whichever opengl32.dll is loaded, nothing to ask for here
+	(void)software;
+
+	if (!glfwInit())
+	{
+		fprintf(stderr, "ERROR: Bench_CreateGLContext: can't init GLFW\n");
+		return false;
+	}
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	g_Window = glfwCreateWindow(64, 64, "imgui-ovr-bench", nullptr, nullptr);
+	if (!g_Window)
+	{
+		fprintf(stderr, "ERROR: Bench_CreateGLContext: can't create a GL 4.3 context\n");
+		glfwTerminate();
+		return false;
+	}
+	glfwMakeContextCurrent(g_Window);
+	glfwSwapInterval(0);
+
+	if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress)))
+	{
+		fprintf(stderr, "ERROR: Bench_CreateGLContext: can't load GL functions\n");
+		Bench_DestroyGLContext();
+		return false;
+	}
+#endif
+
+	Bench_SetInfo("gl_vendor", reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+	Bench_SetInfo("gl_renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+	Bench_SetInfo("gl_version", reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+	return true;
+}
+
+/**
+ * @brief Destroy the context made by Bench_CreateGLContext().
+ */
+void Bench_DestroyGLContext()
+{
+#ifdef __linux__
+	if (g_Display == EGL_NO_DISPLAY) return;
+
+	eglMakeCurrent(g_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	if (g_Context != EGL_NO_CONTEXT)
+	{
+		eglDestroyContext(g_Display, g_Context);
+		g_Context = EGL_NO_CONTEXT;
+	}
+	eglTerminate(g_Display);
+	g_Display = EGL_NO_DISPLAY;
+#else
+	if (!g_Window) return;
+
+	glfwDestroyWindow(g_Window);
+	glfwTerminate();
+	g_Window = nullptr;
+#endif
+}
+
+/**
+ * @brief Get a key for the current GL context, for ImGui_ImplOvr_SetCurrentContextFunc().
+ *
+ * @return The current context, or nullptr if there isn't one
+ */
+void* Bench_GetCurrentGLContext()
+{
+#ifdef __linux__
+	return eglGetCurrentContext();
+#else
+	return glfwGetCurrentContext();
+#endif
+}
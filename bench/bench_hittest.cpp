@@ -0,0 +1,103 @@
+// Ray hit testing microbenchmark for the Oculus Rift renderer (imgui_impl_ovr)
+// Casts random rays into a cloud of randomly placed panels and reports rays per second, testing every panel
+// against using the BVH.
+
+#include "bench.h"
+#include "imgui_impl_ovr_hittest.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Rays cast per measurement, enough for a few milliseconds at the largest panel count
+#define BENCH_HITTEST_RAYS 20000
+
+/**
+ * @brief Place panels at random in a 10m cube around the origin, facing random directions, with sizes between
+ * 0.2m and 1m.
+ *
+ * @param tester The hit tester to set the panels of
+ * @param count The number of panels
+ * @param rng The random number generator
+ */
+static void Bench_PlacePanels(ImGui_ImplOvr_HitTester& tester, int count, std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> position(-5.f, 5.f), angle(0.f, 6.2831853f), size(0.1f, 0.5f);
+	tester.SetPanelCount(count);
+	for (int i = 0; i < count; i++)
+	{
+		glm::mat4 model = glm::translate(glm::mat4(1), glm::vec3(position(rng), position(rng), position(rng)));
+		model = glm::rotate(model, angle(rng), glm::vec3(0, 1, 0));
+		model = glm::rotate(model, angle(rng), glm::vec3(1, 0, 0));
+		tester.SetPanel(i, glm::scale(model, glm::vec3(size(rng), size(rng), 1.f)));
+	}
+}
+
+/**
+ * @brief Cast the rays and time them.
+ *
+ * @param tester The hit tester to cast the rays with
+ * @param origins The origins of the rays
+ * @param dirs The directions of the rays
+ * @param useBvh Passed on to ImGui_ImplOvr_HitTester::CastRay()
+ * @param out_hits The number of rays that hit a panel
+ * @return Rays per second
+ */
+static double Bench_CastRays(ImGui_ImplOvr_HitTester& tester, const std::vector<glm::vec3>& origins,
+	const std::vector<glm::vec3>& dirs, bool useBvh, int* out_hits)
+{
+	int hits = 0;
+	const auto start = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < origins.size(); i++)
+	{
+		hits += tester.CastRay(origins[i], dirs[i], useBvh).Panel >= 0;
+	}
+	const std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+	*out_hits = hits;
+	return origins.size() / elapsed.count();
+}
+
+/**
+ * @brief Report rays per second for 1, 16, 256 and 4096 panels, testing every panel and using the BVH.
+ */
+void Bench_HitTest()
+{
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> position(-6.f, 6.f), direction(-1.f, 1.f);
+
+	std::vector<glm::vec3> origins(BENCH_HITTEST_RAYS), dirs(BENCH_HITTEST_RAYS);
+	for (int i = 0; i < BENCH_HITTEST_RAYS; i++)
+	{
+		origins[i] = glm::vec3(position(rng), position(rng), position(rng));
+		dirs[i] = glm::normalize(glm::vec3(direction(rng), direction(rng), direction(rng)));
+	}
+
+	printf("%8s %16s %16s %8s\n", "panels", "all rays/s", "bvh rays/s", "hits");
+	const int panelCounts[] = { 1, 16, 256, 4096 };
+	for (int count : panelCounts)
+	{
+		ImGui_ImplOvr_HitTester tester;
+		Bench_PlacePanels(tester, count, rng);
+
+		// the first cast builds the packets and BVH, keep it out of the measurements
+		tester.CastRay(origins[0], dirs[0]);
+
+		int hitsAll, hitsBvh;
+		const double raysAll = Bench_CastRays(tester, origins, dirs, false, &hitsAll);
+		const double raysBvh = Bench_CastRays(tester, origins, dirs, true, &hitsBvh);
+		if (hitsAll != hitsBvh)
+		{
+			fprintf(stderr, "ERROR: Bench_HitTest: %d panels, %d hits testing every panel but %d using the BVH\n", count, hitsAll, hitsBvh);
+		}
+		printf("%8d %16.0f %16.0f %8d\n", count, raysAll, raysBvh, hitsBvh);
+
+		char benchCase[32];
+		snprintf(benchCase, sizeof(benchCase), "panels_%d", count);
+		Bench_Record("hittest", benchCase, "all_rays_per_second", "rays/s", { raysAll });
+		Bench_Record("hittest", benchCase, "bvh_rays_per_second", "rays/s", { raysBvh });
+	}
+}
@@ -0,0 +1,100 @@
+// Microbenchmarks for the Oculus Rift renderer (imgui_impl_ovr)
+// Runs every suite, or only the ones named on the command line, and writes the results as JSON or CSV.
+//
+// Options:
+//   --json <file>     write every result to a JSON report
+//   --csv <file>      write every result to a CSV report
+//   --frames <n>      measured frames per case, for suites that render frames
+//   --warmup <n>      frames rendered before measuring
+//   --hardware-gl     render with the default GL driver instead of asking for a software rasterizer
+
+#include "bench.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+struct BenchSuite
+{
+	const char* Name;
+	void (*Run)();
+};
+
+static const BenchSuite g_Suites[] = {
+	{ "fonts", Bench_Fonts },
+	{ "hittest", Bench_HitTest },
+	{ "renderer", Bench_Renderer },
+	{ "upload", Bench_Upload },
+};
+
+BenchOptions g_BenchOptions;
+
+int main(int argc, char** argv)
+{
+	const char* jsonPath = nullptr;
+	const char* csvPath = nullptr;
+	std::vector<const char*> selected;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+		{
+			jsonPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc)
+		{
+			csvPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+		{
+			g_BenchOptions.Frames = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+		{
+			g_BenchOptions.WarmupFrames = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--hardware-gl") == 0)
+		{
+			g_BenchOptions.SoftwareGL = false;
+		}
+		else
+		{
+			selected.push_back(argv[i]);
+		}
+	}
+
+	int run = 0;
+	for (const BenchSuite& suite : g_Suites)
+	{
+		bool match = selected.empty();
+		for (size_t i = 0; i < selected.size() && !match; i++)
+		{
+			match = strcmp(selected[i], suite.Name) == 0;
+		}
+		if (!match) continue;
+
+		printf("== %s ==\n", suite.Name);
+		suite.Run();
+		run++;
+	}
+
+	if (run == 0)
+	{
+		fprintf(stderr, "ERROR: main: no benchmark suite matches the arguments, available suites are:\n");
+		for (const BenchSuite& suite : g_Suites)
+		{
+			fprintf(stderr, "  %s\n", suite.Name);
+		}
+		return 1;
+	}
+
+	bool written = true;
+	if (jsonPath)
+	{
+		written &= Bench_WriteJson(jsonPath);
+	}
+	if (csvPath)
+	{
+		written &= Bench_WriteCsv(csvPath);
+	}
+	return written ? 0 : 1;
+}
@@ -0,0 +1,451 @@
+// Renderer microbenchmark for the Oculus Rift renderer (imgui_impl_ovr)
+// Builds synthetic GUIs that scale up in size, many windows of widgets, big tables, dense plots and walls of text,
+// and times each stage of a GUI frame on the CPU: the pointer ray cast, building the GUI, ImGui::Render(),
+// rasterizing the canvas and drawing the canvas quad into an eye buffer. Runs on a simulated HMD.
+// The upload suite renders a few of the same GUIs once per vertex/index upload mode and compares their throughput.
+
+#include "bench.h"
+#include "GL.h"
+#include "imgui.h"
+#include "imgui_impl_ovr.h"
+#include "SimHmdBackend.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+// Size of the eye buffer the canvas quad is drawn into, a Rift CV1 eye buffer at 1 pixel per display pixel
+#define BENCH_RENDERER_EYE_WIDTH 1344
+#define BENCH_RENDERER_EYE_HEIGHT 1600
+
+// Largest sizes any case builds, for the widget state and plot data shared by every case
+#define BENCH_RENDERER_MAX_WIDGETS 4096
+#define BENCH_RENDERER_MAX_PLOT_POINTS 20000
+
+// A synthetic GUI at one size
+struct BenchRendererCase
+{
+	const char* Name;
+	void (*Build)(int a, int b, int frame);
+	int A, B;
+};
+
+// Stages of a GUI frame, timed separately
+enum BenchRendererStage
+{
+	BenchRendererStage_UpdatePointer,	// ImGui_ImplOvr_UpdatePointer(), the controller ray cast (UpdateMousePos)
+	BenchRendererStage_Build,			// ImGui_ImplOvr_NewFrame() to ImGui_ImplOvr_Update(), the application's widget calls
+	BenchRendererStage_ImGuiRender,		// ImGui::Render()
+	BenchRendererStage_RenderDrawData,	// ImGui_ImplOvr_RenderDrawData(), rasterizing the canvas
+	BenchRendererStage_RenderGUIQuad,	// ImGui_ImplOvr_RenderGUIQuad(), drawing the canvas into an eye buffer
+	BenchRendererStage_Count
+};
+
+static const char* const g_StageNames[BenchRendererStage_Count] = {
+	"update_pointer", "build", "imgui_render", "render_draw_data", "render_gui_quad"
+};
+
+static bool g_Checkboxes[BENCH_RENDERER_MAX_WIDGETS];
+static float g_Sliders[BENCH_RENDERER_MAX_WIDGETS];
+static float g_PlotData[BENCH_RENDERER_MAX_PLOT_POINTS];
+
+static const char* const g_LoremIpsum = "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor "
+	"incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, quis nostrud exercitation ullamco laboris.";
+
+/**
+ * @brief Place the next window in a grid filling the canvas, so every window is at least partly visible.
+ *
+ * @param index The index of the window
+ * @param count The number of windows
+ */
+static void Bench_PlaceWindow(int index, int count)
+{
+	const ImVec2 display = ImGui::GetIO().DisplaySize;
+	const int columns = (int)ceilf(sqrtf((float)count));
+	const int rows = (count + columns - 1) / columns;
+	const ImVec2 size(display.x / columns, display.y / rows);
+	ImGui::SetNextWindowPos(ImVec2(size.x * (index % columns), size.y * (index / columns)), ImGuiCond_Always);
+	ImGui::SetNextWindowSize(size, ImGuiCond_Always);
+}
+
+/**
+ * @brief Windows of mixed widgets: buttons, checkboxes, sliders, progress bars and text that changes every frame.
+ *
+ * @param windows The number of windows
+ * @param widgets The number of widgets in each window
+ * @param frame The frame number
+ */
+static void Bench_BuildWindows(int windows, int widgets, int frame)
+{
+	char title[32];
+	for (int w = 0; w < windows; w++)
+	{
+		snprintf(title, sizeof(title), "Window %d", w);
+		Bench_PlaceWindow(w, windows);
+		ImGui::Begin(title);
+		for (int i = 0; i < widgets; i++)
+		{
+			const int id = (w * widgets + i) % BENCH_RENDERER_MAX_WIDGETS;
+			ImGui::PushID(i);
+			switch (i % 5)
+			{
+			case 0: ImGui::Button("Button"); break;
+			case 1: ImGui::Checkbox("Checkbox", &g_Checkboxes[id]); break;
+			case 2: ImGui::SliderFloat("Slider", &g_Sliders[id], 0.f, 1.f); break;
+			case 3: ImGui::ProgressBar(((frame + i) % 100) / 100.f); break;
+			default: ImGui::Text("Frame %d, widget %d", frame, i); break;
+			}
+			ImGui::PopID();
+		}
+		ImGui::End();
+	}
+}
+
+/**
+ * @brief One window holding a table of text and numbers, with every row submitted.
+ *
+ * @param columns The number of columns
+ * @param rows The number of rows
+ * @param frame The frame number
+ */
+static void Bench_BuildTable(int columns, int rows, int frame)
+{
+	Bench_PlaceWindow(0, 1);
+	ImGui::Begin("Table");
+	ImGui::Columns(columns, "table");
+	for (int row = 0; row < rows; row++)
+	{
+		for (int column = 0; column < columns; column++)
+		{
+			if (column == 0)
+			{
+				ImGui::Text("Row %d", row);
+			}
+			else
+			{
+				ImGui::Text("%.3f", (row * columns + column + frame) * 0.001f);
+			}
+			ImGui::NextColumn();
+		}
+	}
+	ImGui::Columns(1);
+	ImGui::End();
+}
+
+/**
+ * @brief One window of line plots, each scrolling through the plot data by a sample a frame.
+ *
+ * @param plots The number of plots
+ * @param points The number of points in each plot
+ * @param frame The frame number
+ */
+static void Bench_BuildPlots(int plots, int points, int frame)
+{
+	Bench_PlaceWindow(0, 1);
+	ImGui::Begin("Plots");
+	const float height = ImGui::GetContentRegionAvail().y / plots - ImGui::GetStyle().ItemSpacing.y;
+	for (int i = 0; i < plots; i++)
+	{
+		ImGui::PushID(i);
+		ImGui::PlotLines("", g_PlotData, points, (frame + i * 97) % points, nullptr, -1.f, 1.f, ImVec2(-1.f, height));
+		ImGui::PopID();
+	}
+	ImGui::End();
+}
+
+/**
+ * @brief One window with a wall of wrapped text.
+ *
+ * @param lines The number of paragraphs
+ * @param unused Unused
+ * @param frame The frame number
+ */
+static void Bench_BuildText(int lines, int unused, int frame)
+{
+	Bench_PlaceWindow(0, 1);
+	ImGui::Begin("Text");
+	ImGui::Text("Frame %d", frame);
+	for (int i = 0; i < lines; i++)
+	{
+		ImGui::TextWrapped("%d. %s", i, g_LoremIpsum);
+	}
+	ImGui::End();
+}
+
+static const BenchRendererCase g_Cases[] = {
+	{ "windows_4x16", Bench_BuildWindows, 4, 16 },
+	{ "windows_16x32", Bench_BuildWindows, 16, 32 },
+	{ "windows_64x64", Bench_BuildWindows, 64, 64 },
+	{ "table_8x200", Bench_BuildTable, 8, 200 },
+	{ "table_8x2000", Bench_BuildTable, 8, 2000 },
+	{ "table_16x5000", Bench_BuildTable, 16, 5000 },
+	{ "plots_4x1000", Bench_BuildPlots, 4, 1000 },
+	{ "plots_16x1000", Bench_BuildPlots, 16, 1000 },
+	{ "plots_16x20000", Bench_BuildPlots, 16, 20000 },
+	{ "text_200", Bench_BuildText, 200, 0 },
+	{ "text_2000", Bench_BuildText, 2000, 0 },
+	{ "text_10000", Bench_BuildText, 10000, 0 },
+};
+
+/**
+ * @brief Scripted poses: the head looks ahead and the right hand points at the panel, sweeping across it so the
+ * hovered widget keeps changing.
+ *
+ * @param userData Unused
+ * @param time Seconds since the simulated session started
+ * @param out_state Set to the poses
+ */
+static void Bench_RendererPoses(void* userData, double time, ovrTrackingState* out_state)
+{
+	const float yaw = 0.3f * sinf((float)time * 2.f);
+	out_state->HeadPose.ThePose.Orientation.w = 1.f;
+	out_state->HandPoses[ovrHand_Right].ThePose.Position = { 0.f, 0.f, 0.f };
+	out_state->HandPoses[ovrHand_Right].ThePose.Orientation = { 0.f, sinf(yaw / 2.f), 0.f, cosf(yaw / 2.f) };
+	out_state->HandPoses[ovrHand_Left].ThePose.Orientation.w = 1.f;
+}
+
+/**
+ * @brief The time, for timing stages.
+ *
+ * @return Seconds since the first call
+ */
+static double Bench_Now()
+{
+	static const auto start = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+/**
+ * @brief Render every case for the configured number of frames and record the CPU time of each stage, and the
+ * vertex count as a measure of the workload.
+ */
+void Bench_Renderer()
+{
+	if (!Bench_CreateGLContext(g_BenchOptions.SoftwareGL))
+	{
+		fprintf(stderr, "ERROR: Bench_Renderer: no GL context, skipping\n");
+		return;
+	}
+	printf("GL renderer: %s\n", reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+
+	for (int i = 0; i < BENCH_RENDERER_MAX_PLOT_POINTS; i++)
+	{
+		g_PlotData[i] = sinf(i * 0.05f) * cosf(i * 0.0031f);
+	}
+
+	SimHmdConfig config;
+	config.poses = Bench_RendererPoses;
+	SimHmdBackend hmd(config);
+	hmd.init();
+	long long frameIndex = 0;
+
+	ImGui::CreateContext();
+	ImGui::GetIO().Fonts->AddFontDefault();
+	ImGui_ImplOvr_SetCurrentContextFunc(Bench_GetCurrentGLContext);
+	ImGui_ImplOvr_SetGuiUpdateMode(ImGuiVrGuiUpdateMode_EveryFrame);
+	ImGui_ImplOvr_Init(&hmd, &frameIndex);
+
+	// every frame measures a full redraw of the canvas at its virtual size, not how much of it the renderer could skip
+	ImGui_ImplOvr_SetCanvasCaching(false);
+	ImGui_ImplOvr_SetDamageTracking(false);
+	ImGui_ImplOvr_SetAdaptiveCanvasResolution(false);
+
+	// the eye buffer the canvas quad is drawn into
+	GLuint eyeTextures[2], eyeFBO;
+	glGenTextures(2, eyeTextures);
+	glBindTexture(GL_TEXTURE_2D, eyeTextures[0]);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_SRGB8_ALPHA8, BENCH_RENDERER_EYE_WIDTH, BENCH_RENDERER_EYE_HEIGHT);
+	glBindTexture(GL_TEXTURE_2D, eyeTextures[1]);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT24, BENCH_RENDERER_EYE_WIDTH, BENCH_RENDERER_EYE_HEIGHT);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glGenFramebuffers(1, &eyeFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, eyeFBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, eyeTextures[0], 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, eyeTextures[1], 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	const glm::mat4 model = glm::translate(glm::mat4(1), glm::vec3(0.f, 0.f, -1.f));
+	const glm::mat4 view = glm::mat4(1);
+	const glm::mat4 proj = glm::perspective(glm::radians(100.f), (float)BENCH_RENDERER_EYE_WIDTH / BENCH_RENDERER_EYE_HEIGHT, 0.1f, 100.f);
+
+	printf("%-16s %10s", "case", "vertices");
+	for (const char* stage : g_StageNames)
+	{
+		printf(" %16s", stage);
+	}
+	printf("   (median ms)\n");
+
+	for (const BenchRendererCase& benchCase : g_Cases)
+	{
+		std::vector<double> samples[BenchRendererStage_Count];
+		std::vector<double> vertices;
+		for (int frame = -g_BenchOptions.WarmupFrames; frame < g_BenchOptions.Frames; frame++)
+		{
+			frameIndex++;
+			double times[BenchRendererStage_Count + 1];
+
+			times[0] = Bench_Now();
+			ImGui_ImplOvr_UpdatePointer(model);
+
+			times[1] = Bench_Now();
+			ImGui_ImplOvr_NewFrame(model);
+			ImGui::NewFrame();
+			benchCase.Build(benchCase.A, benchCase.B, frame);
+			ImGui_ImplOvr_Update();
+
+			times[2] = Bench_Now();
+			ImGui::Render();
+
+			times[3] = Bench_Now();
+			ImGui_ImplOvr_RenderDrawData(ImGui::GetDrawData());
+
+			times[4] = Bench_Now();
+			glBindFramebuffer(GL_FRAMEBUFFER, eyeFBO);
+			glViewport(0, 0, BENCH_RENDERER_EYE_WIDTH, BENCH_RENDERER_EYE_HEIGHT);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			ImGui_ImplOvr_RenderGUIQuad(proj, view, model);
+
+			times[5] = Bench_Now();
+
+			// wait for the GPU outside the timed stages, so one frame's GPU work isn't billed to the next
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			glFinish();
+
+			if (frame < 0) continue;
+			for (int stage = 0; stage < BenchRendererStage_Count; stage++)
+			{
+				samples[stage].push_back((times[stage + 1] - times[stage]) * 1000.0);
+			}
+			vertices.push_back(ImGui::GetDrawData()->TotalVtxCount);
+		}
+
+		printf("%-16s %10.0f", benchCase.Name, vertices.empty() ? 0.0 : vertices.back());
+		for (int stage = 0; stage < BenchRendererStage_Count; stage++)
+		{
+			printf(" %16.3f", Bench_Percentile(samples[stage], 50.0));
+			Bench_Record("renderer", benchCase.Name, g_StageNames[stage], "ms", samples[stage]);
+		}
+		printf("\n");
+		Bench_Record("renderer", benchCase.Name, "vertices", "count", vertices);
+	}
+
+	glDeleteFramebuffers(1, &eyeFBO);
+	glDeleteTextures(2, eyeTextures);
+	ImGui_ImplOvr_Shutdown();
+	ImGui::DestroyContext();
+	Bench_DestroyGLContext();
+}
+
+// Cases the upload suite runs in every upload mode, from a few hundred KB to several MB of vertices a frame
+static const BenchRendererCase g_UploadCases[] = {
+	{ "windows_16x32", Bench_BuildWindows, 16, 32 },
+	{ "table_8x2000", Bench_BuildTable, 8, 2000 },
+	{ "plots_16x20000", Bench_BuildPlots, 16, 20000 },
+	{ "text_2000", Bench_BuildText, 2000, 0 },
+};
+
+// Upload modes the upload suite compares, and their names in case names
+static const ImGuiVrUploadMode g_UploadModes[] = {
+	ImGuiVrUploadMode_Orphan, ImGuiVrUploadMode_PersistentRing, ImGuiVrUploadMode_Auto
+};
+static const char* const g_UploadModeNames[] = { "orphan", "persistent_ring", "auto" };
+
+/**
+ * @brief Rasterize each upload case's canvas in every upload mode for the configured number of frames and record
+ * the upload throughput, the bytes uploaded, the upload CPU time and the CPU time of ImGui_ImplOvr_RenderDrawData().
+ */
+void Bench_Upload()
+{
+	if (!Bench_CreateGLContext(g_BenchOptions.SoftwareGL))
+	{
+		fprintf(stderr, "ERROR: Bench_Upload: no GL context, skipping\n");
+		return;
+	}
+	printf("GL renderer: %s\n", reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+
+	for (int i = 0; i < BENCH_RENDERER_MAX_PLOT_POINTS; i++)
+	{
+		g_PlotData[i] = sinf(i * 0.05f) * cosf(i * 0.0031f);
+	}
+
+	SimHmdConfig config;
+	config.poses = Bench_RendererPoses;
+	SimHmdBackend hmd(config);
+	hmd.init();
+	long long frameIndex = 0;
+
+	ImGui::CreateContext();
+	ImGui::GetIO().Fonts->AddFontDefault();
+	ImGui_ImplOvr_SetCurrentContextFunc(Bench_GetCurrentGLContext);
+	ImGui_ImplOvr_SetGuiUpdateMode(ImGuiVrGuiUpdateMode_EveryFrame);
+	ImGui_ImplOvr_Init(&hmd, &frameIndex);
+
+	// every frame uploads and rasterizes the whole GUI, as in the renderer suite
+	ImGui_ImplOvr_SetCanvasCaching(false);
+	ImGui_ImplOvr_SetDamageTracking(false);
+	ImGui_ImplOvr_SetAdaptiveCanvasResolution(false);
+
+	const glm::mat4 model = glm::translate(glm::mat4(1), glm::vec3(0.f, 0.f, -1.f));
+
+	printf("%-32s %8s %12s %8s %8s %12s %12s %16s   (median)\n", "case", "ring", "bytes", "updates", "writes", "upload_ms", "MB/s",
+		"render_draw_data_ms");
+
+	for (const BenchRendererCase& benchCase : g_UploadCases)
+	{
+		for (int mode = 0; mode < IM_ARRAYSIZE(g_UploadModes); mode++)
+		{
+			ImGui_ImplOvr_SetUploadMode(g_UploadModes[mode]);
+			char caseName[64];
+			snprintf(caseName, sizeof(caseName), "%s_%s", benchCase.Name, g_UploadModeNames[mode]);
+
+			std::vector<double> throughput, bytes, bufferUpdates, ringWrites, uploadTimes, renderTimes;
+			bool persistentRing = false;
+			for (int frame = -g_BenchOptions.WarmupFrames; frame < g_BenchOptions.Frames; frame++)
+			{
+				frameIndex++;
+				ImGui_ImplOvr_UpdatePointer(model);
+				ImGui_ImplOvr_NewFrame(model);
+				ImGui::NewFrame();
+				benchCase.Build(benchCase.A, benchCase.B, frame);
+				ImGui_ImplOvr_Update();
+				ImGui::Render();
+				ImGui_ImplOvr_RenderDrawData(ImGui::GetDrawData());
+
+				// wait for the GPU between frames, so one frame's GPU work doesn't stall the next frame's uploads
+				glFinish();
+
+				if (frame < 0) continue;
+				ImGui_ImplOvr_UploadStats stats;
+				ImGui_ImplOvr_GetUploadStats(&stats);
+				persistentRing = stats.PersistentRing;
+				bytes.push_back((double)stats.BytesUploaded);
+				bufferUpdates.push_back((double)stats.BufferUpdates);
+				ringWrites.push_back((double)stats.RingWrites);
+				uploadTimes.push_back(stats.UploadCpuTimeMs);
+				renderTimes.push_back(stats.RenderCpuTimeMs);
+				if (stats.UploadCpuTimeMs > 0.0)
+				{
+					throughput.push_back(stats.BytesUploaded / (stats.UploadCpuTimeMs / 1000.0));
+				}
+			}
+
+			printf("%-32s %8s %12.0f %8.0f %8.0f %12.3f %12.1f %16.3f\n", caseName, persistentRing ? "yes" : "no",
+				Bench_Percentile(bytes, 50.0), Bench_Percentile(bufferUpdates, 50.0), Bench_Percentile(ringWrites, 50.0),
+				Bench_Percentile(uploadTimes, 50.0),
+				Bench_Percentile(throughput, 50.0) / (1024.0 * 1024.0), Bench_Percentile(renderTimes, 50.0));
+			Bench_Record("upload", caseName, "bytes_uploaded_per_s", "B/s", throughput);
+			Bench_Record("upload", caseName, "bytes_uploaded", "bytes", bytes);
+			Bench_Record("upload", caseName, "buffer_updates", "count", bufferUpdates);
+			Bench_Record("upload", caseName, "ring_writes", "count", ringWrites);
+			Bench_Record("upload", caseName, "upload_cpu_time", "ms", uploadTimes);
+			Bench_Record("upload", caseName, "render_cpu_time", "ms", renderTimes);
+		}
+	}
+
+	ImGui_ImplOvr_SetUploadMode(ImGuiVrUploadMode_Auto);
+	ImGui_ImplOvr_Shutdown();
+	ImGui::DestroyContext();
+	Bench_DestroyGLContext();
+}
@@ -0,0 +1,194 @@
+// Result reports for the Oculus Rift renderer microbenchmarks (imgui_impl_ovr)
+// Every suite records its samples here, summarised as count, mean, min, percentiles and max in JSON or CSV, so
+// results can be compared across releases and machines.
+
+#include "bench.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+// A metric of one benchmark case, e.g. the CPU time of ImGui::Render() with 16 windows
+struct BenchResult
+{
+	std::string Suite;
+	std::string Case;
+	std::string Metric;
+	std::string Unit;
+	int Count;
+	double Mean, Min, P50, P90, P99, Max;
+};
+
+static std::vector<BenchResult> g_Results;
+
+// Key/value pairs describing the run, e.g. the GL renderer, written at the top of the JSON report
+static std::vector<std::pair<std::string, std::string>> g_Info;
+
+/**
+ * @brief Set a value describing the run, replacing any earlier value of the key.
+ *
+ * @param key The name of the value
+ * @param value The value
+ */
+void Bench_SetInfo(const char* key, const char* value)
+{
+	for (auto& info : g_Info)
+	{
+		if (info.first == key)
+		{
+			info.second = value;
+			return;
+		}
+	}
+	g_Info.emplace_back(key, value);
+}
+
+/**
+ * @brief Get a percentile of the samples, interpolating between the nearest two.
+ *
+ * @param samples The samples, in any order
+ * @param percentile The percentile, from 0 to 100
+ * @return The percentile, or 0 if there are no samples
+ */
+double Bench_Percentile(std::vector<double> samples, double percentile)
+{
+	if (samples.empty()) return 0.0;
+
+	std::sort(samples.begin(), samples.end());
+	const double rank = percentile / 100.0 * (samples.size() - 1);
+	const size_t below = (size_t)rank;
+	const size_t above = std::min(below + 1, samples.size() - 1);
+	return samples[below] + (samples[above] - samples[below]) * (rank - below);
+}
+
+/**
+ * @brief Summarise the samples of a metric and add it to the report.
+ *
+ * @param suite The suite, e.g. "renderer"
+ * @param benchCase The case within the suite, e.g. "windows_16x32"
+ * @param metric What was measured, e.g. "imgui_render"
+ * @param unit The unit of the samples, e.g. "ms"
+ * @param samples One sample per measurement
+ */
+void Bench_Record(const char* suite, const char* benchCase, const char* metric, const char* unit, const std::vector<double>& samples)
+{
+	if (samples.empty()) return;
+
+	BenchResult result;
+	result.Suite = suite;
+	result.Case = benchCase;
+	result.Metric = metric;
+	result.Unit = unit;
+	result.Count = (int)samples.size();
+
+	double sum = 0.0;
+	for (double sample : samples)
+	{
+		sum += sample;
+	}
+	result.Mean = sum / samples.size();
+	result.Min = *std::min_element(samples.begin(), samples.end());
+	result.Max = *std::max_element(samples.begin(), samples.end());
+	result.P50 = Bench_Percentile(samples, 50.0);
+	result.P90 = Bench_Percentile(samples, 90.0);
+	result.P99 = Bench_Percentile(samples, 99.0);
+	g_Results.push_back(result);
+}
+
+/**
+ * @brief Write a string as a JSON string literal.
+ *
+ * @param file The file to write to
+ * @param str The string
+ */
+static void Bench_WriteJsonString(FILE* file, const std::string& str)
+{
+	fputc('"', file);
+	for (char c : str)
+	{
+		if (c == '"' || c == '\\')
+		{
+			fputc('\\', file);
+			fputc(c, file);
+		}
+		else if ((unsigned char)c < 0x20)
+		{
+			fprintf(file, "\\u%04x", c);
+		}
+		else
+		{
+			fputc(c, file);
+		}
+	}
+	fputc('"', file);
+}
+
+/**
+ * @brief Write every recorded result as a JSON object with the run's info and an array of results.
+ *
+ * @param path The path of the report
+ * @return True if the report was written
+ */
+bool Bench_WriteJson(const char* path)
+{
+	FILE* file = fopen(path, "w");
+	if (!file)
+	{
+		fprintf(stderr, "ERROR: Bench_WriteJson: can't create %s\n", path);
+		return false;
+	}
+
+	fprintf(file, "{\n  \"info\": {");
+	for (size_t i = 0; i < g_Info.size(); i++)
+	{
+		fprintf(file, "%s\n    ", i ? "," : "");
+		Bench_WriteJsonString(file, g_Info[i].first);
+		fprintf(file, ": ");
+		Bench_WriteJsonString(file, g_Info[i].second);
+	}
+	fprintf(file, "\n  },\n  \"results\": [");
+	for (size_t i = 0; i < g_Results.size(); i++)
+	{
+		const BenchResult& r = g_Results[i];
+		fprintf(file, "%s\n    { \"suite\": ", i ? "," : "");
+		Bench_WriteJsonString(file, r.Suite);
+		fprintf(file, ", \"case\": ");
+		Bench_WriteJsonString(file, r.Case);
+		fprintf(file, ", \"metric\": ");
+		Bench_WriteJsonString(file, r.Metric);
+		fprintf(file, ", \"unit\": ");
+		Bench_WriteJsonString(file, r.Unit);
+		fprintf(file, ", \"count\": %d, \"mean\": %.9g, \"min\": %.9g, \"p50\": %.9g, \"p90\": %.9g, \"p99\": %.9g, \"max\": %.9g }",
+			r.Count, r.Mean, r.Min, r.P50, r.P90, r.P99, r.Max);
+	}
+	fprintf(file, "\n  ]\n}\n");
+
+	fclose(file);
+	return true;
+}
+
+/**
+ * @brief Write every recorded result as a CSV row, after a header row. Names never contain commas or quotes.
+ *
+ * @param path The path of the report
+ * @return True if the report was written
+ */
+bool Bench_WriteCsv(const char* path)
+{
+	FILE* file = fopen(path, "w");
+	if (!file)
+	{
+		fprintf(stderr, "ERROR: Bench_WriteCsv: can't create %s\n", path);
+		return false;
+	}
+
+	fprintf(file, "suite,case,metric,unit,count,mean,min,p50,p90,p99,max\n");
+	for (const BenchResult& r : g_Results)
+	{
+		fprintf(file, "%s,%s,%s,%s,%d,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g\n", r.Suite.c_str(), r.Case.c_str(), r.Metric.c_str(),
+			r.Unit.c_str(), r.Count, r.Mean, r.Min, r.P50, r.P90, r.P99, r.Max);
+	}
+
+	fclose(file);
+	return true;
+}
@@ -13,20 +13,28 @@
 struct DepthBuffer
 {
 	GLuint        texId;
+	int           arraySize;
 
-	DepthBuffer(ovrSizei size, int sampleCount)
+	DepthBuffer(ovrSizei size, int sampleCount, int arraySize = 1)
+		: arraySize(arraySize)
 	{
+		// more than one layer makes a texture array, for rendering both eyes in one pass
+		const GLenum target = arraySize > 1 ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+
 		glGenTextures(1, &texId);
-		glBindTexture(GL_TEXTURE_2D, texId);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glBindTexture(target, texId);
+		glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
 		GLenum internalFormat = GL_DEPTH_COMPONENT24;
 		GLenum type = GL_UNSIGNED_INT;
 
-		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, size.w, size.h, 0, GL_DEPTH_COMPONENT, type, NULL);
+		if (arraySize > 1)
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internalFormat, size.w, size.h, arraySize, 0, GL_DEPTH_COMPONENT, type, NULL);
+		else
+			glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, size.w, size.h, 0, GL_DEPTH_COMPONENT, type, NULL);
 	}
 	~DepthBuffer()
 	{
@@ -0,0 +1,64 @@
+#include "DynamicResolution.h"
+#include <algorithm>
+#include <cmath>
+
+DynamicResolution::DynamicResolution(const DynamicResolutionConfig& config, float frameBudgetMs)
+	: _config(config)
+{
+	this->_config.maxScale = std::max(this->_config.maxScale, this->_config.minScale);
+	this->_targetMs = this->_config.targetMs > 0.f ? this->_config.targetMs : frameBudgetMs * 0.7f;
+	this->_scale = this->_config.maxScale;
+}
+
+void DynamicResolution::set_scale(float scale, long long frameIndex)
+{
+	scale = std::min(std::max(scale, this->_config.minScale), this->_config.maxScale);
+	this->_framesOver = 0;
+	this->_framesUnder = 0;
+	if (scale == this->_scale)
+		return;
+
+	this->_scale = scale;
+	this->_scaleFrameIndex = frameIndex;
+	this->_changes++;
+}
+
+// Feeds the GPU time of a past frame's eye passes to the controller, before rendering frameIndex. Returns true
+// if the scale changed, in which case frameIndex is the first frame rendered at the new scale.
+bool DynamicResolution::update(long long frameIndex, long long sampleFrameIndex, float gpuMs)
+{
+	// each frame counts once, and frames rendered before the last change were rendered at another scale
+	if (sampleFrameIndex <= this->_sampleFrameIndex || sampleFrameIndex < this->_scaleFrameIndex || gpuMs <= 0.f)
+		return false;
+	this->_sampleFrameIndex = sampleFrameIndex;
+	this->_gpuMs = gpuMs;
+
+	const float before = this->_scale;
+	if (gpuMs > this->_targetMs)
+	{
+		this->_framesUnder = 0;
+		if (++this->_framesOver >= this->_config.lowerFrames)
+		{
+			// straight down to the middle of the band under the target, so noise doesn't take it straight back up or down
+			const float middle = this->_targetMs * (1.f + this->_config.raiseThreshold) * 0.5f;
+			this->set_scale(before * std::sqrt(middle / gpuMs), frameIndex);
+		}
+	}
+	else if (gpuMs < this->_targetMs * this->_config.raiseThreshold)
+	{
+		this->_framesOver = 0;
+		if (++this->_framesUnder >= this->_config.raiseFrames)
+		{
+			// up in small steps, and never past the scale that would leave the band under the target
+			const float headroom = before * std::sqrt(this->_targetMs * this->_config.raiseThreshold / gpuMs);
+			this->set_scale(std::min(before + this->_config.raiseStep, headroom), frameIndex);
+		}
+	}
+	else
+	{
+		this->_framesOver = 0;
+		this->_framesUnder = 0;
+	}
+
+	return this->_scale != before;
+}
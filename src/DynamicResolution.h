@@ -0,0 +1,51 @@
+#pragma once
+
+struct DynamicResolutionConfig
+{
+	// range of the eye buffers' pixel density, as a multiple of the HMD's recommended density. The eye swap chains
+	// are allocated at maxScale once, lower scales render into a smaller viewport of them.
+	float minScale = 0.6f;
+	float maxScale = 1.f;
+
+	// GPU time of the eye passes to stay under, in milliseconds. 0 for 70% of the HMD's frame budget, which leaves
+	// the rest for the GUI, the mirror and the compositor.
+	float targetMs = 0.f;
+
+	// Hysteresis: the scale goes down once the GPU time has been over the target for lowerFrames frames in a row,
+	// but only goes up once it has stayed under raiseThreshold * target for raiseFrames frames, by at most raiseStep.
+	int lowerFrames = 2;
+	float raiseThreshold = 0.8f;
+	int raiseFrames = 45;
+	float raiseStep = 0.05f;
+};
+
+// Picks the eye buffers' pixel density from the measured GPU time of the eye passes. The GPU time of a pass is
+// taken to grow with its pixel count, i.e. with the square of the scale.
+class DynamicResolution
+{
+private:
+	DynamicResolutionConfig _config;
+	float _targetMs = 0.f;
+	float _scale = 1.f;
+
+	// the first frame rendered at the current scale, older GPU times don't say anything about it
+	long long _scaleFrameIndex = 0;
+	long long _sampleFrameIndex = -1;
+	float _gpuMs = 0.f;
+	int _framesOver = 0;
+	int _framesUnder = 0;
+	unsigned long long _changes = 0;
+
+	void set_scale(float scale, long long frameIndex);
+
+public:
+	DynamicResolution(const DynamicResolutionConfig& config = DynamicResolutionConfig(), float frameBudgetMs = 1000.f / 90.f);
+
+	bool update(long long frameIndex, long long sampleFrameIndex, float gpuMs);
+
+	const DynamicResolutionConfig& config() const { return this->_config; }
+	float scale() const { return this->_scale; }
+	float target_ms() const { return this->_targetMs; }
+	float gpu_ms() const { return this->_gpuMs; }
+	unsigned long long changes() const { return this->_changes; }
+};
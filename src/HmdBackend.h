@@ -0,0 +1,48 @@
+#pragma once
+#include <LibOVR/OVR_CAPI_GL.h>
+#include "GL.h"
+
+// The HMD session calls made by VR, TextureBuffer and the GUI renderer (imgui_impl_ovr), so they can run against
+// the Oculus runtime (OvrHmdBackend) or a simulated headset with no runtime at all (SimHmdBackend).
+// The LibOVR structs are still used to pass data around, only the calls go through the backend.
+class HmdBackend
+{
+public:
+	virtual ~HmdBackend() {}
+
+	// creates the session, call before anything else
+	virtual bool init() = 0;
+
+	virtual ovrHmdDesc get_hmd_desc() = 0;
+	virtual ovrSizei get_fov_texture_size(ovrEyeType eye, ovrFovPort fov, float pixelsPerDisplayPixel) = 0;
+	virtual ovrEyeRenderDesc get_render_desc(ovrEyeType eye, ovrFovPort fov) = 0;
+	virtual void set_tracking_origin(ovrTrackingOrigin origin) = 0;
+	virtual void recenter_tracking_origin() = 0;
+	virtual ovrSessionStatus get_session_status() = 0;
+	virtual double get_time_in_seconds() = 0;
+
+	// frame submission, with the same frame index for all three calls of a frame
+	virtual bool wait_to_begin_frame(long long frameIndex) = 0;
+	virtual bool begin_frame(long long frameIndex) = 0;
+	virtual bool end_frame(long long frameIndex, const ovrLayerHeader* const* layers, unsigned int layerCount) = 0;
+	virtual double get_predicted_display_time(long long frameIndex) = 0;
+
+	// compositor timing of the frames shown since the last call, most recent first like ovr_GetPerfStats()
+	virtual bool get_perf_stats(ovrPerfStats* out_stats) = 0;
+
+	// devices, get_input_state() is also called from the GUI renderer's input polling thread
+	virtual ovrTrackingState get_tracking_state(double absTime) = 0;
+	virtual bool get_input_state(ovrInputState* out_state) = 0;
+	virtual bool submit_controller_vibration(ovrControllerType controller, const ovrHapticsBuffer* buffer) = 0;
+
+	// swap chains of GL textures, for eye and quad layers; create_swap_chain() returns nullptr on failure
+	virtual ovrTextureSwapChain create_swap_chain(const ovrTextureSwapChainDesc& desc) = 0;
+	virtual void destroy_swap_chain(ovrTextureSwapChain chain) = 0;
+	virtual int get_swap_chain_length(ovrTextureSwapChain chain) = 0;
+	virtual int get_swap_chain_current_index(ovrTextureSwapChain chain) = 0;
+	virtual GLuint get_swap_chain_buffer(ovrTextureSwapChain chain, int index) = 0;
+	virtual bool commit_swap_chain(ovrTextureSwapChain chain) = 0;
+
+	// the texture the compositor mirrors the HMD view into, owned by the backend
+	virtual bool create_mirror_texture(const ovrMirrorTextureDesc& desc, GLuint* out_texture) = 0;
+};
@@ -0,0 +1,173 @@
+#include "OvrHmdBackend.h"
+#include <iostream>
+
+// LibOVR only ships for Windows, other platforms build with SimHmdBackend alone
+#ifdef _WIN32
+
+OvrHmdBackend::~OvrHmdBackend()
+{
+	if (!this->_session) return;
+
+	if (this->_mirrorTexture)
+	{
+		ovr_DestroyMirrorTexture(this->_session, this->_mirrorTexture);
+	}
+	ovr_Destroy(this->_session);
+	ovr_Shutdown();
+}
+
+bool OvrHmdBackend::init()
+{
+	ovrResult result = ovr_Initialize(nullptr);
+	if (!OVR_SUCCESS(result))
+	{
+		std::cerr << "Failed to init LibOVR" << std::endl;
+		return false;
+	}
+
+	result = ovr_Create(&this->_session, &this->_luid);
+	if (!OVR_SUCCESS(result))
+	{
+		std::cerr << "Failed to create HMD session" << std::endl;
+		ovr_Shutdown();
+		this->_session = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+ovrHmdDesc OvrHmdBackend::get_hmd_desc()
+{
+	return ovr_GetHmdDesc(this->_session);
+}
+
+ovrSizei OvrHmdBackend::get_fov_texture_size(ovrEyeType eye, ovrFovPort fov, float pixelsPerDisplayPixel)
+{
+	return ovr_GetFovTextureSize(this->_session, eye, fov, pixelsPerDisplayPixel);
+}
+
+ovrEyeRenderDesc OvrHmdBackend::get_render_desc(ovrEyeType eye, ovrFovPort fov)
+{
+	return ovr_GetRenderDesc(this->_session, eye, fov);
+}
+
+void OvrHmdBackend::set_tracking_origin(ovrTrackingOrigin origin)
+{
+	ovr_SetTrackingOriginType(this->_session, origin);
+}
+
+void OvrHmdBackend::recenter_tracking_origin()
+{
+	ovr_RecenterTrackingOrigin(this->_session);
+}
+
+ovrSessionStatus OvrHmdBackend::get_session_status()
+{
+	ovrSessionStatus status = {};
+	ovr_GetSessionStatus(this->_session, &status);
+	return status;
+}
+
+double OvrHmdBackend::get_time_in_seconds()
+{
+	return ovr_GetTimeInSeconds();
+}
+
+bool OvrHmdBackend::wait_to_begin_frame(long long frameIndex)
+{
+	return OVR_SUCCESS(ovr_WaitToBeginFrame(this->_session, frameIndex));
+}
+
+bool OvrHmdBackend::begin_frame(long long frameIndex)
+{
+	return OVR_SUCCESS(ovr_BeginFrame(this->_session, frameIndex));
+}
+
+bool OvrHmdBackend::end_frame(long long frameIndex, const ovrLayerHeader* const* layers, unsigned int layerCount)
+{
+	return OVR_SUCCESS(ovr_EndFrame(this->_session, frameIndex, nullptr, layers, layerCount));
+}
+
+double OvrHmdBackend::get_predicted_display_time(long long frameIndex)
+{
+	return ovr_GetPredictedDisplayTime(this->_session, frameIndex);
+}
+
+bool OvrHmdBackend::get_perf_stats(ovrPerfStats* out_stats)
+{
+	return OVR_SUCCESS(ovr_GetPerfStats(this->_session, out_stats));
+}
+
+ovrTrackingState OvrHmdBackend::get_tracking_state(double absTime)
+{
+	return ovr_GetTrackingState(this->_session, absTime, ovrTrue);
+}
+
+bool OvrHmdBackend::get_input_state(ovrInputState* out_state)
+{
+	return OVR_SUCCESS(ovr_GetInputState(this->_session, ovrControllerType_Touch, out_state));
+}
+
+bool OvrHmdBackend::submit_controller_vibration(ovrControllerType controller, const ovrHapticsBuffer* buffer)
+{
+	return OVR_SUCCESS(ovr_SubmitControllerVibration(this->_session, controller, buffer));
+}
+
+ovrTextureSwapChain OvrHmdBackend::create_swap_chain(const ovrTextureSwapChainDesc& desc)
+{
+	ovrTextureSwapChain chain = nullptr;
+	const ovrResult result = ovr_CreateTextureSwapChainGL(this->_session, &desc, &chain);
+	if (!OVR_SUCCESS(result))
+	{
+		ovrErrorInfo info;
+		ovr_GetLastErrorInfo(&info);
+		std::cerr << "Failed to create swap chain: " << info.ErrorString << std::endl;
+		return nullptr;
+	}
+	return chain;
+}
+
+void OvrHmdBackend::destroy_swap_chain(ovrTextureSwapChain chain)
+{
+	ovr_DestroyTextureSwapChain(this->_session, chain);
+}
+
+int OvrHmdBackend::get_swap_chain_length(ovrTextureSwapChain chain)
+{
+	int length = 0;
+	ovr_GetTextureSwapChainLength(this->_session, chain, &length);
+	return length;
+}
+
+int OvrHmdBackend::get_swap_chain_current_index(ovrTextureSwapChain chain)
+{
+	int index = 0;
+	ovr_GetTextureSwapChainCurrentIndex(this->_session, chain, &index);
+	return index;
+}
+
+GLuint OvrHmdBackend::get_swap_chain_buffer(ovrTextureSwapChain chain, int index)
+{
+	GLuint texId = 0;
+	ovr_GetTextureSwapChainBufferGL(this->_session, chain, index, &texId);
+	return texId;
+}
+
+bool OvrHmdBackend::commit_swap_chain(ovrTextureSwapChain chain)
+{
+	return OVR_SUCCESS(ovr_CommitTextureSwapChain(this->_session, chain));
+}
+
+bool OvrHmdBackend::create_mirror_texture(const ovrMirrorTextureDesc& desc, GLuint* out_texture)
+{
+	const ovrResult result = ovr_CreateMirrorTextureWithOptionsGL(this->_session, &desc, &this->_mirrorTexture);
+	if (!OVR_SUCCESS(result))
+	{
+		this->_mirrorTexture = nullptr;
+		return false;
+	}
+	return OVR_SUCCESS(ovr_GetMirrorTextureBufferGL(this->_session, this->_mirrorTexture, out_texture));
+}
+
+#endif
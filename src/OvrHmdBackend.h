@@ -0,0 +1,48 @@
+#pragma once
+#include "HmdBackend.h"
+
+// HMD backend that forwards every call to the Oculus runtime through LibOVR (Windows only)
+class OvrHmdBackend : public HmdBackend
+{
+private:
+	ovrSession _session = nullptr;
+	ovrGraphicsLuid _luid = {};
+	ovrMirrorTexture _mirrorTexture = nullptr;
+
+public:
+	OvrHmdBackend() {}
+	OvrHmdBackend(const OvrHmdBackend& other) = delete;
+	OvrHmdBackend& operator=(const OvrHmdBackend& other) = delete;
+	~OvrHmdBackend();
+
+	ovrSession session() const { return this->_session; }
+
+	bool init() override;
+
+	ovrHmdDesc get_hmd_desc() override;
+	ovrSizei get_fov_texture_size(ovrEyeType eye, ovrFovPort fov, float pixelsPerDisplayPixel) override;
+	ovrEyeRenderDesc get_render_desc(ovrEyeType eye, ovrFovPort fov) override;
+	void set_tracking_origin(ovrTrackingOrigin origin) override;
+	void recenter_tracking_origin() override;
+	ovrSessionStatus get_session_status() override;
+	double get_time_in_seconds() override;
+
+	bool wait_to_begin_frame(long long frameIndex) override;
+	bool begin_frame(long long frameIndex) override;
+	bool end_frame(long long frameIndex, const ovrLayerHeader* const* layers, unsigned int layerCount) override;
+	double get_predicted_display_time(long long frameIndex) override;
+	bool get_perf_stats(ovrPerfStats* out_stats) override;
+
+	ovrTrackingState get_tracking_state(double absTime) override;
+	bool get_input_state(ovrInputState* out_state) override;
+	bool submit_controller_vibration(ovrControllerType controller, const ovrHapticsBuffer* buffer) override;
+
+	ovrTextureSwapChain create_swap_chain(const ovrTextureSwapChainDesc& desc) override;
+	void destroy_swap_chain(ovrTextureSwapChain chain) override;
+	int get_swap_chain_length(ovrTextureSwapChain chain) override;
+	int get_swap_chain_current_index(ovrTextureSwapChain chain) override;
+	GLuint get_swap_chain_buffer(ovrTextureSwapChain chain, int index) override;
+	bool commit_swap_chain(ovrTextureSwapChain chain) override;
+
+	bool create_mirror_texture(const ovrMirrorTextureDesc& desc, GLuint* out_texture) override;
+};
@@ -0,0 +1,621 @@
+#include "SimHmdBackend.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// images in each simulated swap chain, like the Oculus runtime's
+static const int SWAP_CHAIN_LENGTH = 3;
+
+// height of the eyes above the floor, for ovrTrackingOrigin_FloorLevel
+static const float EYE_HEIGHT = 1.675f;
+
+// near and far planes the mirror projects quad layers with, they're only clipped if right at the eye
+static const float MIRROR_Z_NEAR = 0.01f;
+static const float MIRROR_Z_FAR = 1000.f;
+
+static ovrPosef make_pose(glm::vec3 position, glm::quat orientation)
+{
+	ovrPosef pose;
+	pose.Position = { position.x, position.y, position.z };
+	pose.Orientation = { orientation.x, orientation.y, orientation.z, orientation.w };
+	return pose;
+}
+
+static glm::mat4 pose_matrix(const ovrPosef& pose)
+{
+	const glm::quat orientation(pose.Orientation.w, pose.Orientation.x, pose.Orientation.y, pose.Orientation.z);
+	return glm::translate(glm::mat4(1), glm::vec3(pose.Position.x, pose.Position.y, pose.Position.z)) * glm::mat4_cast(orientation);
+}
+
+static GLenum gl_format(ovrTextureFormat format)
+{
+	switch (format)
+	{
+	case OVR_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case OVR_FORMAT_B8G8R8A8_UNORM_SRGB:
+	case OVR_FORMAT_B8G8R8X8_UNORM_SRGB:
+		return GL_SRGB8_ALPHA8;
+	case OVR_FORMAT_R16G16B16A16_FLOAT:
+		return GL_RGBA16F;
+	case OVR_FORMAT_D16_UNORM:
+		return GL_DEPTH_COMPONENT16;
+	case OVR_FORMAT_D24_UNORM_S8_UINT:
+		return GL_DEPTH24_STENCIL8;
+	case OVR_FORMAT_D32_FLOAT:
+		return GL_DEPTH_COMPONENT32F;
+	default:
+		return GL_RGBA8;
+	}
+}
+
+SimHmdBackend::~SimHmdBackend()
+{
+	for (SwapChain* chain : this->_swapChains)
+	{
+		glDeleteTextures((GLsizei)chain->textures.size(), chain->textures.data());
+		delete chain;
+	}
+	if (this->_mirrorTexture)
+	{
+		glDeleteTextures(1, &this->_mirrorTexture);
+		glDeleteFramebuffers(2, this->_mirrorFBOs);
+	}
+	if (this->_quadProgram)
+	{
+		glDeleteProgram(this->_quadProgram);
+		glDeleteVertexArrays(1, &this->_quadVAO);
+		glDeleteSamplers(1, &this->_quadSampler);
+	}
+}
+
+bool SimHmdBackend::init()
+{
+	if (this->_config.eyeResolution.w <= 0 || this->_config.eyeResolution.h <= 0 || this->_config.refreshRate <= 0.f)
+	{
+		std::cerr << "Invalid simulated HMD config" << std::endl;
+		return false;
+	}
+
+	if (!this->_config.poses)
+	{
+		this->_config.poses = default_poses;
+	}
+	this->_startTime = this->get_time_in_seconds();
+	return true;
+}
+
+// The head looks around slowly and the right hand sweeps from side to side, so the pointer crosses panels on
+// either side of the view
+void SimHmdBackend::default_poses(void* userData, double time, ovrTrackingState* out_state)
+{
+	const float t = (float)time;
+	const glm::vec3 up(0, 1, 0);
+	const glm::vec3 right(1, 0, 0);
+
+	const glm::quat head = glm::angleAxis(0.15f * sinf(t * 0.5f), up) * glm::angleAxis(0.05f * sinf(t * 0.3f), right);
+	const glm::quat rightHand = glm::angleAxis(0.6f * sinf(t * 0.4f), up) * glm::angleAxis(0.15f + 0.1f * sinf(t * 0.7f), right);
+	const glm::quat leftHand = glm::angleAxis(-0.6f, right);
+
+	out_state->HeadPose.ThePose = make_pose(glm::vec3(0, 0, 0), head);
+	out_state->HandPoses[ovrHand_Left].ThePose = make_pose(glm::vec3(-0.2f, -0.35f, -0.25f), leftHand);
+	out_state->HandPoses[ovrHand_Right].ThePose = make_pose(glm::vec3(0.2f, -0.3f, -0.3f), rightHand);
+}
+
+ovrHmdDesc SimHmdBackend::get_hmd_desc()
+{
+	ovrHmdDesc desc;
+	memset(&desc, 0, sizeof(desc));
+	desc.Type = ovrHmd_Other;
+	strncpy(desc.ProductName, "Simulated HMD", sizeof(desc.ProductName) - 1);
+	strncpy(desc.Manufacturer, "imgui-ovr", sizeof(desc.Manufacturer) - 1);
+	desc.Resolution.w = this->_config.eyeResolution.w * 2;
+	desc.Resolution.h = this->_config.eyeResolution.h;
+	desc.DisplayRefreshRate = this->_config.refreshRate;
+	for (int eye = 0; eye < 2; eye++)
+	{
+		desc.DefaultEyeFov[eye] = this->_config.eyeFov[eye];
+		desc.MaxEyeFov[eye] = this->_config.eyeFov[eye];
+	}
+	return desc;
+}
+
+// The eye buffer is sized so its pixels match display pixels at the center of the configured field of view, a
+// wider or narrower field of view than that grows or shrinks it
+ovrSizei SimHmdBackend::get_fov_texture_size(ovrEyeType eye, ovrFovPort fov, float pixelsPerDisplayPixel)
+{
+	const ovrEyeRenderDesc desc = this->get_render_desc(eye, fov);
+	ovrSizei size;
+	size.w = std::max(1, (int)ceilf(desc.PixelsPerTanAngleAtCenter.x * (fov.LeftTan + fov.RightTan) * pixelsPerDisplayPixel));
+	size.h = std::max(1, (int)ceilf(desc.PixelsPerTanAngleAtCenter.y * (fov.UpTan + fov.DownTan) * pixelsPerDisplayPixel));
+	return size;
+}
+
+ovrEyeRenderDesc SimHmdBackend::get_render_desc(ovrEyeType eye, ovrFovPort fov)
+{
+	const ovrFovPort& displayFov = this->_config.eyeFov[eye];
+	const ovrSizei& resolution = this->_config.eyeResolution;
+
+	ovrEyeRenderDesc desc;
+	memset(&desc, 0, sizeof(desc));
+	desc.Eye = eye;
+	desc.Fov = fov;
+	desc.DistortedViewport.Pos.x = eye == ovrEye_Left ? 0 : resolution.w;
+	desc.DistortedViewport.Size = resolution;
+	desc.PixelsPerTanAngleAtCenter.x = resolution.w / (displayFov.LeftTan + displayFov.RightTan);
+	desc.PixelsPerTanAngleAtCenter.y = resolution.h / (displayFov.UpTan + displayFov.DownTan);
+	desc.HmdToEyePose = make_pose(glm::vec3((eye == ovrEye_Left ? -0.5f : 0.5f) * this->_config.ipd, 0, 0), glm::quat(1, 0, 0, 0));
+	return desc;
+}
+
+void SimHmdBackend::set_tracking_origin(ovrTrackingOrigin origin)
+{
+	this->_origin = origin;
+}
+
+void SimHmdBackend::recenter_tracking_origin()
+{
+	// the scripted poses are already centered
+}
+
+ovrSessionStatus SimHmdBackend::get_session_status()
+{
+	ovrSessionStatus status;
+	memset(&status, 0, sizeof(status));
+	status.IsVisible = ovrTrue;
+	status.HmdPresent = ovrTrue;
+	status.HmdMounted = ovrTrue;
+	status.HasInputFocus = ovrTrue;
+	return status;
+}
+
+double SimHmdBackend::get_time_in_seconds()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool SimHmdBackend::wait_to_begin_frame(long long frameIndex)
+{
+	if (this->_config.throttle)
+	{
+		const double wait = this->_startTime + frameIndex / (double)this->_config.refreshRate - this->get_time_in_seconds();
+		if (wait > 0.0)
+		{
+			std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+		}
+	}
+	return true;
+}
+
+bool SimHmdBackend::begin_frame(long long frameIndex)
+{
+	this->_frameBeginTime = this->get_time_in_seconds();
+	return true;
+}
+
+bool SimHmdBackend::end_frame(long long frameIndex, const ovrLayerHeader* const* layers, unsigned int layerCount)
+{
+	// keep a copy of the layers submitted, null ones are skipped like the compositor does
+	this->_lastFrameLayers.clear();
+	for (unsigned int i = 0; i < layerCount; i++)
+	{
+		if (!layers[i]) continue;
+
+		SimLayer layer;
+		memset(&layer, 0, sizeof(layer));
+		layer.header = *layers[i];
+		if (layers[i]->Type == ovrLayerType_EyeFov)
+		{
+			layer.eyeFov = *reinterpret_cast<const ovrLayerEyeFov*>(layers[i]);
+		}
+		else if (layers[i]->Type == ovrLayerType_Quad)
+		{
+			layer.quad = *reinterpret_cast<const ovrLayerQuad*>(layers[i]);
+		}
+		this->_lastFrameLayers.push_back(layer);
+	}
+
+	// layers are composited in order like the compositor does, quads are seen from the last eye layer's poses
+	const ovrLayerEyeFov* eyeLayer = nullptr;
+	for (unsigned int i = 0; i < layerCount && this->_mirrorTexture; i++)
+	{
+		if (!layers[i]) continue;
+
+		if (layers[i]->Type == ovrLayerType_EyeFov)
+		{
+			eyeLayer = reinterpret_cast<const ovrLayerEyeFov*>(layers[i]);
+			this->copy_to_mirror(*eyeLayer);
+		}
+		else if (layers[i]->Type == ovrLayerType_Quad && (this->_quadProgram || this->create_quad_program()))
+		{
+			this->draw_quad_to_mirror(*reinterpret_cast<const ovrLayerQuad*>(layers[i]), eyeLayer);
+		}
+	}
+
+	// the compositor shows every frame on the next vsync, the cumulative counters carry over unless scripted
+	ovrPerfStatsPerCompositorFrame stats = this->_lastFrameStats;
+	stats.HmdVsyncIndex = (int)this->_framesSubmitted;
+	stats.AppFrameIndex = (int)frameIndex;
+	stats.CompositorFrameIndex = (int)this->_framesSubmitted;
+	stats.AppCpuElapsedTime = (float)(this->get_time_in_seconds() - this->_frameBeginTime);
+	if (this->_config.perfStats)
+	{
+		this->_config.perfStats(this->_config.perfStatsUserData, frameIndex, &stats);
+	}
+	this->_lastFrameStats = stats;
+
+	// like the runtime, only the latest few frames are kept between calls to get_perf_stats()
+	if (this->_pendingFrameStats.size() == ovrMaxProvidedFrameStats)
+	{
+		this->_pendingFrameStats.erase(this->_pendingFrameStats.begin());
+		this->_frameStatsDropped = true;
+	}
+	this->_pendingFrameStats.push_back(stats);
+
+	this->_framesSubmitted++;
+	return true;
+}
+
+// Frames are displayed at the refresh rate in simulated time, whether or not they're throttled, so the scripted
+// poses of a frame don't depend on how long it took to render
+double SimHmdBackend::get_predicted_display_time(long long frameIndex)
+{
+	return this->_startTime + (frameIndex + 1) / (double)this->_config.refreshRate;
+}
+
+bool SimHmdBackend::get_perf_stats(ovrPerfStats* out_stats)
+{
+	memset(out_stats, 0, sizeof(*out_stats));
+	out_stats->FrameStatsCount = (int)this->_pendingFrameStats.size();
+	for (int i = 0; i < out_stats->FrameStatsCount; i++)
+	{
+		out_stats->FrameStats[i] = this->_pendingFrameStats[out_stats->FrameStatsCount - 1 - i];
+	}
+	out_stats->AnyFrameStatsDropped = this->_frameStatsDropped ? ovrTrue : ovrFalse;
+	out_stats->AdaptiveGpuPerformanceScale = 1.f;
+	out_stats->AswIsAvailable = ovrFalse;
+
+	this->_pendingFrameStats.clear();
+	this->_frameStatsDropped = false;
+	return true;
+}
+
+ovrTrackingState SimHmdBackend::get_tracking_state(double absTime)
+{
+	ovrTrackingState state;
+	memset(&state, 0, sizeof(state));
+	this->_config.poses(this->_config.posesUserData, absTime - this->_startTime, &state);
+
+	const unsigned int tracked = ovrStatus_OrientationTracked | ovrStatus_PositionTracked;
+	state.StatusFlags = tracked;
+	state.HandStatusFlags[ovrHand_Left] = tracked;
+	state.HandStatusFlags[ovrHand_Right] = tracked;
+	state.HeadPose.TimeInSeconds = absTime;
+	state.HandPoses[ovrHand_Left].TimeInSeconds = absTime;
+	state.HandPoses[ovrHand_Right].TimeInSeconds = absTime;
+
+	if (this->_origin == ovrTrackingOrigin_FloorLevel)
+	{
+		state.HeadPose.ThePose.Position.y += EYE_HEIGHT;
+		state.HandPoses[ovrHand_Left].ThePose.Position.y += EYE_HEIGHT;
+		state.HandPoses[ovrHand_Right].ThePose.Position.y += EYE_HEIGHT;
+	}
+	return state;
+}
+
+bool SimHmdBackend::get_input_state(ovrInputState* out_state)
+{
+	if (this->_config.input)
+	{
+		return this->_config.input(this->_config.inputUserData, out_state);
+	}
+
+	memset(out_state, 0, sizeof(*out_state));
+	out_state->TimeInSeconds = this->get_time_in_seconds();
+	out_state->ControllerType = ovrControllerType_Touch;
+	return true;
+}
+
+bool SimHmdBackend::submit_controller_vibration(ovrControllerType controller, const ovrHapticsBuffer* buffer)
+{
+	return true;
+}
+
+ovrTextureSwapChain SimHmdBackend::create_swap_chain(const ovrTextureSwapChainDesc& desc)
+{
+	// same limits as the Oculus runtime with OpenGL, so code that works here works on a headset
+	if (desc.Type != ovrTexture_2D || desc.ArraySize > 1 || desc.SampleCount > 1 || desc.Width <= 0 || desc.Height <= 0)
+	{
+		std::cerr << "Failed to create swap chain: unsupported description" << std::endl;
+		return nullptr;
+	}
+
+	SwapChain* chain = new SwapChain();
+	chain->desc = desc;
+	chain->textures.resize(desc.StaticImage ? 1 : SWAP_CHAIN_LENGTH);
+	glGenTextures((GLsizei)chain->textures.size(), chain->textures.data());
+	for (GLuint texId : chain->textures)
+	{
+		glBindTexture(GL_TEXTURE_2D, texId);
+		glTexStorage2D(GL_TEXTURE_2D, std::max(1, desc.MipLevels), gl_format(desc.Format), desc.Width, desc.Height);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	this->_swapChains.push_back(chain);
+	return reinterpret_cast<ovrTextureSwapChain>(chain);
+}
+
+void SimHmdBackend::destroy_swap_chain(ovrTextureSwapChain handle)
+{
+	SwapChain* chain = reinterpret_cast<SwapChain*>(handle);
+	auto it = std::find(this->_swapChains.begin(), this->_swapChains.end(), chain);
+	if (it == this->_swapChains.end()) return;
+
+	glDeleteTextures((GLsizei)chain->textures.size(), chain->textures.data());
+	this->_swapChains.erase(it);
+	delete chain;
+}
+
+int SimHmdBackend::get_swap_chain_length(ovrTextureSwapChain handle)
+{
+	return (int)reinterpret_cast<SwapChain*>(handle)->textures.size();
+}
+
+int SimHmdBackend::get_swap_chain_current_index(ovrTextureSwapChain handle)
+{
+	return reinterpret_cast<SwapChain*>(handle)->current;
+}
+
+GLuint SimHmdBackend::get_swap_chain_buffer(ovrTextureSwapChain handle, int index)
+{
+	const SwapChain* chain = reinterpret_cast<SwapChain*>(handle);
+	return index >= 0 && index < (int)chain->textures.size() ? chain->textures[index] : 0;
+}
+
+bool SimHmdBackend::commit_swap_chain(ovrTextureSwapChain handle)
+{
+	SwapChain* chain = reinterpret_cast<SwapChain*>(handle);
+	chain->committed = chain->current;
+	chain->current = (chain->current + 1) % (int)chain->textures.size();
+	return true;
+}
+
+bool SimHmdBackend::create_mirror_texture(const ovrMirrorTextureDesc& desc, GLuint* out_texture)
+{
+	if (this->_mirrorTexture || desc.Width <= 0 || desc.Height <= 0) return false;
+
+	glGenTextures(1, &this->_mirrorTexture);
+	glBindTexture(GL_TEXTURE_2D, this->_mirrorTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, gl_format(desc.Format), desc.Width, desc.Height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glGenFramebuffers(2, this->_mirrorFBOs);
+
+	this->_mirrorSize.w = desc.Width;
+	this->_mirrorSize.h = desc.Height;
+	*out_texture = this->_mirrorTexture;
+	return true;
+}
+
+// Blits each eye's last committed image side by side into the mirror texture, undistorted. The eye layer's
+// origin is at the bottom left and the mirror's at the top left, like the Oculus runtime's, so it's flipped.
+void SimHmdBackend::copy_to_mirror(const ovrLayerEyeFov& layer)
+{
+	GLint lastReadFBO, lastDrawFBO;
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &lastReadFBO);
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &lastDrawFBO);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, this->_mirrorFBOs[0]);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->_mirrorFBOs[1]);
+	glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->_mirrorTexture, 0);
+
+	const int halfWidth = this->_mirrorSize.w / 2;
+	for (int eye = 0; eye < 2; eye++)
+	{
+		const SwapChain* chain = reinterpret_cast<const SwapChain*>(layer.ColorTexture[eye]);
+		if (!chain || chain->committed < 0) continue;
+
+		const ovrRecti& vp = layer.Viewport[eye];
+		glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, chain->textures[chain->committed], 0);
+		glBlitFramebuffer(vp.Pos.x, vp.Pos.y, vp.Pos.x + vp.Size.w, vp.Pos.y + vp.Size.h,
+			eye * halfWidth, this->_mirrorSize.h, (eye + 1) * halfWidth, 0, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+	}
+
+	glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+	glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, lastReadFBO);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, lastDrawFBO);
+}
+
+bool SimHmdBackend::create_quad_program()
+{
+	// the quad's corners are projected on the CPU, so the vertex shader only picks them out
+	const GLchar* vertexShader =
+		"#version 330 core\n"
+		"uniform vec4 Corners[4];\n"
+		"uniform vec2 UVs[4];\n"
+		"out vec2 Frag_UV;\n"
+		"void main()\n"
+		"{\n"
+		"    Frag_UV = UVs[gl_VertexID];\n"
+		"    gl_Position = Corners[gl_VertexID];\n"
+		"}\n";
+
+	const GLchar* fragmentShader =
+		"#version 330 core\n"
+		"uniform sampler2D Texture;\n"
+		"in vec2 Frag_UV;\n"
+		"out vec4 Out_Color;\n"
+		"void main()\n"
+		"{\n"
+		"    Out_Color = texture(Texture, Frag_UV);\n"
+		"}\n";
+
+	const GLchar* sources[2] = { vertexShader, fragmentShader };
+	const GLenum types[2] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+	const char* names[2] = { "vertex", "fragment" };
+	char infoLog[512];
+	GLuint program = glCreateProgram();
+	for (int i = 0; i < 2; i++)
+	{
+		GLuint shader = glCreateShader(types[i]);
+		glShaderSource(shader, 1, &sources[i], nullptr);
+		glCompileShader(shader);
+
+		GLint compiled = GL_FALSE;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+		if (!compiled)
+		{
+			glGetShaderInfoLog(shader, sizeof(infoLog), nullptr, infoLog);
+			std::cerr << "Error compiling the simulated compositor's quad layer " << names[i] << " shader" << std::endl;
+			std::cerr << "Info log: " << infoLog << std::endl;
+			glDeleteShader(shader);
+			glDeleteProgram(program);
+			return false;
+		}
+		glAttachShader(program, shader);
+		glDeleteShader(shader);
+	}
+	glLinkProgram(program);
+
+	GLint linked = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	if (!linked)
+	{
+		glGetProgramInfoLog(program, sizeof(infoLog), nullptr, infoLog);
+		std::cerr << "Failed to link the simulated compositor's quad layer shader" << std::endl;
+		std::cerr << "Info log: " << infoLog << std::endl;
+		glDeleteProgram(program);
+		return false;
+	}
+
+	this->_quadProgram = program;
+	this->_quadCornersLocation = glGetUniformLocation(program, "Corners");
+	this->_quadUVsLocation = glGetUniformLocation(program, "UVs");
+	glGenVertexArrays(1, &this->_quadVAO);
+
+	// the layer's swap chain may have mips, filter with them like the compositor does
+	glGenSamplers(1, &this->_quadSampler);
+	glSamplerParameteri(this->_quadSampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glSamplerParameteri(this->_quadSampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glSamplerParameteri(this->_quadSampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glSamplerParameteri(this->_quadSampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	return true;
+}
+
+// Draws a quad layer's viewport into each half of the mirror texture, projected with the eye layer's FOV and
+// render poses (the HMD's default FOV and an untracked head without one). Head-locked quads are placed relative to
+// the head instead of the tracking origin. Like copy_to_mirror() the mirror's origin is at the top left, so the
+// projection is flipped.
+void SimHmdBackend::draw_quad_to_mirror(const ovrLayerQuad& layer, const ovrLayerEyeFov* eyeLayer)
+{
+	const SwapChain* chain = reinterpret_cast<const SwapChain*>(layer.ColorTexture);
+	if (!chain || chain->committed < 0 || layer.QuadSize.x <= 0.f || layer.QuadSize.y <= 0.f) return;
+
+	// the viewport in texture coordinates, flipped unless the texture's origin is at the bottom left like GL's
+	const float texWidth = (float)chain->desc.Width;
+	const float texHeight = (float)chain->desc.Height;
+	float u0 = layer.Viewport.Pos.x / texWidth;
+	float u1 = (layer.Viewport.Pos.x + layer.Viewport.Size.w) / texWidth;
+	float v0 = layer.Viewport.Pos.y / texHeight;
+	float v1 = (layer.Viewport.Pos.y + layer.Viewport.Size.h) / texHeight;
+	if (!(layer.Header.Flags & ovrLayerFlag_TextureOriginAtBottomLeft))
+	{
+		v0 = 1.f - v0;
+		v1 = 1.f - v1;
+	}
+	const GLfloat uvs[8] = { u0, v0, u1, v0, u0, v1, u1, v1 };
+
+	const glm::vec2 halfSize(layer.QuadSize.x * 0.5f, layer.QuadSize.y * 0.5f);
+	const glm::vec4 corners[4] =
+	{
+		glm::vec4(-halfSize.x, -halfSize.y, 0, 1), glm::vec4(halfSize.x, -halfSize.y, 0, 1),
+		glm::vec4(-halfSize.x, halfSize.y, 0, 1), glm::vec4(halfSize.x, halfSize.y, 0, 1)
+	};
+	const glm::mat4 quadModel = pose_matrix(layer.QuadPoseCenter);
+	const bool headLocked = (layer.Header.Flags & ovrLayerFlag_HeadLocked) != 0;
+
+	// backup GL state
+	GLint lastProgram, lastVAO, lastDrawFBO, lastActiveTexture, lastTexture, lastSampler, lastViewport[4];
+	GLint lastBlendSrcRgb, lastBlendDstRgb, lastBlendSrcAlpha, lastBlendDstAlpha;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &lastProgram);
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &lastVAO);
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &lastDrawFBO);
+	glGetIntegerv(GL_ACTIVE_TEXTURE, &lastActiveTexture);
+	glActiveTexture(GL_TEXTURE0);
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &lastTexture);
+	glGetIntegerv(GL_SAMPLER_BINDING, &lastSampler);
+	glGetIntegerv(GL_VIEWPORT, lastViewport);
+	glGetIntegerv(GL_BLEND_SRC_RGB, &lastBlendSrcRgb);
+	glGetIntegerv(GL_BLEND_DST_RGB, &lastBlendDstRgb);
+	glGetIntegerv(GL_BLEND_SRC_ALPHA, &lastBlendSrcAlpha);
+	glGetIntegerv(GL_BLEND_DST_ALPHA, &lastBlendDstAlpha);
+	const GLboolean lastBlend = glIsEnabled(GL_BLEND);
+	const GLboolean lastDepthTest = glIsEnabled(GL_DEPTH_TEST);
+	const GLboolean lastCullFace = glIsEnabled(GL_CULL_FACE);
+	const GLboolean lastScissorTest = glIsEnabled(GL_SCISSOR_TEST);
+	const GLboolean lastFramebufferSrgb = glIsEnabled(GL_FRAMEBUFFER_SRGB);
+
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->_mirrorFBOs[1]);
+	glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->_mirrorTexture, 0);
+	glUseProgram(this->_quadProgram);
+	glBindVertexArray(this->_quadVAO);
+	glBindTexture(GL_TEXTURE_2D, chain->textures[chain->committed]);
+	glBindSampler(0, this->_quadSampler);
+	glUniform2fv(this->_quadUVsLocation, 4, uvs);
+	glEnable(GL_BLEND);
+	glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_CULL_FACE);
+	glDisable(GL_SCISSOR_TEST);
+	glEnable(GL_FRAMEBUFFER_SRGB);
+
+	const int halfWidth = this->_mirrorSize.w / 2;
+	for (int eye = 0; eye < 2; eye++)
+	{
+		const ovrEyeRenderDesc desc = this->get_render_desc((ovrEyeType)eye, this->_config.eyeFov[eye]);
+		const ovrFovPort& fov = eyeLayer ? eyeLayer->Fov[eye] : desc.Fov;
+		const ovrPosef& eyePose = eyeLayer && !headLocked ? eyeLayer->RenderPose[eye] : desc.HmdToEyePose;
+
+		glm::mat4 proj = glm::frustum(-fov.LeftTan * MIRROR_Z_NEAR, fov.RightTan * MIRROR_Z_NEAR,
+			-fov.DownTan * MIRROR_Z_NEAR, fov.UpTan * MIRROR_Z_NEAR, MIRROR_Z_NEAR, MIRROR_Z_FAR);
+		proj = glm::scale(glm::mat4(1), glm::vec3(1, -1, 1)) * proj;
+		const glm::mat4 mvp = proj * glm::inverse(pose_matrix(eyePose)) * quadModel;
+
+		GLfloat clipCorners[16];
+		for (int i = 0; i < 4; i++)
+		{
+			const glm::vec4 clip = mvp * corners[i];
+			clipCorners[i * 4 + 0] = clip.x;
+			clipCorners[i * 4 + 1] = clip.y;
+			clipCorners[i * 4 + 2] = clip.z;
+			clipCorners[i * 4 + 3] = clip.w;
+		}
+		glUniform4fv(this->_quadCornersLocation, 4, clipCorners);
+		glViewport(eye * halfWidth, 0, halfWidth, this->_mirrorSize.h);
+		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	}
+
+	// restore GL state
+	glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, lastDrawFBO);
+	glUseProgram(lastProgram);
+	glBindVertexArray(lastVAO);
+	glBindTexture(GL_TEXTURE_2D, lastTexture);
+	glBindSampler(0, lastSampler);
+	glActiveTexture(lastActiveTexture);
+	glViewport(lastViewport[0], lastViewport[1], lastViewport[2], lastViewport[3]);
+	glBlendFuncSeparate(lastBlendSrcRgb, lastBlendDstRgb, lastBlendSrcAlpha, lastBlendDstAlpha);
+	if (lastBlend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
+	if (lastDepthTest) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
+	if (lastCullFace) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE);
+	if (lastScissorTest) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST);
+	if (lastFramebufferSrgb) glEnable(GL_FRAMEBUFFER_SRGB); else glDisable(GL_FRAMEBUFFER_SRGB);
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <vector>
+#include "HmdBackend.h"
+#include "imgui_impl_ovr.h"
+
+// Sets the head and hand poses, given the time in seconds since the simulated session started
+typedef void (*SimPoseFunc)(void* userData, double time, ovrTrackingState* out_state);
+
+// Fills in the compositor's stats for the frame it shows after the app submits a frame, e.g. to script dropped frames
+// or ASW. The indices and the app's CPU time are already filled in, as are the counters carried over from the
+// previous frame.
+typedef void (*SimPerfStatsFunc)(void* userData, long long frameIndex, ovrPerfStatsPerCompositorFrame* out_stats);
+
+struct SimHmdConfig
+{
+	// display resolution of each eye, the eye buffers scale with it
+	ovrSizei eyeResolution = { 1080, 1200 };
+
+	// tangents of each eye's field of view, the default is close to a Rift CV1
+	ovrFovPort eyeFov[2] = { { 1.33f, 1.33f, 1.06f, 1.09f }, { 1.33f, 1.33f, 1.09f, 1.06f } };
+
+	float refreshRate = 90.f;
+	float ipd = 0.064f;
+
+	// sleep in wait_to_begin_frame() to hold the refresh rate like the compositor does, rather than running flat out
+	bool throttle = false;
+
+	// scripted head and hand poses, SimHmdBackend::default_poses if not set
+	SimPoseFunc poses = nullptr;
+	void* posesUserData = nullptr;
+
+	// scripted Touch input (e.g. ImGui_ImplOvr_ScriptedInput::Source), nothing pressed if not set
+	ImGui_ImplOvr_InputSourceFunc input = nullptr;
+	void* inputUserData = nullptr;
+
+	// scripted compositor stats, only the indices and the app's CPU time are reported if not set
+	SimPerfStatsFunc perfStats = nullptr;
+	void* perfStatsUserData = nullptr;
+};
+
+// A layer submitted with SimHmdBackend::end_frame(), copied so it can be inspected after the frame
+struct SimLayer
+{
+	ovrLayerHeader header;
+	ovrLayerEyeFov eyeFov;	// set if header.Type is ovrLayerType_EyeFov
+	ovrLayerQuad quad;		// set if header.Type is ovrLayerType_Quad
+};
+
+// HMD backend that simulates a headset on the current GL context, with no Oculus runtime. Swap chains are plain
+// GL textures, frames are timed in simulated time at the refresh rate, poses and input come from scripts, and
+// the eye and quad layers are composited into the mirror texture so there's something to look at. Runs on any GL
+// 4.3 context, including a surfaceless EGL one.
+class SimHmdBackend : public HmdBackend
+{
+private:
+	struct SwapChain
+	{
+		ovrTextureSwapChainDesc desc;
+		std::vector<GLuint> textures;
+		int current = 0;
+		int committed = -1;
+	};
+
+	SimHmdConfig _config;
+	ovrTrackingOrigin _origin = ovrTrackingOrigin_EyeLevel;
+	double _startTime = 0.0;
+	std::vector<SwapChain*> _swapChains;
+	GLuint _mirrorTexture = 0;
+	ovrSizei _mirrorSize = {};
+	GLuint _mirrorFBOs[2] = {};
+	unsigned long long _framesSubmitted = 0;
+	std::vector<SimLayer> _lastFrameLayers;
+
+	// draws quad layers into the mirror, made on the first quad layer submitted
+	GLuint _quadProgram = 0;
+	GLuint _quadVAO = 0;
+	GLuint _quadSampler = 0;
+	GLint _quadCornersLocation = -1;
+	GLint _quadUVsLocation = -1;
+
+	// when the frame being rendered began, and the stats of the frames shown since get_perf_stats() was last called
+	double _frameBeginTime = 0.0;
+	ovrPerfStatsPerCompositorFrame _lastFrameStats = {};
+	std::vector<ovrPerfStatsPerCompositorFrame> _pendingFrameStats;
+	bool _frameStatsDropped = false;
+
+	void copy_to_mirror(const ovrLayerEyeFov& layer);
+	bool create_quad_program();
+	void draw_quad_to_mirror(const ovrLayerQuad& layer, const ovrLayerEyeFov* eyeLayer);
+
+public:
+	SimHmdBackend(const SimHmdConfig& config = SimHmdConfig()) : _config(config) {}
+	SimHmdBackend(const SimHmdBackend& other) = delete;
+	SimHmdBackend& operator=(const SimHmdBackend& other) = delete;
+	~SimHmdBackend();
+
+	const SimHmdConfig& config() const { return this->_config; }
+	unsigned long long frames_submitted() const { return this->_framesSubmitted; }
+	const std::vector<SimLayer>& last_frame_layers() const { return this->_lastFrameLayers; }
+
+	static void default_poses(void* userData, double time, ovrTrackingState* out_state);
+
+	bool init() override;
+
+	ovrHmdDesc get_hmd_desc() override;
+	ovrSizei get_fov_texture_size(ovrEyeType eye, ovrFovPort fov, float pixelsPerDisplayPixel) override;
+	ovrEyeRenderDesc get_render_desc(ovrEyeType eye, ovrFovPort fov) override;
+	void set_tracking_origin(ovrTrackingOrigin origin) override;
+	void recenter_tracking_origin() override;
+	ovrSessionStatus get_session_status() override;
+	double get_time_in_seconds() override;
+
+	bool wait_to_begin_frame(long long frameIndex) override;
+	bool begin_frame(long long frameIndex) override;
+	bool end_frame(long long frameIndex, const ovrLayerHeader* const* layers, unsigned int layerCount) override;
+	double get_predicted_display_time(long long frameIndex) override;
+	bool get_perf_stats(ovrPerfStats* out_stats) override;
+
+	ovrTrackingState get_tracking_state(double absTime) override;
+	bool get_input_state(ovrInputState* out_state) override;
+	bool submit_controller_vibration(ovrControllerType controller, const ovrHapticsBuffer* buffer) override;
+
+	ovrTextureSwapChain create_swap_chain(const ovrTextureSwapChainDesc& desc) override;
+	void destroy_swap_chain(ovrTextureSwapChain chain) override;
+	int get_swap_chain_length(ovrTextureSwapChain chain) override;
+	int get_swap_chain_current_index(ovrTextureSwapChain chain) override;
+	GLuint get_swap_chain_buffer(ovrTextureSwapChain chain, int index) override;
+	bool commit_swap_chain(ovrTextureSwapChain chain) override;
+
+	bool create_mirror_texture(const ovrMirrorTextureDesc& desc, GLuint* out_texture) override;
+};
@@ -1,16 +1,23 @@
 #include "TextureBuffer.h"
 
-TextureBuffer::TextureBuffer(ovrSession session, bool rendertarget, bool displayableOnHmd, ovrSizei size, int mipLevels, unsigned char * data, int sampleCount)
+#include <iostream>
+
+TextureBuffer::TextureBuffer(HmdBackend* hmd, bool rendertarget, bool displayableOnHmd, ovrSizei size, int mipLevels, unsigned char * data, int sampleCount,
+	int arraySize, DepthBuffer* dbuffer, bool multiview)
 	:
-	session(session),
+	hmd(hmd),
 	textureChain(nullptr),
 	texId(0),
-	fboId(0)
+	arraySize(arraySize),
+	depthBuffer(dbuffer)
 {
 	texSize = size;
 
 	if (displayableOnHmd)
 	{
+		// array swap chains aren't supported with OpenGL on PC
+		this->arraySize = 1;
+
 		// This texture isn't necessarily going to be a rendertarget, but it usually is.
 		ovrTextureSwapChainDesc desc = {};
 		desc.Type = ovrTexture_2D;
@@ -22,20 +29,14 @@ TextureBuffer::TextureBuffer(ovrSession session, bool rendertarget, bool display
 		desc.SampleCount = 1;
 		desc.StaticImage = ovrFalse;
 
-		ovrErrorInfo info;
-		ovr_GetLastErrorInfo(&info);
-
-		ovrResult result = ovr_CreateTextureSwapChainGL(session, &desc, &textureChain);
+		textureChain = hmd->create_swap_chain(desc);
 
-		int length = 0;
-		ovr_GetTextureSwapChainLength(session, textureChain, &length);
-
-		if (OVR_SUCCESS(result))
+		if (textureChain)
 		{
+			const int length = hmd->get_swap_chain_length(textureChain);
 			for (int i = 0; i < length; ++i)
 			{
-				GLuint chainTexId;
-				ovr_GetTextureSwapChainBufferGL(session, textureChain, i, &chainTexId);
+				GLuint chainTexId = hmd->get_swap_chain_buffer(textureChain, i);
 				glBindTexture(GL_TEXTURE_2D, chainTexId);
 
 				if (rendertarget)
@@ -55,6 +56,20 @@ TextureBuffer::TextureBuffer(ovrSession session, bool rendertarget, bool display
 			}
 		}
 	}
+	else if (arraySize > 1)
+	{
+		// a texture array the size of one eye with a layer per eye, for rendering both eyes in one pass.
+		// LibOVR doesn't support array swap chains with OpenGL on PC, so layers are copied to the eye swap chains.
+		glGenTextures(1, &texId);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, texId);
+
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_SRGB8_ALPHA8, texSize.w, texSize.h, arraySize, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+	}
 	else
 	{
 		glGenTextures(1, &texId);
@@ -80,8 +95,45 @@ TextureBuffer::TextureBuffer(ovrSession session, bool rendertarget, bool display
 
 	if (mipLevels > 1)
 	{
-		glGenerateMipmap(GL_TEXTURE_2D);
+		glGenerateMipmap(arraySize > 1 && !displayableOnHmd ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D);
+	}
+
+	if (!rendertarget || !dbuffer || (displayableOnHmd && !textureChain))
+	{
+		return;
 	}
 
-	glGenFramebuffers(1, &fboId);
+	// Attaching textures to a framebuffer makes the driver check it's complete again the next time it's used, so
+	// every image gets its own framebuffer up front
+	const int images = textureChain ? hmd->get_swap_chain_length(textureChain) : 1;
+	fboIds.resize(images);
+	glGenFramebuffers(images, fboIds.data());
+	for (int i = 0; i < images; ++i)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, fboIds[i]);
+		if (this->arraySize > 1 && multiview)
+		{
+			// all layers as views with GL_OVR_multiview
+			glFramebufferTextureMultiviewOVR(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texId, 0, 0, this->arraySize);
+			glFramebufferTextureMultiviewOVR(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, dbuffer->texId, 0, 0, this->arraySize);
+		}
+		else if (this->arraySize > 1)
+		{
+			// all layers as a layered attachment written with gl_Layer
+			glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texId, 0);
+			glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, dbuffer->texId, 0);
+		}
+		else
+		{
+			const GLuint colorTexId = textureChain ? hmd->get_swap_chain_buffer(textureChain, i) : texId;
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexId, 0);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, dbuffer->texId, 0);
+		}
+
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			std::cerr << "Framebuffer of texture buffer image " << i << " is incomplete" << std::endl;
+		}
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
@@ -9,22 +9,31 @@
 #include <LibOVR/OVR_CAPI_GL.h>
 #include "GL.h"
 #include "DepthBuffer.h"
+#include "HmdBackend.h"
+
+#include <vector>
 
 struct TextureBuffer
 {
-	ovrSession          session;
+	HmdBackend*         hmd;
 	ovrTextureSwapChain  textureChain;
 	GLuint              texId;
-	GLuint              fboId;
 	ovrSizei               texSize;
+	int                 arraySize;
+
+	// A complete framebuffer per swap chain image (just one without a swap chain) with the depth buffer attached,
+	// built once so binding the buffer for rendering never changes attachments
+	DepthBuffer*        depthBuffer;
+	std::vector<GLuint> fboIds;
 
-	TextureBuffer(ovrSession session, bool rendertarget, bool displayableOnHmd, ovrSizei size, int mipLevels, unsigned char * data, int sampleCount);
+	TextureBuffer(HmdBackend* hmd, bool rendertarget, bool displayableOnHmd, ovrSizei size, int mipLevels, unsigned char * data, int sampleCount,
+		int arraySize = 1, DepthBuffer* dbuffer = nullptr, bool multiview = false);
 
 	~TextureBuffer()
 	{
 		if (textureChain)
 		{
-			ovr_DestroyTextureSwapChain(session, textureChain);
+			hmd->destroy_swap_chain(textureChain);
 			textureChain = nullptr;
 		}
 		if (texId)
@@ -32,10 +41,10 @@ struct TextureBuffer
 			glDeleteTextures(1, &texId);
 			texId = 0;
 		}
-		if (fboId)
+		if (!fboIds.empty())
 		{
-			glDeleteFramebuffers(1, &fboId);
-			fboId = 0;
+			glDeleteFramebuffers((GLsizei)fboIds.size(), fboIds.data());
+			fboIds.clear();
 		}
 	}
 
@@ -44,41 +53,82 @@ struct TextureBuffer
 		return texSize;
 	}
 
-	void SetAndClearRenderSurface(DepthBuffer* dbuffer)
+	// The framebuffer of the swap chain image to render into next
+	GLuint GetFramebuffer() const
 	{
-		GLuint curTexId;
-		if (textureChain)
+		if (fboIds.empty())
 		{
-			int curIndex;
-			ovr_GetTextureSwapChainCurrentIndex(session, textureChain, &curIndex);
-			ovr_GetTextureSwapChainBufferGL(session, textureChain, curIndex, &curTexId);
-		}
-		else
-		{
-			curTexId = texId;
+			return 0;
 		}
+		return fboIds[textureChain ? hmd->get_swap_chain_current_index(textureChain) : 0];
+	}
 
-		glBindFramebuffer(GL_FRAMEBUFFER, fboId);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, curTexId, 0);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, dbuffer->texId, 0);
+	// Binds the buffer for rendering into a viewport, the whole texture if viewport is null. A texture array
+	// buffer has all its layers bound, every layer gets the same viewport.
+	void SetAndClearRenderSurface(const ovrRecti* viewport = nullptr)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, GetFramebuffer());
+		SetAndClearViewport(viewport);
+	}
+
+	// Sets the viewport and clears only what's inside it, the rest of a texture rendered at a lower resolution
+	// is never shown
+	void SetAndClearViewport(const ovrRecti* viewport)
+	{
+		const ovrRecti rect = viewport ? *viewport : ovrRecti{ { 0, 0 }, texSize };
+		const bool partial = rect.Pos.x != 0 || rect.Pos.y != 0 || rect.Size.w != texSize.w || rect.Size.h != texSize.h;
 
-		glViewport(0, 0, texSize.w, texSize.h);
+		glViewport(rect.Pos.x, rect.Pos.y, rect.Size.w, rect.Size.h);
+		if (partial)
+		{
+			glScissor(rect.Pos.x, rect.Pos.y, rect.Size.w, rect.Size.h);
+			glEnable(GL_SCISSOR_TEST);
+		}
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		if (partial)
+		{
+			glDisable(GL_SCISSOR_TEST);
+		}
 		glEnable(GL_FRAMEBUFFER_SRGB);
 	}
 
-	void UnsetRenderSurface()
+	// Copies one layer of a texture array buffer into the current image of another buffer's swap chain, only the
+	// given region if rect isn't null
+	void CopyLayerTo(TextureBuffer* dest, int layer, const ovrRecti* rect = nullptr) const
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, fboId);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+		GLuint destTexId;
+		if (dest->textureChain)
+		{
+			destTexId = dest->hmd->get_swap_chain_buffer(dest->textureChain, dest->hmd->get_swap_chain_current_index(dest->textureChain));
+		}
+		else
+		{
+			destTexId = dest->texId;
+		}
+
+		const ovrRecti region = rect ? *rect : ovrRecti{ { 0, 0 }, dest->texSize };
+		glCopyImageSubData(texId, GL_TEXTURE_2D_ARRAY, 0, region.Pos.x, region.Pos.y, layer, destTexId, GL_TEXTURE_2D, 0,
+			region.Pos.x, region.Pos.y, 0, region.Size.w, region.Size.h, 1);
+	}
+
+	// Ends rendering into the buffer. The depth buffer is only needed during the pass, so unless told otherwise
+	// the driver is told its contents can be dropped rather than written back to memory.
+	void UnsetRenderSurface(bool invalidateDepth = true)
+	{
+		if (invalidateDepth && glInvalidateFramebuffer)
+		{
+			const GLenum attachment = GL_DEPTH_ATTACHMENT;
+			glBindFramebuffer(GL_FRAMEBUFFER, GetFramebuffer());
+			glInvalidateFramebuffer(GL_FRAMEBUFFER, 1, &attachment);
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
 	}
 
 	void Commit()
 	{
 		if (textureChain)
 		{
-			ovr_CommitTextureSwapChain(session, textureChain);
+			hmd->commit_swap_chain(textureChain);
 		}
 	}
 };
@@ -1,20 +1,20 @@
 #include "VR.h"
+#include "imgui_impl_ovr_gputimer.h"
+#include "imgui_impl_ovr_profiler.h"
 #include <algorithm>
+#include <cstring>
 #include <iostream>
-#include <LibOVR/Extras/OVR_Math.h>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/string_cast.hpp>
 
-ovrSession VR::vrSession;
-ovrGraphicsLuid VR::hmdLuid;
+HmdBackend *VR::hmd = nullptr;
 ovrHmdDesc VR::hmdDesc;
 TextureBuffer *VR::textureSwapchains[2] = {};
 DepthBuffer *VR::textureDepthBuffers[2] = {};
 ovrSizei VR::textureSizes[2] = {};
-ovrMirrorTexture VR::mirrorTexture;
 ovrSizei VR::bufferSize;
-GLuint VR::mirrorFBO;
-GLuint VR::mirrorTextureHandle;
+GLuint VR::mirrorFBO = 0;
+GLuint VR::mirrorTextureHandle = 0;
 ovrEyeRenderDesc VR::eyeRenderDescs[2] = {};
 ovrLayerEyeFov VR::layer;
 Camera *VR::pCamera;
@@ -22,48 +22,116 @@ glm::mat4 VR::currentProjection;
 glm::mat4 VR::currentView;
 ovrSizei VR::windowSize;
 long long VR::frameIndex = 0;
+DynamicResolution VR::dynamicResolution;
+ImGui_ImplOvr_DeviceSnapshot VR::deviceSnapshot = { -1 };
+glm::mat4 VR::eyeProjections[2];
+glm::mat4 VR::eyeViews[2];
+TextureBuffer *VR::stereoBuffer = nullptr;
+DepthBuffer *VR::stereoDepthBuffer = nullptr;
+bool VR::stereoMultiview = false;
 
 VAO *VR::pMirrorQuadVao;
 Shader *VR::pMirrorShader;
 
-void VR::begin_frame()
+// the GPU phase of the eye pass in progress, see ImGui_ImplOvr_BeginGpuPhase()
+static int eyeGpuPhase = -1;
+
+// update_resolution() adds up every phase whose name starts with "VR::eye"
+static const char* const eyeGpuPhaseNames[2] = { "VR::eye left", "VR::eye right" };
+
+// the pose of an eye given the head pose and the eye's offset from the head, what ovr_CalcEyePoses() does
+static ovrPosef calc_eye_pose(const ovrPosef& head, const ovrPosef& hmdToEye)
 {
-	ovrPosef ViewOffset[2] =
-	{
-		eyeRenderDescs[0].HmdToEyePose,
-		eyeRenderDescs[1].HmdToEyePose
-	};
+	const glm::quat headRot(head.Orientation.w, head.Orientation.x, head.Orientation.y, head.Orientation.z);
+	const glm::quat eyeRot(hmdToEye.Orientation.w, hmdToEye.Orientation.x, hmdToEye.Orientation.y, hmdToEye.Orientation.z);
+	const glm::vec3 pos = glm::vec3(head.Position.x, head.Position.y, head.Position.z) +
+		headRot * glm::vec3(hmdToEye.Position.x, hmdToEye.Position.y, hmdToEye.Position.z);
+	const glm::quat rot = headRot * eyeRot;
+
+	ovrPosef eye;
+	eye.Position = { pos.x, pos.y, pos.z };
+	eye.Orientation = { rot.x, rot.y, rot.z, rot.w };
+	return eye;
+}
 
+void VR::begin_frame()
+{
+	IMGUI_OVR_PROFILE_SCOPE("VR::begin_frame");
 	layer.Header.Type = ovrLayerType_EyeFov;
 	layer.Header.Flags = ovrLayerFlag_TextureOriginAtBottomLeft;
 	layer.ColorTexture[0] = textureSwapchains[0]->textureChain;
 	layer.ColorTexture[1] = textureSwapchains[1]->textureChain;
 	layer.Fov[0] = eyeRenderDescs[0].Fov;
 	layer.Fov[1] = eyeRenderDescs[1].Fov;
-	layer.Viewport[0] = OVR::Recti(textureSwapchains[0]->GetSize());
-	layer.Viewport[1] = OVR::Recti(textureSwapchains[1]->GetSize());
 
-	// Get both eye poses simultaneously, with IPD offset already included.
-	const double displayMidpointSeconds = ovr_GetPredictedDisplayTime(vrSession, 0);
-	const ovrTrackingState hmdState = ovr_GetTrackingState(vrSession, displayMidpointSeconds, ovrTrue);
-	ovr_CalcEyePoses(hmdState.HeadPose.ThePose, ViewOffset, layer.RenderPose);
+	// the eyes render into the bottom left of their swap chains, which are allocated at the highest resolution
+	update_resolution();
+	const float fraction = dynamicResolution.scale() / dynamicResolution.config().maxScale;
+	for (int eye = 0; eye < 2; eye++)
+	{
+		const ovrSizei size = textureSwapchains[eye]->GetSize();
+		layer.Viewport[eye].Pos.x = 0;
+		layer.Viewport[eye].Pos.y = 0;
+		layer.Viewport[eye].Size.w = std::max(1, std::min(size.w, (int)(size.w * fraction + 0.5f)));
+		layer.Viewport[eye].Size.h = std::max(1, std::min(size.h, (int)(size.h * fraction + 0.5f)));
+	}
 
-	ovrResult result = ovr_WaitToBeginFrame(vrSession, 0);
-	result = ovr_BeginFrame(vrSession, 0);
+	{
+		IMGUI_OVR_PROFILE_SCOPE("HmdBackend::wait_to_begin_frame");
+		hmd->wait_to_begin_frame(frameIndex);
+	}
+
+	// Sample the devices once for the whole frame, once the compositor lets it start so the prediction is as
+	// short as it can be. The head pose, the GUI pointer and the buttons all come from this snapshot, which is
+	// recorded or replayed by the GUI renderer when it's asked to.
+	ImGui_ImplOvr_CaptureDeviceSnapshot(&deviceSnapshot);
+
+	// Get both eye poses from the head pose, with the IPD offset included.
+	layer.RenderPose[0] = calc_eye_pose(deviceSnapshot.Tracking.HeadPose.ThePose, eyeRenderDescs[0].HmdToEyePose);
+	layer.RenderPose[1] = calc_eye_pose(deviceSnapshot.Tracking.HeadPose.ThePose, eyeRenderDescs[1].HmdToEyePose);
+	layer.SensorSampleTime = hmd->get_time_in_seconds();
+
+	hmd->begin_frame(frameIndex);
 }
 
-void VR::end_frame()
+void VR::end_frame(const ovrLayerHeader* const* extraLayers, int extraLayerCount)
 {
-	ovrLayerHeader *layers = &layer.Header;
-	ovrResult result = ovr_EndFrame(vrSession, 0, nullptr, &layers, 1);
-	OVR_VALIDATE(OVR_SUCCESS(result), "Failed to submit frame to HMD");
+	IMGUI_OVR_PROFILE_SCOPE("VR::end_frame");
+	// the eye layer goes first, extra layers (e.g. the GUI canvas quad) are composited on top of it
+	const ovrLayerHeader *layers[ovrMaxLayerCount] = { &layer.Header };
+	int layerCount = 1;
+	for (int i = 0; i < extraLayerCount && layerCount < ovrMaxLayerCount; i++)
+	{
+		if (extraLayers[i])
+		{
+			layers[layerCount++] = extraLayers[i];
+		}
+	}
+
+	bool submitted;
+	{
+		IMGUI_OVR_PROFILE_SCOPE("HmdBackend::end_frame");
+		submitted = hmd->end_frame(frameIndex, layers, layerCount);
+	}
+	OVR_VALIDATE(submitted, "Failed to submit frame to HMD");
 
-	ovrSessionStatus sessionStatus;
-	ovr_GetSessionStatus(vrSession, &sessionStatus);
+	// the compositor's timing of the frames it showed since the last one, kept for the GUI renderer's perf stats
+	ImGui_ImplOvr_PollPerfStats();
+
+	const ovrSessionStatus sessionStatus = hmd->get_session_status();
 	if (sessionStatus.ShouldQuit)
 		exit(-1);
 	if (sessionStatus.ShouldRecenter)
-		ovr_RecenterTrackingOrigin(vrSession);
+		hmd->recenter_tracking_origin();
+
+	// without a window (a headless simulated HMD) there's no mirror texture
+	if (!mirrorTextureHandle)
+	{
+		frameIndex++;
+		return;
+	}
+
+	const int mirrorGpuPhase = ImGui_ImplOvr_BeginGpuPhase("VR::mirror");
 
 	// bind framebuffers to draw mirror texture
 	glViewport(0, 0, windowSize.w, windowSize.h);
@@ -91,13 +159,52 @@ void VR::end_frame()
 	glDepthMask(GL_TRUE);
 	glEnable(GL_DEPTH_TEST);
 
+	ImGui_ImplOvr_EndGpuPhase(mirrorGpuPhase);
+
 	frameIndex++;
 }
 
 void VR::begin_eye(int eye)
 {
-	textureSwapchains[eye]->SetAndClearRenderSurface(textureDepthBuffers[eye]);
-	
+	eyeGpuPhase = ImGui_ImplOvr_BeginGpuPhase(eyeGpuPhaseNames[eye]);
+	textureSwapchains[eye]->SetAndClearRenderSurface(&layer.Viewport[eye]);
+
+	update_eye_matrices(eye);
+	currentView = eyeViews[eye];
+	currentProjection = eyeProjections[eye];
+}
+
+void VR::end_eye(int eye)
+{
+	textureSwapchains[eye]->UnsetRenderSurface();
+	textureSwapchains[eye]->Commit();
+	ImGui_ImplOvr_EndGpuPhase(eyeGpuPhase);
+}
+
+void VR::begin_stereo()
+{
+	eyeGpuPhase = ImGui_ImplOvr_BeginGpuPhase("VR::eyes stereo");
+	stereoBuffer->SetAndClearRenderSurface(&layer.Viewport[0]);
+
+	update_eye_matrices(0);
+	update_eye_matrices(1);
+}
+
+void VR::end_stereo()
+{
+	stereoBuffer->UnsetRenderSurface();
+
+	// copy each layer out to its eye's swap chain
+	for (int eye = 0; eye < 2; eye++)
+	{
+		stereoBuffer->CopyLayerTo(textureSwapchains[eye], eye, &layer.Viewport[eye]);
+		textureSwapchains[eye]->Commit();
+	}
+	ImGui_ImplOvr_EndGpuPhase(eyeGpuPhase);
+}
+
+void VR::update_eye_matrices(int eye)
+{
 	ovrVector3f ovrEyePos = layer.RenderPose[eye].Position;
 	glm::vec3 eyePos = glm::vec3(ovrEyePos.x, ovrEyePos.y, ovrEyePos.z);
 	ovrQuatf ovrEyeRot = layer.RenderPose[eye].Orientation;
@@ -109,17 +216,32 @@ void VR::begin_eye(int eye)
 	glm::vec3 up = orient * glm::vec4(0, 1, 0, 0);
 	glm::vec3 forward = orient * glm::vec4(0, 0, -1, 0);
 	glm::mat4 view = glm::lookAt(pos, pos + forward, up);
-	currentView = view;
+	eyeViews[eye] = view;
 
-	ovrMatrix4f ovrProj = ovrMatrix4f_Projection(layer.Fov[eye], 0.1f, 100.f, 0);
-	glm::mat4 proj = glm::make_mat4((float*)&ovrProj.M);
-	currentProjection = glm::transpose(proj);
+	// off-center frustum from the FOV tangents, what ovrMatrix4f_Projection() makes but with the OpenGL clip range
+	const ovrFovPort& fov = layer.Fov[eye];
+	const float zNear = 0.1f;
+	const float zFar = 100.f;
+	eyeProjections[eye] = glm::frustum(-fov.LeftTan * zNear, fov.RightTan * zNear, -fov.DownTan * zNear, fov.UpTan * zNear, zNear, zFar);
 }
 
-void VR::end_eye(int eye)
+void VR::update_resolution()
 {
-	textureSwapchains[eye]->UnsetRenderSurface();
-	textureSwapchains[eye]->Commit();
+	// the GPU time of the eye passes of the last frame the GPU timer has results for, a few frames back
+	ImGui_ImplOvr_GpuTiming timings[IMGUI_OVR_GPU_TIMER_MAX_PHASES];
+	long long timingFrameIndex = -1;
+	const int timingCount = ImGui_ImplOvr_GetGpuTimings(timings, IMGUI_OVR_GPU_TIMER_MAX_PHASES, &timingFrameIndex);
+
+	double eyesMs = 0.0;
+	for (int i = 0; i < timingCount; i++)
+	{
+		if (strncmp(timings[i].Name, "VR::eye", 7) == 0)
+		{
+			eyesMs += timings[i].Milliseconds;
+		}
+	}
+
+	dynamicResolution.update(frameIndex, timingFrameIndex, (float)eyesMs);
 }
 
 void VR::set_screen(size_t width, size_t height)
@@ -128,7 +250,23 @@ void VR::set_screen(size_t width, size_t height)
 	windowSize.h = height;
 }
 
-bool VR::init(size_t window_width, size_t window_height)
+bool VR::init_stereo(bool multiview)
+{
+	// both eyes are rendered into layers of the same size, so the eye buffers have to match
+	if (textureSizes[0].w != textureSizes[1].w || textureSizes[0].h != textureSizes[1].h)
+	{
+		OVR_VALIDATE(false, "Eye buffer sizes differ, can't render in a single pass");
+		return false;
+	}
+
+	stereoDepthBuffer = new DepthBuffer(textureSizes[0], 0, 2);
+	stereoBuffer = new TextureBuffer(hmd, true, false, textureSizes[0], 1, nullptr, 1, 2, stereoDepthBuffer, multiview);
+	stereoMultiview = multiview;
+
+	return true;
+}
+
+bool VR::init(HmdBackend* backend, size_t window_width, size_t window_height, const DynamicResolutionConfig& resolution)
 {
 	// the quad that the mirror texture is rendered onto
 	pMirrorQuadVao = new VAO(
@@ -144,31 +282,23 @@ bool VR::init(size_t window_width, size_t window_height)
 	);
 	pMirrorShader = new Shader("vrMirror", "shaders/vrMirror");
 
-	
-	ovrResult result;
-
-	result = ovr_Initialize(nullptr);
-	OVR_VALIDATE(OVR_SUCCESS(result), "Failed to init HMD");
-	if (result)
-	{
-		return false;
-	}
-
-	result = ovr_Create(&vrSession, &hmdLuid);
-	OVR_VALIDATE(OVR_SUCCESS(result), "Failed to init HMD");
-	if (result)
+	hmd = backend;
+	if (!hmd || !hmd->init())
 	{
+		OVR_VALIDATE(false, "Failed to init HMD");
 		return false;
 	}
 
-	hmdDesc = ovr_GetHmdDesc(vrSession);
+	hmdDesc = hmd->get_hmd_desc();
+	dynamicResolution = DynamicResolution(resolution, 1000.f / hmdDesc.DisplayRefreshRate);
 
-	// create eye Render buffers
+	// create eye Render buffers, at the highest resolution so changing it never reallocates them
 	for (int eye = 0; eye < 2; ++eye)
 	{
-		const ovrSizei idealTextureSize = ovr_GetFovTextureSize(vrSession, ovrEyeType(eye), hmdDesc.DefaultEyeFov[eye], 1.f);
-		textureSwapchains[eye] = new TextureBuffer(vrSession, true, true, idealTextureSize, 1, nullptr, 1);
-		textureDepthBuffers[eye] = new DepthBuffer(textureSwapchains[eye]->GetSize(), 0);
+		const ovrSizei idealTextureSize = hmd->get_fov_texture_size(ovrEyeType(eye), hmdDesc.DefaultEyeFov[eye],
+			dynamicResolution.config().maxScale);
+		textureDepthBuffers[eye] = new DepthBuffer(idealTextureSize, 0);
+		textureSwapchains[eye] = new TextureBuffer(hmd, true, true, idealTextureSize, 1, nullptr, 1, 1, textureDepthBuffers[eye]);
 
 		if (!textureSwapchains[eye]->textureChain)
 		{
@@ -183,41 +313,36 @@ bool VR::init(size_t window_width, size_t window_height)
 	bufferSize.w = textureSwapchains[0]->GetSize().w + textureSwapchains[1]->GetSize().w;
 	bufferSize.h = std::max(textureSwapchains[0]->GetSize().h, textureSwapchains[1]->GetSize().h);
 
-	// create mirror texture
-	ovrMirrorTextureDesc mirrorDesc;
-	memset(&mirrorDesc, 0, sizeof(mirrorDesc));
-	mirrorDesc.Width = bufferSize.w;
-	mirrorDesc.Height = bufferSize.h;
-	mirrorDesc.Format = OVR_FORMAT_R8G8B8A8_UNORM_SRGB;
-	mirrorDesc.MirrorOptions = ovrMirrorOption_PostDistortion;
-	result = ovr_CreateMirrorTextureWithOptionsGL(vrSession, &mirrorDesc, &mirrorTexture);
-	OVR_VALIDATE(OVR_SUCCESS(result), "Failed to create mirror texture");
-	if (result)
-	{
-		return false;
-	}
-
 	windowSize.w = window_width;
 	windowSize.h = window_height;
 
-	ovr_GetMirrorTextureBufferGL(vrSession, mirrorTexture, &mirrorTextureHandle);
-
-	// configure read buffer for mirror
-	glGenFramebuffers(1, &mirrorFBO);
-	glBindFramebuffer(GL_READ_FRAMEBUFFER, mirrorFBO);
-	glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mirrorTextureHandle, 0);
-	glFramebufferRenderbuffer(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, 0);
-	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
-
-	eyeRenderDescs[0] = ovr_GetRenderDesc(vrSession, ovrEye_Left, hmdDesc.DefaultEyeFov[0]);
-	eyeRenderDescs[1] = ovr_GetRenderDesc(vrSession, ovrEye_Right, hmdDesc.DefaultEyeFov[1]);
+	// create mirror texture, unless there's no window to show it in
+	if (windowSize.w > 0 && windowSize.h > 0)
+	{
+		ovrMirrorTextureDesc mirrorDesc;
+		memset(&mirrorDesc, 0, sizeof(mirrorDesc));
+		mirrorDesc.Width = bufferSize.w;
+		mirrorDesc.Height = bufferSize.h;
+		mirrorDesc.Format = OVR_FORMAT_R8G8B8A8_UNORM_SRGB;
+		mirrorDesc.MirrorOptions = ovrMirrorOption_PostDistortion;
+		if (!hmd->create_mirror_texture(mirrorDesc, &mirrorTextureHandle))
+		{
+			OVR_VALIDATE(false, "Failed to create mirror texture");
+			return false;
+		}
 
-	// turn off vsync and let the compositor "do its magic"
-	glfwSwapInterval(0);
+		// configure read buffer for mirror
+		glGenFramebuffers(1, &mirrorFBO);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, mirrorFBO);
+		glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mirrorTextureHandle, 0);
+		glFramebufferRenderbuffer(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, 0);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	}
 
-	ovr_SetTrackingOriginType(vrSession, ovrTrackingOrigin_EyeLevel);
+	eyeRenderDescs[0] = hmd->get_render_desc(ovrEye_Left, hmdDesc.DefaultEyeFov[0]);
+	eyeRenderDescs[1] = hmd->get_render_desc(ovrEye_Right, hmdDesc.DefaultEyeFov[1]);
 
-	ovrTrackingState ts = ovr_GetTrackingState(vrSession, ovr_GetTimeInSeconds(), ovrTrue);
+	hmd->set_tracking_origin(ovrTrackingOrigin_EyeLevel);
 
 	return true;
 }
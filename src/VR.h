@@ -3,22 +3,24 @@
 #include <glm/glm.hpp>
 #include "GL.h"
 #include "Camera.h"
+#include "DynamicResolution.h"
 #include "TextureBuffer.h"
 #include "VAO.h"
 #include "Shader.h"
+#include "HmdBackend.h"
+#include "imgui_impl_ovr.h"
 
 #define OVR_VALIDATE(x, msg) if (!(x)) { std::cerr << msg << std::endl; }
 
 class VR
 {
 public:
-	static ovrSession vrSession;
-	static ovrGraphicsLuid hmdLuid;
+	// the Oculus runtime or a simulated HMD, every session call goes through it
+	static HmdBackend* hmd;
 	static ovrHmdDesc hmdDesc;
 	static TextureBuffer *textureSwapchains[2];
 	static DepthBuffer *textureDepthBuffers[2];
 	static ovrSizei textureSizes[2];
-	static ovrMirrorTexture mirrorTexture;
 	static ovrSizei bufferSize;
 	static GLuint mirrorFBO;
 	static GLuint mirrorTextureHandle;
@@ -30,15 +32,36 @@ public:
 	static ovrSizei windowSize;
 	static long long frameIndex;
 
+	// picks the eye buffers' resolution each frame, see update_resolution()
+	static DynamicResolution dynamicResolution;
+
+	// tracking and input state for the current frame, sampled once in begin_frame()
+	static ImGui_ImplOvr_DeviceSnapshot deviceSnapshot;
+
+	// both eyes' matrices for the current frame, set in begin_eye() or begin_stereo()
+	static glm::mat4 eyeProjections[2];
+	static glm::mat4 eyeViews[2];
+
+	// 2 layer color and depth buffers for rendering both eyes in a single pass, created by init_stereo()
+	static TextureBuffer *stereoBuffer;
+	static DepthBuffer *stereoDepthBuffer;
+	static bool stereoMultiview;
+
 	// VAO and shader used for drawing mirror texture quad on screen
 	static VAO *pMirrorQuadVao;
 	static Shader *pMirrorShader;
 
-	static bool init(size_t window_width, size_t window_height);
+	static bool init(HmdBackend* backend, size_t window_width, size_t window_height,
+		const DynamicResolutionConfig& resolution = DynamicResolutionConfig());
+	static bool init_stereo(bool multiview);
 
 	static void begin_frame();
-	static void end_frame();
+	static void end_frame(const ovrLayerHeader* const* extraLayers = nullptr, int extraLayerCount = 0);
 	static void begin_eye(int eye);
 	static void end_eye(int eye);
+	static void begin_stereo();
+	static void end_stereo();
+	static void update_eye_matrices(int eye);
+	static void update_resolution();
 	static void set_screen(size_t width, size_t height);
 };
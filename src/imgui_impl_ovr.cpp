@@ -3,24 +3,71 @@
 // (Note: Glad is used as the OpenGL platform binding, but can be replaced with whatever works best for you)
 
 #include "imgui_impl_ovr.h"
+#include "imgui_impl_ovr_gputimer.h"
+#include "imgui_impl_ovr_hittest.h"
+#include "imgui_impl_ovr_input.h"
+#include "imgui_impl_ovr_perfstats.h"
+#include "imgui_impl_ovr_profiler.h"
+#include "imgui_impl_ovr_record.h"
+#include "HmdBackend.h"
 
 #include <imgui.h>
 #include <glad/glad.h> // OpenGL bindings
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtc/type_ptr.hpp>
-#include <glm/gtx/intersect.hpp>
 #include <glm/gtx/string_cast.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 #include <LibOVR/OVR_CAPI.h> // Oculus SDK
+#include <LibOVR/OVR_CAPI_GL.h>
 #include "imgui_internal.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+
+// Number of frames worth of segments in the persistent mapped upload ring buffer. Each segment
+// is guarded by a fence, so the CPU can run this many frames ahead of the GPU before blocking.
+#define IMGUI_OVR_UPLOAD_RING_SEGMENTS 3
+
+// Largest width and height the layers of the canvas atlas grow to before more layers are added, unless a panel needs
+// more. The layers start at the smallest power of 2 that could hold every canvas. Clamped to GL_MAX_TEXTURE_SIZE.
+#define IMGUI_OVR_CANVAS_ATLAS_SIZE 4096
+
+// Mip levels of the canvas atlas. Canvases are placed on multiples of IMGUI_OVR_CANVAS_ALIGN texels with at least
+// that much padding, so no level of a canvas shares texels with a neighbouring canvas.
+#define IMGUI_OVR_CANVAS_MIP_LEVELS 4
+#define IMGUI_OVR_CANVAS_ALIGN (1 << (IMGUI_OVR_CANVAS_MIP_LEVELS - 1))
+
+// The raster scale of a canvas is rounded up to a multiple of IMGUI_OVR_RASTER_SCALE_STEP, and only drops once the
+// panel has needed a lower one for IMGUI_OVR_RASTER_SHRINK_TICKS GUI ticks in a row, so a panel that moves about
+// isn't redrawn in full every tick
+#define IMGUI_OVR_RASTER_SCALE_STEP 0.125f
+#define IMGUI_OVR_RASTER_SHRINK_TICKS 45
+
 // TODO: onscreen keyboard solution?
 
 // Handle of the texture used for fonts
 static GLuint g_FontTexture = 0;
 
+// If true, the font atlas is uploaded as a single channel GL_R8 texture swizzled to (1, 1, 1, R) rather than as
+// RGBA32, using a quarter of the memory. Defaults to true, user-configurable via ImGui_ImplOvr_SetAlpha8FontAtlas(bool enable).
+static bool g_Alpha8FontAtlas = true;
+
+// If true, the font atlas holds a signed distance field of the glyphs instead of their coverage, and the ImGui shader
+// reconstructs sharp edges from it when text is scaled up in the canvas. User-configurable via
+// ImGui_ImplOvr_SetSdfFontAtlas(bool enable, float spread).
+static bool g_SdfFontAtlas = false;
+
+// The distance in atlas pixels covered by the distance field on either side of a glyph's edge
+static float g_SdfSpread = 4.f;
+
+// Size and build time of the font atlas, see ImGui_ImplOvr_GetFontAtlasStats()
+static ImGui_ImplOvr_FontAtlasStats g_FontAtlasStats = {};
+
 // Shader program handles for drawing ImGui elements
 static GLuint g_ShaderHandle = 0, g_VertHandle = 0, g_FragHandle = 0;
 
@@ -29,27 +76,91 @@ static GLuint g_QuadShaderHandle = 0, g_QuadVertHandle = 0, g_QuadFragHandle = 0
 
 static GLuint g_LineShaderHandle = 0, g_LineVertHandle = 0, g_LineFragHandle = 0;
 
-// Handles of GUI render texture and GUI FBO
-static GLuint g_GuiTexture = 0, g_GuiFBO = 0;
+// Shader program handles for drawing the GUI quad and controller line to both eyes at once. They share the fragment
+// shaders of the single eye programs. Only created if single pass stereo is supported, see ImGui_ImplOvr_GetStereoMode().
+static GLuint g_QuadStereoShaderHandle = 0, g_QuadStereoVertHandle = 0;
+static GLuint g_LineStereoShaderHandle = 0, g_LineStereoVertHandle = 0;
+
+// Uniform buffer holding both eyes' projection and view matrices for the stereo shaders, laid out as
+// ImGui_ImplOvr_EyeMatrices, and the uniform block binding point it's bound to while drawing.
+static GLuint g_EyeMatricesUbo = 0;
+#define IMGUI_OVR_EYE_MATRICES_BINDING 0
+
+// std140 layout of the EyeMatrices uniform block of the stereo shaders
+struct ImGui_ImplOvr_EyeMatrices
+{
+	glm::mat4 Proj[2];
+	glm::mat4 View[2];
+};
+
+// Stereo quad uniform locations
+static int g_QuadStereoAttribLocationTex = 0;
+
+// Stereo line uniform locations
+static int g_LineStereoAttribLocationLineColor = 0;
+
+// Handles of the GUI render quad VBO and EBO
+static GLuint g_QuadVbo = 0, g_QuadEbo = 0;
 
-// Handles of the GUI render quad VAO, VBO, and EBO
-static GLuint g_QuadVao = 0, g_QuadVbo = 0, g_QuadEbo = 0;
+// Per-instance data of a panel quad, see ImGui_ImplOvr_UploadPanelInstances(). Every panel is drawn by one
+// instanced draw of the GUI render quad.
+struct ImGui_ImplOvr_PanelInstance
+{
+	glm::mat4 ModelMtx;		// model matrix of the quad, scaled to the panel's size in world units
+	glm::vec4 AtlasRect;	// UV offset (xy) and scale (zw) of the panel's canvas in its atlas layer
+	float AtlasLayer;		// atlas layer holding the panel's canvas
+};
+
+// Vertex attribute locations of the per-instance data, the quad's own position and UV are at 0 and 1.
+// The model matrix takes 4 consecutive locations.
+#define IMGUI_OVR_QUAD_ATTRIB_MODEL_MTX 2
+#define IMGUI_OVR_QUAD_ATTRIB_ATLAS_RECT 6
+#define IMGUI_OVR_QUAD_ATTRIB_ATLAS_LAYER 7
+
+// Handle of the VBO the panel instances are streamed into, and the CPU side staging of them
+static GLuint g_PanelInstanceVbo = 0;
+static ImVector<ImGui_ImplOvr_PanelInstance> g_PanelInstances;
+
+// Handle of the controller pointer line VBO
+static GLuint g_LineVbo = 0;
+
+// The vertex array objects used for drawing in a single GL context. VAOs are the only objects we use
+// that are not shared among GL contexts, so we keep one set of them per context.
+struct ImGui_ImplOvr_ContextVaos
+{
+	void* Context;	// key returned from g_GetCurrentContextFunc, or nullptr if it isn't set
+	GLuint DrawVao;	// ImGui geometry
+	GLuint QuadVao;	// GUI render quad, instanced once per panel
+	GLuint QuadStereoVao;	// GUI render quad for the stereo program, instanced once per panel and eye if needed
+	GLuint LineVao;	// controller pointer line
+	bool Stale;		// the buffers they point at were deleted while another context was current
+};
 
-// Handles of the controller pointer line VAO and VBO
-static GLuint g_LineVao = 0, g_LineVbo = 0;
+// Cache of VAOs for every GL context we've drawn in. Filled in on ImGui_ImplOvr_CreateDeviceObjects() and when
+// drawing in a context we haven't seen before. ImGui_ImplOvr_DestroyDeviceObjects() deletes the current context's
+// and marks the others stale, they're deleted and rebuilt the next time their context is current.
+static ImVector<ImGui_ImplOvr_ContextVaos> g_ContextVaos;
+
+// Returns an identifier for the current GL context, used as the key into g_ContextVaos. If it's not set we assume
+// only one GL context is used. User-configurable via ImGui_ImplOvr_SetCurrentContextFunc().
+static void* (*g_GetCurrentContextFunc)() = nullptr;
 
 // Set to controller position on mouse position update (ImGui_ImplOvr_UpdateMousePos()).
 // Used for drawing controller pointer line.
 static glm::vec3 g_LineStart;
 
-// Set to GUI quad intersection point on mouse position update (ImGui_ImplOvr_UpdateMousePos()).
+// Set to the nearest GUI quad intersection point on mouse position update (ImGui_ImplOvr_UpdateMousePos()).
 // Used for drawing controller pointer line.
 static glm::vec3 g_LineEnd;
 
-// Set to true when the controller pointer is intersecting with the GUI quad. Used to enable/disable
+// Set to true when the controller pointer is intersecting with any GUI quad. Used to enable/disable
 // controller pointer line rendering.
 static bool g_MouseOverUI = false;
 
+// Hit tests the controller pointer against the GUI quads of every panel, indexed like g_Contexts. Caches each
+// panel's world-to-local transform until its model matrix or canvas size changes.
+static ImGui_ImplOvr_HitTester g_HitTester;
+
 // RGB color used to set controller pointer line color as shader uniform.
 // User-configurable via ImGui_ImplOvr_SetControllerLineColor(glm::vec3 color).
 static glm::vec3 g_LineColor = { 1, 0, 0 };
@@ -58,13 +169,13 @@ static glm::vec3 g_LineColor = { 1, 0, 0 };
 static const std::string g_GlslVersionString = "#version 330 core\n";
 
 // ImGui shader uniform locations
-static int g_AttribLocationTex = 0, g_AttribLocationProjMtx = 0;
+static int g_AttribLocationTex = 0, g_AttribLocationProjMtx = 0, g_AttribLocationIsSdf = 0;
 
 // ImGui vertex attribute locations
 static int g_AttribLocationPosition = 0, g_AttribLocationUV = 0, g_AttribLocationColor = 0;
 
 // GUI render quad uniform locations
-static int g_QuadAttribLocationTex = 0, g_QuadAttribLocationProjMtx = 0, g_QuadAttribLocationModelViewMtx = 0;
+static int g_QuadAttribLocationTex = 0, g_QuadAttribLocationProjMtx = 0, g_QuadAttribLocationViewMtx = 0;
 
 // Controller pointer line uniform locations
 static int g_LineAttribLocationProjMtx = 0, g_LineAttribLocationViewMtx = 0, g_LineAttribLocationLineColor = 0;
@@ -72,14 +183,232 @@ static int g_LineAttribLocationProjMtx = 0, g_LineAttribLocationViewMtx = 0, g_L
 // ImGui GUI geometry VBO and EBO handles
 static unsigned int g_VboHandle = 0, g_ElementsHandle = 0;
 
-// The size in pixels of the virtual GUI canvas, initialized with an arbitrary default
-// value of 800x600, but is user-configurable via ImGui_ImplOvr_SetVirtualCanvasSize(glm::ivec2 size).
-static glm::ivec2 g_VirtualCanvasSize = { 1600, 600 };
+// A persistently mapped buffer split into IMGUI_OVR_UPLOAD_RING_SEGMENTS segments, one per frame in flight.
+// Each segment holds all of a frame's vertices followed by all of its indices.
+struct ImGui_ImplOvr_UploadRing
+{
+	GLuint Handle;
+	unsigned char* Mapped;
+	size_t SegmentSize;
+	int Segment;
+	GLsync Fences[IMGUI_OVR_UPLOAD_RING_SEGMENTS];
+};
+
+// The ring buffer used for ImGui geometry when the upload mode allows it. Created lazily on first use.
+static ImGui_ImplOvr_UploadRing g_UploadRing = {};
+
+// Which method is used for uploading ImGui geometry. User-configurable via ImGui_ImplOvr_SetUploadMode(ImGuiVrUploadMode mode).
+static ImGuiVrUploadMode g_UploadMode = ImGuiVrUploadMode_Auto;
+
+// Whether all draw lists are packed into one upload and drawn with glDrawElementsBaseVertex. Defaults to true,
+// user-configurable via ImGui_ImplOvr_SetMergeDrawLists(bool merge).
+static bool g_MergeDrawLists = true;
+
+// CPU staging buffers for merging all draw lists into one upload when the upload ring buffer isn't in use
+static ImVector<unsigned char> g_MergedVtxBuffer, g_MergedIdxBuffer;
+
+// If true, the canvas is only re-rasterized when the draw data differs from the last rendered frame. Defaults to true,
+// user-configurable via ImGui_ImplOvr_SetCanvasCaching(bool enable).
+static bool g_CanvasCaching = true;
+
+// If true, only the regions of the canvas covered by draw commands that changed since the last frame are
+// cleared and redrawn. Defaults to true, user-configurable via ImGui_ImplOvr_SetDamageTracking(bool enable).
+static bool g_DamageTracking = true;
+
+// If true, each panel's canvas is rasterized at about the resolution its quad covers in the eye buffers rather than at
+// its virtual canvas size, but no lower than g_MinRasterScale of it. Defaults to true, user-configurable via
+// ImGui_ImplOvr_SetAdaptiveCanvasResolution(bool enable, float minScale).
+static bool g_AdaptiveCanvasResolution = true;
+static float g_MinRasterScale = 0.25f;
+
+// Eye buffer pixels per unit of tangent at the HMD's recommended resolution, what raster scales are estimated
+// from. Set in ImGui_ImplOvr_Init().
+static glm::vec2 g_EyePixelsPerTangent = { 0, 0 };
+
+// The eye buffers' current resolution relative to the recommended one, when the application scales them with
+// its GPU load. User-configurable via ImGui_ImplOvr_SetEyeResolutionScale(float scale).
+static float g_EyeResolutionScale = 1.f;
+
+// FBOs reading one mip level of the canvas atlas and drawing the next, see ImGui_ImplOvr_GenerateCanvasMips()
+static GLuint g_CanvasMipFBOs[2] = { 0, 0 };
+
+// The maximum number of separate dirty rectangles redrawn per frame, more are merged together
+#define IMGUI_OVR_MAX_DAMAGE_RECTS 8
+
+// A fingerprint of a single draw command: a hash of its geometry, texture, clip rect and draw list position,
+// and the canvas-space bounds (x1, y1, x2, y2) it covers. Commands sampling a texture other than the font atlas
+// are always damaged, the hash covers which texture they draw but not what's in it.
+struct ImGui_ImplOvr_CmdFingerprint
+{
+	unsigned long long Hash;
+	ImVec4 Bounds;
+	bool AlwaysDamaged;
+};
+
+// Scratch space for the fingerprints of the current frame's commands
+static ImVector<ImGui_ImplOvr_CmdFingerprint> g_CmdFingerprints;
+
+// Scratch space for rebasing a command's indices before hashing them
+static ImVector<ImDrawIdx> g_RebasedIndices;
+
+// The regions of the canvas to redraw this frame, (x1, y1, x2, y2) in canvas pixels
+static ImVector<ImVec4> g_DamageRects;
+
+// A rectangle of the canvas atlas in texels, with a bottom left origin like GL
+struct ImGui_ImplOvr_AtlasRect
+{
+	int Layer = -1;	// -1 if not allocated
+	int X = 0, Y = 0, W = 0, H = 0;
+};
+
+// A row of an atlas layer that canvases of similar height are packed into from left to right
+struct ImGui_ImplOvr_AtlasShelf
+{
+	int Layer, Y, Height;
+	int Used;			// width taken from the left edge, including holes left by freed rectangles
+	int Allocations;	// rectangles still allocated on the shelf
+};
+
+// The texture array every panel's canvas is packed into with a shelf allocator, so all panel quads can be drawn by
+// one instanced draw with a single texture bound. Freed rectangles leave holes until the atlas is repacked, which
+// happens when an allocation doesn't fit or the canvases left would fit in fewer layers. Each canvas generates its
+// own mips, see ImGui_ImplOvr_GenerateCanvasMips().
+struct ImGui_ImplOvr_CanvasAtlas
+{
+	GLuint Texture = 0;
+	int Size = 0;		// width and height of each layer
+	int Layers = 0;		// layers allocated in Texture
+	int Levels = 0;		// mip levels allocated in Texture
+	ImVector<ImGui_ImplOvr_AtlasShelf> Shelves;
+	unsigned long long Defragmentations = 0;
+};
+static ImGui_ImplOvr_CanvasAtlas g_CanvasAtlas;
+
+// Everything belonging to a single GUI panel: its ImGui context, virtual canvas and where the pointer hits it.
+// Shaders, buffers, VAOs and the font atlas are shared by all panels, so a panel only costs its canvas.
+struct ImGui_ImplOvr_Context
+{
+	// The panel's ImGui context. Panels created with ImGui_ImplOvr_CreateContext() share the font atlas of the first.
+	ImGuiContext* ImGuiCtx = nullptr;
+
+	// The model matrix of the panel's quad, set by ImGui_ImplOvr_UpdatePointer() and ImGui_ImplOvr_SetContextModelMatrix()
+	glm::mat4 ModelMatrix = glm::mat4(1);
+
+	// The size in pixels of the virtual GUI canvas, initialized with an arbitrary default
+	// value of 1600x600, but is user-configurable via ImGui_ImplOvr_SetVirtualCanvasSize(glm::ivec2 size).
+	glm::ivec2 VirtualCanvasSize = { 1600, 600 };
+
+	// The amount of pixels per worldspace unit. This will affect how big the virtual canvas is rendered.
+	// The panel's quad spans [-1, 1] scaled by VirtualCanvasSize / PixelsPerUnit, so it's twice that across: a PPU
+	// value of 1000 will make a 1500x1000 size virtual canvas be 3.0x2.0 worldspace units.
+	// Default value is 1000 but is user-configurable via ImGui_ImplOvr_SetPixelsPerUnit(float ppu).
+	float PixelsPerUnit = 1000;
+
+	// The panel's canvas in the canvas atlas, and the FBO rendering to its atlas layer
+	ImGui_ImplOvr_AtlasRect CanvasRect;
+	GLuint GuiFBO = 0;
+
+	// The fraction of VirtualCanvasSize the canvas is rasterized at, and the GUI ticks the panel has needed a lower
+	// one for, see ImGui_ImplOvr_UpdateRasterScale(). ImGui's coordinates stay those of the virtual canvas.
+	float RasterScale = 1.f;
+	int RasterShrinkTicks = 0;
+
+	// The size in pixels the canvas was last rasterized at, in the bottom left of CanvasRect
+	glm::ivec2 RasterSize = { 0, 0 };
+
+	// Hash of the draw data last rendered to the virtual canvas, and whether CanvasRect currently holds its result.
+	// User textures in it may have changed since, so draw data sampling them is redrawn regardless.
+	unsigned long long CanvasHash = 0;
+	bool CanvasValid = false;
+
+	// Set once CanvasRect has been drawn to at all since it was created, whether or not the result can be reused
+	bool CanvasDrawn = false;
 
-// The amount of pixels per worldspace unit. This will affect how big the virtual canvas is rendered.
-// For example: a PPU value of 1000 will make a 1500x1000 size virtual canvas be 1.5x1.0 worldspace units.
-// Default value is 1000 but is user-configurable via ImGui_ImplOvr_SetPixelsPerUnit(float ppu).
-static float g_PixelsPerUnit = 1000;
+	// Fingerprints of the commands last drawn on the canvas, sorted by hash
+	ImVector<ImGui_ImplOvr_CmdFingerprint> PrevCmdFingerprints;
+
+	// Upload statistics of the panel's last ImGui_ImplOvr_RenderDrawData(), and how often its canvas could be reused.
+	// Each panel keeps its own, as every panel renders its draw data once per GUI tick.
+	ImGui_ImplOvr_UploadStats UploadStats = {};
+	ImGui_ImplOvr_CanvasStats CanvasStats = {};
+
+	// Swap chain the canvas is copied into when it's submitted to the compositor as a quad layer, created lazily
+	// by ImGui_ImplOvr_GetCanvasLayer(). LayerSize and LayerLevels are the size and mip levels it was created with.
+	ovrTextureSwapChain LayerSwapChain = nullptr;
+	glm::ivec2 LayerSize = { 0, 0 };
+	int LayerLevels = 0;
+
+	// Set when the canvas has been redrawn since it was last copied into LayerSwapChain
+	bool LayerStale = true;
+
+	// The quad layer returned by ImGui_ImplOvr_GetCanvasLayer()
+	ovrLayerQuad CanvasLayer = {};
+
+	// Set when the pointer hits this panel's quad, and the canvas position it last hit
+	bool MouseOverUI = false;
+	glm::vec2 MousePosLastFrame = { 0, 0 };
+
+	// Time of the panel's last ImGui_ImplOvr_NewFrame(), for its ImGui delta time
+	std::chrono::steady_clock::time_point LastFrameTime;
+};
+
+// The panel created by ImGui_ImplOvr_Init(), using the ImGui context current at the time
+static ImGui_ImplOvr_Context g_DefaultContext;
+
+// The panel functions without a context parameter act on, see ImGui_ImplOvr_SetCurrentContext()
+static ImGui_ImplOvr_Context* g_Ctx = &g_DefaultContext;
+
+// Every panel, the default one first
+static ImVector<ImGui_ImplOvr_Context*> g_Contexts;
+
+// The panel Touch buttons are routed to: the last one the pointer hit, kept while the trigger is held so drags
+// can leave the panel
+static ImGui_ImplOvr_Context* g_InputContext = &g_DefaultContext;
+
+// Bits identifying each piece of GL state tracked in ImGui_ImplOvr_GLState
+enum ImGuiVrStateBit
+{
+	ImGuiVrStateBit_ActiveTexture	= 1 << 0,
+	ImGuiVrStateBit_Program			= 1 << 1,
+	ImGuiVrStateBit_Texture			= 1 << 2,	// GL_TEXTURE_2D binding of texture unit 0
+	ImGuiVrStateBit_Sampler			= 1 << 3,	// sampler binding of texture unit 0
+	ImGuiVrStateBit_ArrayBuffer		= 1 << 4,
+	ImGuiVrStateBit_VertexArray		= 1 << 5,
+	ImGuiVrStateBit_Framebuffer		= 1 << 6,
+	ImGuiVrStateBit_PolygonMode		= 1 << 7,
+	ImGuiVrStateBit_Viewport		= 1 << 8,
+	ImGuiVrStateBit_ScissorBox		= 1 << 9,
+	ImGuiVrStateBit_BlendEquation	= 1 << 10,
+	ImGuiVrStateBit_BlendFunc		= 1 << 11,
+	ImGuiVrStateBit_Blend			= 1 << 12,
+	ImGuiVrStateBit_CullFace		= 1 << 13,
+	ImGuiVrStateBit_DepthTest		= 1 << 14,
+	ImGuiVrStateBit_ScissorTest		= 1 << 15
+};
+
+// A copy of the GL state the renderer touches. Used both as the shadow of the current GL state (g_GLState),
+// and to back up the host's GL state so that it can be restored.
+struct ImGui_ImplOvr_GLState
+{
+	unsigned int Known;	// ImGuiVrStateBit flags of the fields below holding the actual GL state
+	GLenum ActiveTexture;
+	GLuint Program, Texture, Sampler, ArrayBuffer, VertexArray, Framebuffer;
+	GLenum PolygonMode;
+	GLint Viewport[4], ScissorBox[4];
+	GLenum BlendEquationRgb, BlendEquationAlpha;
+	GLenum BlendSrcRgb, BlendDstRgb, BlendSrcAlpha, BlendDstAlpha;
+	bool Blend, CullFace, DepthTest, ScissorTest;
+};
+
+// Shadow of the current GL state, state changes matching it are skipped.
+static ImGui_ImplOvr_GLState g_GLState = {};
+
+// If true, the host doesn't need its GL state preserved, so the renderer doesn't back up or restore it and the
+// shadow state is kept between calls. User-configurable via ImGui_ImplOvr_SetEngineOwnsGLState(bool owns).
+static bool g_EngineOwnsGLState = false;
+
+// Counts of GL state changes issued, skipped and queried, see ImGui_ImplOvr_GetStateStats()
+static ImGui_ImplOvr_StateStats g_StateStats = {};
 
 // An array containing the data to fill the GUI render quad vertex buffer with.
 // Format is GL_FLOAT, each vertex has Vec3 position and Vec2 UV coords, there
@@ -111,8 +440,8 @@ static ovrHapticsBuffer g_HapticPulseBuffer;
 // Required for Oculus API call to get tracking state.
 static long long* g_VRFrameIndex;
 
-// The current ovrSession of the Oculus API. Initialised in ImGui_ImplOvr_Init().
-static ovrSession g_VRSession;
+// The HMD backend the session calls go through, the Oculus runtime or a simulated HMD. Initialised in ImGui_ImplOvr_Init().
+static HmdBackend* g_Hmd;
 
 // the hand that is currently being used to control the GUI
 static ovrHandType g_OVRInputHand;
@@ -124,6 +453,144 @@ static ImGuiVrInputMode g_InputMode;
 // will be set to true when both controllers are put down and are not being held
 static bool g_InputHandNeedsReset = true;
 
+// How often the GUI is rebuilt and rasterized. Defaults to every HMD frame, user-configurable via
+// ImGui_ImplOvr_SetGuiUpdateMode(ImGuiVrGuiUpdateMode mode, float rate).
+static ImGuiVrGuiUpdateMode g_GuiUpdateMode = ImGuiVrGuiUpdateMode_EveryFrame;
+
+// The GUI tick rate in Hz used by ImGuiVrGuiUpdateMode_FixedRate
+static float g_GuiUpdateRate = 45.f;
+
+// The number of extra GUI ticks run after input stops in ImGuiVrGuiUpdateMode_OnInput, so that hover
+// highlights, releases and other reactions to the last input still make it onto the canvas.
+#define IMGUI_OVR_INPUT_SETTLE_TICKS 3
+
+// Time of the next GUI tick in ImGuiVrGuiUpdateMode_FixedRate
+static std::chrono::steady_clock::time_point g_NextGuiTick;
+
+// Hash of the input state at the last GUI tick, and the number of settle ticks left, for ImGuiVrGuiUpdateMode_OnInput
+static unsigned long long g_LastGuiInputHash = 0;
+static int g_GuiSettleTicks = 0;
+
+// The device snapshot shared by the application via ImGui_ImplOvr_SetDeviceSnapshot(), nullptr if it doesn't
+// share one. Tracking and Touch input state are read from it, so they match what the application rendered with.
+static const ImGui_ImplOvr_DeviceSnapshot* g_DeviceSnapshot = nullptr;
+
+// Device state sampled by the renderer itself, once per HMD frame, when the application doesn't share a snapshot
+static ImGui_ImplOvr_DeviceSnapshot g_OwnDeviceSnapshot = { -1 };
+
+// Set if the trigger was pressed on any HMD frame since the last GUI tick, so short clicks between ticks aren't lost
+static bool g_MouseDownLatched = false;
+
+// Samples Touch input on its own thread, see ImGui_ImplOvr_StartInputPolling(). While it runs, buttons are read
+// from its event queue rather than from the per-frame device snapshot.
+static ImGui_ImplOvr_InputPoller g_InputPoller;
+
+// The input source the polling thread samples, the HMD backend unless set via ImGui_ImplOvr_SetInputSource()
+static ImGui_ImplOvr_InputSourceFunc g_InputSourceFunc = nullptr;
+static void* g_InputSourceUserData = nullptr;
+
+// Buttons held according to the events drained from g_InputPoller so far, see ImGuiVrButton
+static unsigned int g_PolledButtons = 0;
+
+// Records every device snapshot, GUI tick and batch of polled input events, see ImGui_ImplOvr_StartRecording()
+static ImGui_ImplOvr_DeviceRecorder g_DeviceRecorder;
+
+// Replaces the Oculus SDK and the input polling thread with a recording, see ImGui_ImplOvr_StartReplay()
+static ImGui_ImplOvr_DeviceReplay g_DeviceReplay;
+
+// The input events applied on the current GUI tick, kept to record or replay them
+static std::vector<ImGui_ImplOvr_InputEvent> g_TickInputEvents;
+
+// Times the renderer's and the app's GPU phases, see ImGui_ImplOvr_BeginGpuPhase(). Its queries are created with
+// the device objects.
+static ImGui_ImplOvr_GpuTimer g_GpuTimer;
+
+// Whether GPU phases are timed and wrapped in debug groups. Defaults to true, user-configurable via
+// ImGui_ImplOvr_SetGpuTiming(bool enable).
+static bool g_GpuTiming = true;
+
+// Writes the profile stream and the flight recorder's traces off the frame loop's thread
+static ImGui_ImplOvr_ProfileWriter g_ProfileWriter;
+
+// Where CPU profiler events are streamed to as a Chrome trace, see ImGui_ImplOvr_StartProfileStream(), and which
+// events were already written. Only g_ProfileWriter's tasks touch them while the stream is open.
+static FILE* g_ProfileStream = nullptr;
+static bool g_ProfileStreamFirst = true;
+static ImGui_ImplOvr_ProfileCursor g_ProfileStreamCursor;
+
+// Whether a profile stream is open, as seen from the frame loop
+static bool g_ProfileStreaming = false;
+
+// Frames that take longer than g_FrameBudgetMs make the flight recorder write the last g_FlightRecorderSeconds of
+// events to a trace named after g_FlightRecorderPrefix, see ImGui_ImplOvr_SetFlightRecorder()
+static std::string g_FlightRecorderPrefix;
+static float g_FrameBudgetMs = 0.f;
+static float g_FlightRecorderSeconds = 5.f;
+static unsigned long long g_LastFlightRecording = 0;
+
+// When the current frame started on the profiler's clock, 0 before the first frame
+static unsigned long long g_ProfileFrameStart = 0;
+
+static ImGui_ImplOvr_ProfilerStats g_ProfilerStats = {};
+
+// The counts of g_ProfilerStats kept by g_ProfileWriter's tasks
+static std::atomic<unsigned long long> g_FlightRecordingsWritten = { 0 };
+static std::atomic<unsigned long long> g_ProfileEventsLost = { 0 };
+
+// The compositor's stats of recently shown frames, polled once per HMD frame by ImGui_ImplOvr_PollPerfStats()
+static ImGui_ImplOvr_PerfStatsHistory g_PerfStats;
+
+// The HMD frame index ImGui_ImplOvr_UpdatePointer() last updated the pointer in, so ImGui_ImplOvr_NewFrame()
+// doesn't update it again
+static long long g_PointerFrameIndex = -1;
+
+/**
+ * @brief Sample the device state for the current HMD frame: the predicted display time, tracking state and
+ * Touch input state. While replaying they're read from the recording instead, and while recording they're
+ * appended to it. Call this once per HMD frame and share the result with ImGui_ImplOvr_SetDeviceSnapshot().
+ * 
+ * @param out_snapshot Set to the device state
+ */
+void ImGui_ImplOvr_CaptureDeviceSnapshot(ImGui_ImplOvr_DeviceSnapshot* out_snapshot)
+{
+	IMGUI_OVR_PROFILE_SCOPE("ImGui_ImplOvr_CaptureDeviceSnapshot");
+	if (g_DeviceReplay.IsOpen() && !g_DeviceReplay.ReadFrame(out_snapshot))
+	{
+		// the recording is over, carry on with the live device state
+		g_DeviceReplay.Close();
+	}
+
+	if (!g_DeviceReplay.IsOpen())
+	{
+		out_snapshot->DisplayTime = g_Hmd->get_predicted_display_time(*g_VRFrameIndex);
+		out_snapshot->Tracking = g_Hmd->get_tracking_state(out_snapshot->DisplayTime);
+		g_Hmd->get_input_state(&out_snapshot->Input);
+	}
+	out_snapshot->FrameIndex = *g_VRFrameIndex;
+
+	if (g_DeviceRecorder.IsOpen())
+	{
+		g_DeviceRecorder.WriteSnapshot(*out_snapshot);
+	}
+}
+
+/**
+ * @brief Get the device state of the current HMD frame. If the application doesn't share a snapshot, the
+ * Oculus API is queried once per frame index and every later call in the frame reuses the result.
+ * 
+ * @return The device snapshot of the current HMD frame
+ */
+static const ImGui_ImplOvr_DeviceSnapshot& ImGui_ImplOvr_GetDeviceSnapshot()
+{
+	if (g_DeviceSnapshot) return *g_DeviceSnapshot;
+
+	if (g_OwnDeviceSnapshot.FrameIndex != *g_VRFrameIndex)
+	{
+		ImGui_ImplOvr_CaptureDeviceSnapshot(&g_OwnDeviceSnapshot);
+	}
+	return g_OwnDeviceSnapshot;
+}
+
 /**
  * @brief Maps an analog input with a lower and higher value to [0, 1]
  * 
@@ -141,127 +608,184 @@ static float ImGui_ImplOvr_MapAnalogInput(float v, float VL, float VH)
 }
 
 /**
- * @brief Gets input state from Oculus API and uses it to update ImGui NavInputs for
- * navigation.
+ * @brief Update ImGui NavInputs and the mouse button from the input hand's Touch buttons, read from the input
+ * polling thread's events while it runs and from the device snapshot otherwise.
  */
 static void ImGui_ImplOvr_UpdateOculusTouchButtons()
 {
-	ovrInputState inputState;
-	ovr_GetInputState(g_VRSession, ovrControllerType_Touch, &inputState);
-
 	ImGuiIO& io = ImGui::GetIO();
+	io.BackendFlags |= ImGuiBackendFlags_HasGamepad;
+
+	// only the panel last pointed at gets the buttons
+	if (g_Ctx != g_InputContext)
+	{
+		memset(io.NavInputs, 0, sizeof(io.NavInputs));
+		io.MouseDown[0] = false;
+		return;
+	}
+
+	unsigned int buttons;
+	bool polled = false;
+	g_TickInputEvents.clear();
+	if (g_DeviceReplay.IsOpen())
+	{
+		// the events were already ordered into ticks when they were recorded
+		polled = g_DeviceReplay.ReadInputEvents(&g_TickInputEvents);
+		for (size_t i = 0; i < g_TickInputEvents.size(); i++)
+		{
+			g_PolledButtons = g_TickInputEvents[i].Down;
+		}
+	}
+	else if (g_InputPoller.IsRunning() || !g_InputPoller.Queue.Empty())
+	{
+		// Apply queued events in order, up to one that would undo a change already applied this GUI frame. It
+		// waits for the next frame, so ImGui sees a press and release inside one frame as a click.
+		unsigned int pressed = 0, released = 0;
+		ImGui_ImplOvr_InputEvent event;
+		while (g_InputPoller.Queue.Peek(&event))
+		{
+			if ((event.Changed & ~event.Down & pressed) || (event.Changed & event.Down & released)) break;
+			pressed |= event.Changed & event.Down;
+			released |= event.Changed & ~event.Down;
+			g_PolledButtons = event.Down;
+			g_InputPoller.Queue.Pop();
+			g_TickInputEvents.push_back(event);
+		}
+		polled = true;
+
+		if (g_DeviceRecorder.IsOpen())
+		{
+			g_DeviceRecorder.WriteInputEvents(g_TickInputEvents.data(), (int)g_TickInputEvents.size());
+		}
+	}
+
+	if (polled)
+	{
+		buttons = g_PolledButtons;
+	}
+	else
+	{
+		buttons = ImGui_ImplOvr_GetButtons(ImGui_ImplOvr_GetDeviceSnapshot().Input, g_ThumbstickDeadzone);
+		if (g_MouseDownLatched)
+		{
+			buttons |= ImGuiVrButton_IndexTrigger << (g_OVRInputHand * IMGUI_OVR_INPUT_HAND_SHIFT);
+		}
+	}
+	g_MouseDownLatched = false;
 
-	io.NavInputs[ImGuiNavInput_DpadDown] = inputState.ThumbstickNoDeadzone[g_OVRInputHand].y < -g_ThumbstickDeadzone;
-	io.NavInputs[ImGuiNavInput_DpadUp] = inputState.ThumbstickNoDeadzone[g_OVRInputHand].y > g_ThumbstickDeadzone;
-	io.NavInputs[ImGuiNavInput_DpadLeft] = inputState.ThumbstickNoDeadzone[g_OVRInputHand].x < -g_ThumbstickDeadzone;
-	io.NavInputs[ImGuiNavInput_DpadRight] = inputState.ThumbstickNoDeadzone[g_OVRInputHand].x > g_ThumbstickDeadzone;
-	io.NavInputs[ImGuiNavInput_Activate] = inputState.IndexTriggerRaw[g_OVRInputHand] > 0.5f;
+	// the input hand's buttons
+	buttons = (buttons >> (g_OVRInputHand * IMGUI_OVR_INPUT_HAND_SHIFT)) & ((1u << IMGUI_OVR_INPUT_HAND_SHIFT) - 1);
 
-	io.NavInputs[ImGuiNavInput_Cancel] = inputState.HandTriggerRaw[g_OVRInputHand] > 0.5f;
-	io.NavInputs[ImGuiNavInput_Input] = g_OVRInputHand == ovrHand_Left ? inputState.Buttons & ovrButton_LThumb : inputState.Buttons & ovrButton_RThumb;
-	io.NavInputs[ImGuiNavInput_Menu] = g_OVRInputHand == ovrHand_Left ? inputState.Buttons & ovrButton_X : inputState.Buttons & ovrButton_A;
+	io.NavInputs[ImGuiNavInput_DpadDown] = buttons & ImGuiVrButton_StickDown ? 1.f : 0.f;
+	io.NavInputs[ImGuiNavInput_DpadUp] = buttons & ImGuiVrButton_StickUp ? 1.f : 0.f;
+	io.NavInputs[ImGuiNavInput_DpadLeft] = buttons & ImGuiVrButton_StickLeft ? 1.f : 0.f;
+	io.NavInputs[ImGuiNavInput_DpadRight] = buttons & ImGuiVrButton_StickRight ? 1.f : 0.f;
+	io.NavInputs[ImGuiNavInput_Activate] = buttons & ImGuiVrButton_IndexTrigger ? 1.f : 0.f;
+
+	io.NavInputs[ImGuiNavInput_Cancel] = buttons & ImGuiVrButton_HandTrigger ? 1.f : 0.f;
+	io.NavInputs[ImGuiNavInput_Input] = buttons & ImGuiVrButton_Thumb ? 1.f : 0.f;
+	io.NavInputs[ImGuiNavInput_Menu] = buttons & ImGuiVrButton_Lower ? 1.f : 0.f;
 
 	io.NavInputs[ImGuiNavInput_FocusPrev] = 0; // prev window (w/ PadMenu)
-	io.NavInputs[ImGuiNavInput_FocusNext] = g_OVRInputHand == ovrHand_Left ? inputState.Buttons & ovrButton_Y : inputState.Buttons & ovrButton_B;
+	io.NavInputs[ImGuiNavInput_FocusNext] = buttons & ImGuiVrButton_Upper ? 1.f : 0.f;
 	io.NavInputs[ImGuiNavInput_TweakSlow] = 0; // slower tweaks
 	io.NavInputs[ImGuiNavInput_TweakFast] = 0; // faster tweaks
 
-	io.MouseDown[0] = inputState.IndexTriggerRaw[g_OVRInputHand] > 0.5f;
+	io.MouseDown[0] = (buttons & ImGuiVrButton_IndexTrigger) != 0;
+}
 
-	io.BackendFlags |= ImGuiBackendFlags_HasGamepad;
+/**
+ * @brief Get the matrix that places a panel's quad, which spans [-1, 1], in the world: its model matrix scaled so
+ * the quad is 2 * VirtualCanvasSize / PixelsPerUnit units across. The drawn quad, the hit test and the compositor
+ * layer all use it, so they agree on the panel's size.
+ * 
+ * @param ctx The panel
+ * @param model The panel's model matrix
+ * @return The model matrix of the unit quad
+ */
+static glm::mat4 ImGui_ImplOvr_PanelQuadMatrix(const ImGui_ImplOvr_Context* ctx, const glm::mat4& model)
+{
+	return model * glm::scale(glm::mat4(1), glm::vec3(glm::vec2(ctx->VirtualCanvasSize) / ctx->PixelsPerUnit, 1.0f));
 }
 
 /**
  * @brief Update the ImGui mouse position using Touch controller as pointer
  * 
- * Uses Oculus controller as a pointer and computes ray intersection with
- * GUI quad virtual canvas, then calculates virtual canvas mouse position from
- * this intersection point and submits it to ImGui.
- * 
- * @param guiModelMatrix The model matrix of the GUI quad
+ * Uses Oculus controller as a pointer and computes ray intersections with the
+ * GUI quads of every panel in one pass. The nearest panel hit gets the virtual
+ * canvas mouse position from its intersection point, and becomes the panel
+ * Touch buttons are routed to.
  */
-static void ImGui_ImplOvr_UpdateMousePos(glm::mat4 guiModelMatrix)
+static void ImGui_ImplOvr_UpdateMousePos()
 {
 	g_MouseOverUI = false;
 
-	// create vertices of GUI virtual canvas quad in local space
-	glm::vec3 p0(-1.f, -1.f, 0.f);
-	glm::vec3 p1(-1.f, 1.f, 0.f);
-	glm::vec3 p2(1.f, 1.f, 0.f);
-	glm::vec3 p3(1.f, -1.f, 0.f);
-
-	// apply scale to quad to make pixel size square, as well as model matrix to
-	// transform it into world space
-	const glm::mat4 modelMat = guiModelMatrix * glm::scale(glm::mat4(1),
-		glm::vec3(g_VirtualCanvasSize.x / g_PixelsPerUnit,
-			g_VirtualCanvasSize.y / g_PixelsPerUnit, 1.0f));
-	p0 = modelMat * glm::vec4(p0, 1);
-	p1 = modelMat * glm::vec4(p1, 1);
-	p2 = modelMat * glm::vec4(p2, 1);
-	p3 = modelMat * glm::vec4(p3, 1);
-
-	// get tracking data from Oculus API and convert to GLM values
-	const double displayMidpointSeconds = ovr_GetPredictedDisplayTime(g_VRSession, *g_VRFrameIndex);
-	const ovrTrackingState trackState = ovr_GetTrackingState(g_VRSession, displayMidpointSeconds, ovrTrue);
-	const ovrPosef handPose = trackState.HandPoses[g_OVRInputHand].ThePose;
+	// get tracking data predicted for this frame and convert to GLM values
+	const ImGui_ImplOvr_DeviceSnapshot& snapshot = ImGui_ImplOvr_GetDeviceSnapshot();
+	const ovrPosef handPose = snapshot.Tracking.HandPoses[g_OVRInputHand].ThePose;
 	const glm::vec3 handPosition = glm::vec3(handPose.Position.x, handPose.Position.y, handPose.Position.z);
 	const glm::quat handOrientation = glm::quat(handPose.Orientation.w, handPose.Orientation.x, handPose.Orientation.y, handPose.Orientation.z);
 	const glm::vec3 handForward = handOrientation * glm::vec3(0, 0, -1);
 
-	// find the inverse of the model matrix to get world-to-local matrix
-	const glm::mat4 toLocal = glm::inverse(modelMat);
 	const glm::vec3 start = glm::vec4(handPosition, 1);
 
 	g_LineStart = handPosition;
 
-	// now raycast from Touch controller in forward direction, looking for an
-	// intersection with the GUI virtual canvas quad
-	glm::vec2 b;
-	bool intersect;
-	float dist;
-	static glm::vec2 mousePosLastFrame;
-	ImGuiIO& io = ImGui::GetIO();
-	do
+	// apply scale to each quad to make pixel size square, as well as model matrix to
+	// transform it into world space. The hit tester only recomputes panels that moved.
+	g_HitTester.SetPanelCount(g_Contexts.Size);
+	for (int i = 0; i < g_Contexts.Size; i++)
 	{
-		// check for intersection with first triangle of quad
-		intersect = glm::intersectRayTriangle(start, handForward, p1, p0, p2, b, dist);
-		if (intersect) break;
-
-		// check for intersection with other triangle of quad
-		intersect = glm::intersectRayTriangle(start, handForward, p0, p3, p2, b, dist);
-		if (intersect) break;
+		ImGui_ImplOvr_Context* ctx = g_Contexts[i];
+		ctx->MouseOverUI = false;
+		g_HitTester.SetPanel(i, ImGui_ImplOvr_PanelQuadMatrix(ctx, ctx->ModelMatrix));
 	}
-	while (false);
-	
-	if (intersect)
-	{
-		// we found an intersection, the 'mouse' is over the UI
-		g_MouseOverUI = true;
 
-		// compute intersection point in worldspace
-		const glm::vec3 pt = start + handForward * dist;
-		g_LineEnd = pt;
-
-		// convert intersection point to local space
-		const glm::vec3 localPt = toLocal * glm::vec4(pt, 1);
+	// now raycast from Touch controller in forward direction, looking for the
+	// nearest intersection with any GUI virtual canvas quad
+	ImGui_ImplOvr_Context* hit = nullptr;
+	const ImGui_ImplOvr_HitResult result = g_HitTester.CastRay(start, handForward);
+	if (result.Panel >= 0)
+	{
+		hit = g_Contexts[result.Panel];
+		g_LineEnd = start + handForward * result.Distance;
 
 		// linearly interpolate between virtual canvas sizes based on UI quad local intersection position
 		// to get mouse position on canvas
-		const glm::vec2 mousePos = { 
-			(g_VirtualCanvasSize.x / 2.f) * localPt.x + (g_VirtualCanvasSize.x / 2.f),  // xPos = (width / 2) * localX + (width / 2)
-			(g_VirtualCanvasSize.y / 2.f) - (g_VirtualCanvasSize.y / 2.f) * localPt.y   // yPos = (-height / 2) * localY + (height / 2)
+		hit->MousePosLastFrame = {
+			(hit->VirtualCanvasSize.x / 2.f) * result.Local.x + (hit->VirtualCanvasSize.x / 2.f),  // xPos = (width / 2) * localX + (width / 2)
+			(hit->VirtualCanvasSize.y / 2.f) - (hit->VirtualCanvasSize.y / 2.f) * result.Local.y   // yPos = (-height / 2) * localY + (height / 2)
 		};
+	}
 
-		io.MousePos = ImVec2(mousePos.x, mousePos.y);
+	if (hit)
+	{
+		// we found an intersection, the 'mouse' is over the UI
+		g_MouseOverUI = true;
+		hit->MouseOverUI = true;
 
-		// cache mouse position in case intersection stops next frame
-		mousePosLastFrame = mousePos;
+		// keep the panel a drag started on until the trigger is released
+		if (!(snapshot.Input.IndexTriggerRaw[g_OVRInputHand] > 0.5f))
+		{
+			g_InputContext = hit;
+		}
 	}
-	else
+
+	for (int i = 0; i < g_Contexts.Size; i++)
 	{
-		// if no intersection, set the mouse position to the last known position
-		// otherwise mouse may 'jump' to an unexpected position
-		io.MousePos = ImVec2(mousePosLastFrame.x, mousePosLastFrame.y);
+		ImGui_ImplOvr_Context* ctx = g_Contexts[i];
+		ImGuiIO& io = ctx->ImGuiCtx->IO;
+		if (ctx == hit || ctx == g_InputContext)
+		{
+			// if no intersection, the input panel keeps the last known position,
+			// otherwise mouse may 'jump' to an unexpected position
+			io.MousePos = ImVec2(ctx->MousePosLastFrame.x, ctx->MousePosLastFrame.y);
+		}
+		else
+		{
+			// nothing is hovered on panels the pointer has left
+			io.MousePos = ImVec2(-FLT_MAX, -FLT_MAX);
+		}
 	}
 }
 
@@ -280,14 +804,14 @@ static void PulseIfItemHovered()
 	if (itemHoveredLastFrame != itemHoveredThisFrame)
 	{
 		// no hover last frame, but new hover this frame -- pulse!
-		ovr_SubmitControllerVibration(g_VRSession, g_OVRInputHand == ovrHand_Left ? ovrControllerType_LTouch : ovrControllerType_RTouch, &g_HapticPulseBuffer);
+		g_Hmd->submit_controller_vibration(g_OVRInputHand == ovrHand_Left ? ovrControllerType_LTouch : ovrControllerType_RTouch, &g_HapticPulseBuffer);
 	}
 	else if (itemHoveredLastFrame && itemHoveredThisFrame)
 	{
 		if (lastHoveredID != ImGui::GetHoveredID())
 		{
 			// we've hovered over a new item without stopping -- pulse!
-			ovr_SubmitControllerVibration(g_VRSession, g_OVRInputHand == ovrHand_Left ? ovrControllerType_LTouch : ovrControllerType_RTouch, &g_HapticPulseBuffer);
+			g_Hmd->submit_controller_vibration(g_OVRInputHand == ovrHand_Left ? ovrControllerType_LTouch : ovrControllerType_RTouch, &g_HapticPulseBuffer);
 		}
 	}
 	itemHoveredLastFrame = itemHoveredThisFrame;
@@ -296,8 +820,7 @@ static void PulseIfItemHovered()
 
 static void AutoDetectInputController()
 {
-	ovrInputState inputState;
-	ovr_GetInputState(g_VRSession, ovrControllerType_Touch, &inputState);
+	const ovrInputState& inputState = ImGui_ImplOvr_GetDeviceSnapshot().Input;
 
 	if (!(inputState.Touches & ovrTouch_RIndexTrigger) && !(inputState.Touches & ovrTouch_LIndexTrigger))
 	{
@@ -375,147 +898,2536 @@ static bool CheckProgram(GLuint handle, const char* desc)
 }
 
 /**
- * @brief Initialise ImGui Oculus VR renderer. Must be called before any other ImGui_ImplOvr function.
+ * @brief Binds the vertex attributes of a GUI render quad program to the locations the quad VAOs use.
+ * Call this before linking the program.
  * 
- * @param session The ovrSession object from when you initialised the Oculus API.
- * @param frameIndex A pointer to where you're storing the current VR frame index.
- * @return True if successful initialisation, false otherwise.
+ * @param program The handle of the program
  */
-bool ImGui_ImplOvr_Init(ovrSession session, long long* const frameIndex)
+static void ImGui_ImplOvr_BindQuadAttribLocations(GLuint program)
 {
-	if (!frameIndex) return false;
-	g_VRFrameIndex = frameIndex;
-	g_VRSession = session;
-
-	// create haptic pulse buffer
-	g_HapticPulseBuffer.Samples = new unsigned char[7]{ 0, 255, 0, 255, 0, 255, 0 };
-	g_HapticPulseBuffer.SamplesCount = 7;
-	g_HapticPulseBuffer.SubmitMode = ovrHapticsBufferSubmit_Enqueue;
-	
-	ImGuiIO& io = ImGui::GetIO();
-
-	// HACK: create device objects here otherwise assertion that font is already
-	// built will fail in ImGui platform binding Init (i.e. ImGui_Impl_Glfw_Init())
-	ImGui_ImplOvr_CreateDeviceObjects();
-
-	return true;
+	glBindAttribLocation(program, 0, "Position");
+	glBindAttribLocation(program, 1, "UV");
+	glBindAttribLocation(program, IMGUI_OVR_QUAD_ATTRIB_MODEL_MTX, "ModelMtx");
+	glBindAttribLocation(program, IMGUI_OVR_QUAD_ATTRIB_ATLAS_RECT, "AtlasRect");
+	glBindAttribLocation(program, IMGUI_OVR_QUAD_ATTRIB_ATLAS_LAYER, "AtlasLayer");
 }
 
 /**
- * @brief Shutdown the ImGui Oculus VR renderer. Call this when your program exits, cleans up
- * OpenGL objects and deletes allocated memory.
+ * @brief Points the ImGui vertex attributes of the bound VAO at ImDrawVert data in the bound array buffer.
+ * 
+ * @param vtx_byte_offset The offset in bytes of the first vertex in the array buffer
  */
-void ImGui_ImplOvr_Shutdown()
+static void ImGui_ImplOvr_SetupVertexAttribs(size_t vtx_byte_offset)
 {
-	ImGui_ImplOvr_DestroyDeviceObjects();
-	delete[] static_cast<unsigned char const*>(g_HapticPulseBuffer.Samples);
+	glVertexAttribPointer(g_AttribLocationPosition, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid*)(vtx_byte_offset + IM_OFFSETOF(ImDrawVert, pos)));
+	glVertexAttribPointer(g_AttribLocationUV, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid*)(vtx_byte_offset + IM_OFFSETOF(ImDrawVert, uv)));
+	glVertexAttribPointer(g_AttribLocationColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (GLvoid*)(vtx_byte_offset + IM_OFFSETOF(ImDrawVert, col)));
 }
 
 /**
- * @brief Begin a new frame with this renderer. Call this before you begin drawing
- * ImGui elements, and before ImGui::NewFrame().
+ * @brief Hashes a block of memory, 8 bytes at a time. Not cryptographic, just fast and well distributed.
  * 
- * @param guiModelMatrix The model matrix of the quad to draw the GUI on in the scene. Used for
- * intersection calculations to determine mouse position.
+ * @param data The data to hash
+ * @param size The size of the data in bytes
+ * @param seed The hash to continue from, so multiple blocks can be hashed together
+ * @return The 64-bit hash
  */
-void ImGui_ImplOvr_NewFrame(glm::mat4 guiModelMatrix)
+static unsigned long long ImGui_ImplOvr_HashBytes(const void* data, size_t size, unsigned long long seed)
 {
-	ImGuiIO& io = ImGui::GetIO();
+	const unsigned long long m = 0xc6a4a7935bd1e995ULL;
+	const unsigned char* p = (const unsigned char*)data;
+	unsigned long long h = seed ^ (size * m);
 
-	io.DisplaySize = ImVec2(g_VirtualCanvasSize.x, g_VirtualCanvasSize.y);
-	io.DisplayFramebufferScale = ImVec2(1, 1); // not used for anything
+	for (; size >= 8; size -= 8, p += 8)
+	{
+		unsigned long long k;
+		memcpy(&k, p, 8);
+		k *= m;
+		k ^= k >> 47;
+		k *= m;
+		h ^= k;
+		h *= m;
+	}
 
-	if (!g_FontTexture)
+	if (size > 0)
 	{
-		ImGui_ImplOvr_CreateDeviceObjects();
+		unsigned long long k = 0;
+		memcpy(&k, p, size);
+		h ^= k;
+		h *= m;
 	}
 
-	// update mouse and gamepad
-	ImGui_ImplOvr_UpdateMousePos(guiModelMatrix);
-	ImGui_ImplOvr_UpdateOculusTouchButtons();
+	h ^= h >> 47;
+	h *= m;
+	h ^= h >> 47;
+	return h;
 }
 
 /**
- * @brief Call this every engine tick, will update internal state and do things
- * like pulse the Touch controller if a UI element is hovered over.
+ * @brief Computes a fingerprint of everything in the draw data that affects the rasterized canvas:
+ * display rect, vertex and index streams, and each command's clip rect, texture and element count.
+ * 
+ * @param draw_data The draw data to hash
+ * @param out_cacheable Set to false if the draw data contains user callbacks, or commands sampling a texture other
+ * than the font atlas, whose output can't be hashed: a user texture's contents can change under the same id
+ * @param out_has_callbacks Set to true if the draw data contains user callbacks, which may draw anywhere
+ * @return The hash of the draw data
  */
-void ImGui_ImplOvr_Update()
+static unsigned long long ImGui_ImplOvr_HashDrawData(const ImDrawData* draw_data, bool* out_cacheable, bool* out_has_callbacks)
 {
-	PulseIfItemHovered();
+	*out_cacheable = true;
+	*out_has_callbacks = false;
 
-	if (g_InputMode == ImGuiVrInputMode_Auto)
+	const float display[4] = { draw_data->DisplayPos.x, draw_data->DisplayPos.y, draw_data->DisplaySize.x, draw_data->DisplaySize.y };
+	unsigned long long h = ImGui_ImplOvr_HashBytes(display, sizeof(display), (unsigned long long)draw_data->CmdListsCount);
+
+	for (int n = 0; n < draw_data->CmdListsCount; n++)
 	{
-		AutoDetectInputController();
-	}
-}
+		const ImDrawList* cmd_list = draw_data->CmdLists[n];
+		h = ImGui_ImplOvr_HashBytes(cmd_list->VtxBuffer.Data, (size_t)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert), h);
+		h = ImGui_ImplOvr_HashBytes(cmd_list->IdxBuffer.Data, (size_t)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx), h);
+		for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
+		{
+			const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
+			if (pcmd->UserCallback) *out_has_callbacks = true;
+			if (pcmd->UserCallback || (GLuint)(intptr_t)pcmd->TextureId != g_FontTexture) *out_cacheable = false;
 
-/**
- * @brief Set the size of the virtual GUI canvas in pixels. Call this before ImGui_ImplOvr_Init() if you
- * want canvas size changes to have any effect.
- * 
- * @param size The size in pixels of the virtual canvas.
- */
-void ImGui_ImplOvr_SetVirtualCanvasSize(glm::ivec2 size)
-{
-	g_VirtualCanvasSize = size;
+			// hash fields individually, the struct has padding and callback data we don't care about
+			const unsigned long long cmd[2] = { (unsigned long long)pcmd->ElemCount, (unsigned long long)(intptr_t)pcmd->TextureId };
+			h = ImGui_ImplOvr_HashBytes(&pcmd->ClipRect, sizeof(pcmd->ClipRect), h);
+			h = ImGui_ImplOvr_HashBytes(cmd, sizeof(cmd), h);
+		}
+	}
+	return h;
 }
 
 /**
- * @brief Set the deadzone of the Oculus Touch thumbstick.
- * 
- * @param deadzone The deadzone.
+ * @brief Compare function for sorting command fingerprints by hash.
  */
-void ImGui_ImplOvr_SetThumbstickDeadzone(float deadzone)
+static bool ImGui_ImplOvr_CmdFingerprintLess(const ImGui_ImplOvr_CmdFingerprint& a, const ImGui_ImplOvr_CmdFingerprint& b)
 {
-	g_ThumbstickDeadzone = deadzone;
+	return a.Hash < b.Hash;
 }
 
 /**
- * @brief Set the color of the line drawn from the Touch controller (indicating 'mouse' position on UI).
+ * @brief Fingerprints every draw command in the draw data. Each command is identified by the vertices it
+ * references rather than by its raw indices, so commands don't change fingerprint just because geometry
+ * before them in the same draw list grew or shrank.
  * 
- * @param color RGB vector color to set
+ * @param draw_data The draw data to fingerprint
+ * @param fb_width The width of the canvas in pixels
+ * @param fb_height The height of the canvas in pixels
+ * @param out_fingerprints Where to write the fingerprints, sorted by hash
  */
-void ImGui_ImplOvr_SetControllerLineColor(glm::vec3 color)
+static void ImGui_ImplOvr_FingerprintCommands(const ImDrawData* draw_data, int fb_width, int fb_height, ImVector<ImGui_ImplOvr_CmdFingerprint>* out_fingerprints)
 {
-	g_LineColor = color;
-}
+	out_fingerprints->resize(0);
+	const ImVec2 pos = draw_data->DisplayPos;
 
-/**
- * @brief Set the pixels-per-unit (ppu) scale of the virtual canvas. Affects the rendered size of the
- * GUI virtual canvas quad. Denotes how many pixels occupy each world-space unit.
- * 
+	// vertices are in ImGui's coordinates, the clip rects were already scaled to the canvas' raster size
+	const ImVec2 scale(fb_width / draw_data->DisplaySize.x, fb_height / draw_data->DisplaySize.y);
+	for (int n = 0; n < draw_data->CmdListsCount; n++)
+	{
+		const ImDrawList* cmd_list = draw_data->CmdLists[n];
+		const ImDrawIdx* idx_buffer = cmd_list->IdxBuffer.Data;
+		for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; idx_buffer += cmd_list->CmdBuffer[cmd_i].ElemCount, cmd_i++)
+		{
+			const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
+			if (pcmd->UserCallback || pcmd->ElemCount == 0) continue;
+
+			// find the range of vertices this command uses
+			unsigned int vtx_min = 0xFFFFFFFF, vtx_max = 0;
+			for (unsigned int e = 0; e < pcmd->ElemCount; e++)
+			{
+				vtx_min = ImMin(vtx_min, (unsigned int)idx_buffer[e]);
+				vtx_max = ImMax(vtx_max, (unsigned int)idx_buffer[e]);
+			}
+
+			g_RebasedIndices.resize((int)pcmd->ElemCount);
+			for (unsigned int e = 0; e < pcmd->ElemCount; e++)
+			{
+				g_RebasedIndices[(int)e] = (ImDrawIdx)(idx_buffer[e] - vtx_min);
+			}
+
+			// draw list position is part of the fingerprint, as it determines what's drawn on top of what
+			const unsigned long long cmd[2] = { (unsigned long long)n, (unsigned long long)(intptr_t)pcmd->TextureId };
+			unsigned long long h = ImGui_ImplOvr_HashBytes(cmd, sizeof(cmd), 0);
+			h = ImGui_ImplOvr_HashBytes(&pcmd->ClipRect, sizeof(pcmd->ClipRect), h);
+			h = ImGui_ImplOvr_HashBytes(g_RebasedIndices.Data, (size_t)g_RebasedIndices.Size * sizeof(ImDrawIdx), h);
+			h = ImGui_ImplOvr_HashBytes(cmd_list->VtxBuffer.Data + vtx_min, (size_t)(vtx_max - vtx_min + 1) * sizeof(ImDrawVert), h);
+
+			// bounds of the vertices, clipped to the command's clip rect and the canvas
+			ImVec4 bounds(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+			for (unsigned int v = vtx_min; v <= vtx_max; v++)
+			{
+				const ImVec2 p(cmd_list->VtxBuffer.Data[v].pos.x * scale.x, cmd_list->VtxBuffer.Data[v].pos.y * scale.y);
+				bounds = ImVec4(ImMin(bounds.x, p.x), ImMin(bounds.y, p.y), ImMax(bounds.z, p.x), ImMax(bounds.w, p.y));
+			}
+			bounds.x = ImMax(bounds.x, pcmd->ClipRect.x) - pos.x;
+			bounds.y = ImMax(bounds.y, pcmd->ClipRect.y) - pos.y;
+			bounds.z = ImMin(bounds.z, pcmd->ClipRect.z) - pos.x;
+			bounds.w = ImMin(bounds.w, pcmd->ClipRect.w) - pos.y;
+
+			// round outwards to whole pixels, with a pixel of margin for anti-aliased edges
+			bounds.x = ImMax(0.0f, floorf(bounds.x) - 1.0f);
+			bounds.y = ImMax(0.0f, floorf(bounds.y) - 1.0f);
+			bounds.z = ImMin((float)fb_width, ceilf(bounds.z) + 1.0f);
+			bounds.w = ImMin((float)fb_height, ceilf(bounds.w) + 1.0f);
+			if (bounds.x >= bounds.z || bounds.y >= bounds.w) continue;
+
+			ImGui_ImplOvr_CmdFingerprint fingerprint;
+			fingerprint.Hash = h;
+			fingerprint.Bounds = bounds;
+			fingerprint.AlwaysDamaged = (GLuint)(intptr_t)pcmd->TextureId != g_FontTexture;
+			out_fingerprints->push_back(fingerprint);
+		}
+	}
+	std::sort(out_fingerprints->begin(), out_fingerprints->end(), ImGui_ImplOvr_CmdFingerprintLess);
+}
+
+/**
+ * @brief Adds a rectangle to a list of damage rectangles, merging it into an overlapping one if possible.
+ * If there are too many rectangles, it's merged into whichever one grows the least.
+ * 
+ * @param rect The rectangle to add, (x1, y1, x2, y2)
+ * @param rects The list of damage rectangles
+ */
+static void ImGui_ImplOvr_AddDamageRect(ImVec4 rect, ImVector<ImVec4>* rects)
+{
+	int best = -1;
+	float best_growth = FLT_MAX;
+	for (int i = 0; i < rects->Size; i++)
+	{
+		const ImVec4& r = (*rects)[i];
+		const ImVec4 merged(ImMin(r.x, rect.x), ImMin(r.y, rect.y), ImMax(r.z, rect.z), ImMax(r.w, rect.w));
+		const float growth = (merged.z - merged.x) * (merged.w - merged.y) - (r.z - r.x) * (r.w - r.y);
+		const bool overlaps = rect.x <= r.z && rect.z >= r.x && rect.y <= r.w && rect.w >= r.y;
+		if (overlaps || rects->Size >= IMGUI_OVR_MAX_DAMAGE_RECTS)
+		{
+			if (growth < best_growth)
+			{
+				best_growth = growth;
+				best = i;
+			}
+		}
+	}
+
+	if (best < 0)
+	{
+		rects->push_back(rect);
+		return;
+	}
+
+	// merging may make the rectangle overlap others, so re-add it
+	ImVec4 merged = (*rects)[best];
+	merged = ImVec4(ImMin(merged.x, rect.x), ImMin(merged.y, rect.y), ImMax(merged.z, rect.z), ImMax(merged.w, rect.w));
+	rects->erase(rects->begin() + best);
+	ImGui_ImplOvr_AddDamageRect(merged, rects);
+}
+
+/**
+ * @brief Diffs the draw commands of this frame against the ones last drawn on the canvas, and computes
+ * the rectangles of the canvas that need to be redrawn. Commands that appeared or disappeared damage the
+ * area they cover, and so do commands sampling a user texture, which may have changed since.
+ * 
+ * Always records this frame's fingerprints to diff the next frame against.
+ * 
+ * @param draw_data This frame's draw data
+ * @param fb_width The width of the canvas in pixels
+ * @param fb_height The height of the canvas in pixels
+ * @param can_be_partial False if the canvas needs redrawing in full regardless
+ * @param out_rects Where to write the damage rectangles
+ * @return True if only the damage rectangles need redrawing, false if the whole canvas does
+ */
+static bool ImGui_ImplOvr_ComputeDamage(const ImDrawData* draw_data, int fb_width, int fb_height, bool can_be_partial, ImVector<ImVec4>* out_rects)
+{
+	out_rects->resize(0);
+	ImGui_ImplOvr_FingerprintCommands(draw_data, fb_width, fb_height, &g_CmdFingerprints);
+
+	bool partial = can_be_partial;
+	if (partial)
+	{
+		// both lists are sorted by hash, so walk them together to find unmatched commands
+		const ImVector<ImGui_ImplOvr_CmdFingerprint>& cur = g_CmdFingerprints;
+		const ImVector<ImGui_ImplOvr_CmdFingerprint>& prev = g_Ctx->PrevCmdFingerprints;
+		int i = 0, j = 0;
+		while (i < cur.Size || j < prev.Size)
+		{
+			if (i < cur.Size && j < prev.Size && cur[i].Hash == prev[j].Hash)
+			{
+				if (cur[i].AlwaysDamaged) ImGui_ImplOvr_AddDamageRect(cur[i].Bounds, out_rects);
+				i++; j++;
+			}
+			else if (j >= prev.Size || (i < cur.Size && cur[i].Hash < prev[j].Hash)) ImGui_ImplOvr_AddDamageRect(cur[i++].Bounds, out_rects);
+			else ImGui_ImplOvr_AddDamageRect(prev[j++].Bounds, out_rects);
+		}
+
+		// if most of the canvas is damaged anyway, one full pass is cheaper than several partial ones
+		float damaged_area = 0.0f;
+		for (int r = 0; r < out_rects->Size; r++)
+		{
+			const ImVec4& rect = (*out_rects)[r];
+			damaged_area += (rect.z - rect.x) * (rect.w - rect.y);
+		}
+		partial = damaged_area < 0.5f * (float)fb_width * (float)fb_height;
+	}
+
+	g_Ctx->PrevCmdFingerprints.swap(g_CmdFingerprints);
+	return partial;
+}
+
+/**
+ * @brief Destroys the canvas layer swap chain of a panel, if there is one.
+ * 
+ * @param ctx The panel
+ */
+static void ImGui_ImplOvr_DestroyLayerSwapChain(ImGui_ImplOvr_Context* ctx)
+{
+	if (ctx->LayerSwapChain)
+	{
+		g_Hmd->destroy_swap_chain(ctx->LayerSwapChain);
+		ctx->LayerSwapChain = nullptr;
+	}
+	ctx->LayerSize = glm::ivec2(0, 0);
+	ctx->LayerLevels = 0;
+}
+
+/**
+ * @brief Creates the swap chain the canvas is copied into for the compositor quad layer, matching the
+ * virtual canvas size and with as many mip levels as the canvas atlas. The format is linear like the canvas
+ * texture, so the layer looks the same as the canvas drawn with ImGui_ImplOvr_RenderGUIQuad().
+ * 
+ * @param ctx The panel to create the swap chain for
+ * @return True if the swap chain was created successfully
+ */
+static bool ImGui_ImplOvr_CreateLayerSwapChain(ImGui_ImplOvr_Context* ctx)
+{
+	ImGui_ImplOvr_DestroyLayerSwapChain(ctx);
+
+	// no more levels than the canvas size has
+	int levels = 1;
+	while (levels < ImMax(g_CanvasAtlas.Levels, 1) && (ImMax(ctx->VirtualCanvasSize.x, ctx->VirtualCanvasSize.y) >> levels) > 0)
+		levels++;
+
+	ovrTextureSwapChainDesc desc = {};
+	desc.Type = ovrTexture_2D;
+	desc.ArraySize = 1;
+	desc.Width = ctx->VirtualCanvasSize.x;
+	desc.Height = ctx->VirtualCanvasSize.y;
+	desc.MipLevels = levels;
+	desc.Format = OVR_FORMAT_R8G8B8A8_UNORM;
+	desc.SampleCount = 1;
+	desc.StaticImage = ovrFalse;
+
+	ctx->LayerSwapChain = g_Hmd->create_swap_chain(desc);
+	if (!ctx->LayerSwapChain)
+	{
+		fprintf(stderr, "ERROR: ImGui_ImplOvr_CreateLayerSwapChain: failed to create canvas layer swap chain\n");
+		return false;
+	}
+
+	ctx->LayerSize = ctx->VirtualCanvasSize;
+	ctx->LayerLevels = levels;
+	ctx->LayerStale = true;
+	return true;
+}
+
+/**
+ * @brief Checks whether a tracked piece of GL state needs to be changed, and updates the state stats.
+ * 
+ * @param bit The ImGuiVrStateBit of the state
+ * @param unchanged True if the new value matches the shadow value
+ * @return True if the GL call should be made, false if it's redundant
+ */
+static bool ImGui_ImplOvr_StateNeedsChange(unsigned int bit, bool unchanged)
+{
+	if ((g_GLState.Known & bit) && unchanged)
+	{
+		g_StateStats.StateChangesElided++;
+		return false;
+	}
+	g_GLState.Known |= bit;
+	g_StateStats.StateChanges++;
+	return true;
+}
+
+static void ImGui_ImplOvr_StateActiveTexture(GLenum unit)
+{
+	if (!ImGui_ImplOvr_StateNeedsChange(ImGuiVrStateBit_ActiveTexture, g_GLState.ActiveTexture == unit)) return;
+	glActiveTexture(unit);
+	if (g_GLState.ActiveTexture != unit) g_GLState.Known &= ~ImGuiVrStateBit_Texture; // texture binding is per unit
+	g_GLState.ActiveTexture = unit;
+}
+
+static void ImGui_ImplOvr_StateUseProgram(GLuint program)
+{
+	if (!ImGui_ImplOvr_StateNeedsChange(ImGuiVrStateBit_Program, g_GLState.Program == program)) return;
+	glUseProgram(program);
+	g_GLState.Program = program;
+}
+
+// @note Assumes texture unit 0 is active, as it is everywhere in this renderer
+static void ImGui_ImplOvr_StateBindTexture(GLuint texture)
+{
+	if (!ImGui_ImplOvr_StateNeedsChange(ImGuiVrStateBit_Texture, g_GLState.Texture == texture)) return;
+	glBindTexture(GL_TEXTURE_2D, texture);
+	g_GLState.Texture = texture;
+}
+
+static void ImGui_ImplOvr_StateBindSampler(GLuint sampler)
+{
+	if (!glBindSampler) return;
+	if (!ImGui_ImplOvr_StateNeedsChange(ImGuiVrStateBit_Sampler, g_GLState.Sampler == sampler)) return;
+	glBindSampler(0, sampler);
+	g_GLState.Sampler = sampler;
+}
+
+static void ImGui_ImplOvr_StateBindArrayBuffer(GLuint buffer)
+{
+	if (!ImGui_ImplOvr_StateNeedsChange(ImGuiVrStateBit_ArrayBuffer, g_GLState.ArrayBuffer == buffer)) return;
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	g_GLState.ArrayBuffer = buffer;
+}
+
+static void ImGui_ImplOvr_StateBindVertexArray(GLuint vao)
+{
+	if (!ImGui_ImplOvr_StateNeedsChange(ImGuiVrStateBit_VertexArray, g_GLState.VertexArray == vao)) return;
+	glBindVertexArray(vao);
+	g_GLState.VertexArray = vao;
+}
+
+static void ImGui_ImplOvr_StateBindFramebuffer(GLuint framebuffer)
+{
+	if (!ImGui_ImplOvr_StateNeedsChange(ImGuiVrStateBit_Framebuffer, g_GLState.Framebuffer == framebuffer)) return;
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	g_GLState.Framebuffer = framebuffer;
+}
+
+static void ImGui_ImplOvr_StatePolygonMode(GLenum mode)
+{
+	if (!ImGui_ImplOvr_StateNeedsChange(ImGuiVrStateBit_PolygonMode, g_GLState.PolygonMode == mode)) return;
+	glPolygonMode(GL_FRONT_AND_BACK, mode);
+	g_GLState.PolygonMode = mode;
+}
+
+static void ImGui_ImplOvr_StateViewport(GLint x, GLint y, GLint w, GLint h)
+{
+	const GLint* v = g_GLState.Viewport;
+	if (!ImGui_ImplOvr_StateNeedsChange(ImGuiVrStateBit_Viewport, v[0] == x && v[1] == y && v[2] == w && v[3] == h)) return;
+	glViewport(x, y, (GLsizei)w, (GLsizei)h);
+	g_GLState.Viewport[0] = x; g_GLState.Viewport[1] = y; g_GLState.Viewport[2] = w; g_GLState.Viewport[3] = h;
+}
+
+static void ImGui_ImplOvr_StateScissor(GLint x, GLint y, GLint w, GLint h)
+{
+	const GLint* b = g_GLState.ScissorBox;
+	if (!ImGui_ImplOvr_StateNeedsChange(ImGuiVrStateBit_ScissorBox, b[0] == x && b[1] == y && b[2] == w && b[3] == h)) return;
+	glScissor(x, y, (GLsizei)w, (GLsizei)h);
+	g_GLState.ScissorBox[0] = x; g_GLState.ScissorBox[1] = y; g_GLState.ScissorBox[2] = w; g_GLState.ScissorBox[3] = h;
+}
+
+static void ImGui_ImplOvr_StateBlendEquation(GLenum rgb, GLenum alpha)
+{
+	if (!ImGui_ImplOvr_StateNeedsChange(ImGuiVrStateBit_BlendEquation, g_GLState.BlendEquationRgb == rgb && g_GLState.BlendEquationAlpha == alpha)) return;
+	glBlendEquationSeparate(rgb, alpha);
+	g_GLState.BlendEquationRgb = rgb;
+	g_GLState.BlendEquationAlpha = alpha;
+}
+
+static void ImGui_ImplOvr_StateBlendFunc(GLenum src_rgb, GLenum dst_rgb, GLenum src_alpha, GLenum dst_alpha)
+{
+	const bool unchanged = g_GLState.BlendSrcRgb == src_rgb && g_GLState.BlendDstRgb == dst_rgb
+		&& g_GLState.BlendSrcAlpha == src_alpha && g_GLState.BlendDstAlpha == dst_alpha;
+	if (!ImGui_ImplOvr_StateNeedsChange(ImGuiVrStateBit_BlendFunc, unchanged)) return;
+	glBlendFuncSeparate(src_rgb, dst_rgb, src_alpha, dst_alpha);
+	g_GLState.BlendSrcRgb = src_rgb; g_GLState.BlendDstRgb = dst_rgb;
+	g_GLState.BlendSrcAlpha = src_alpha; g_GLState.BlendDstAlpha = dst_alpha;
+}
+
+/**
+ * @brief Enables or disables a GL capability if it isn't already.
+ * 
+ * @param bit The ImGuiVrStateBit of the capability
+ * @param cap The GL capability, e.g. GL_BLEND
+ * @param enable Whether to enable or disable it
+ */
+static void ImGui_ImplOvr_StateEnable(unsigned int bit, GLenum cap, bool enable)
+{
+	bool* shadow = nullptr;
+	switch (bit)
+	{
+		case ImGuiVrStateBit_Blend: shadow = &g_GLState.Blend; break;
+		case ImGuiVrStateBit_CullFace: shadow = &g_GLState.CullFace; break;
+		case ImGuiVrStateBit_DepthTest: shadow = &g_GLState.DepthTest; break;
+		case ImGuiVrStateBit_ScissorTest: shadow = &g_GLState.ScissorTest; break;
+		default: return;
+	}
+	if (!ImGui_ImplOvr_StateNeedsChange(bit, *shadow == enable)) return;
+	if (enable) glEnable(cap); else glDisable(cap);
+	*shadow = enable;
+}
+
+/**
+ * @brief Backs up the host's GL state so it can be restored with ImGui_ImplOvr_StateRestore(). The backed
+ * up values also become the shadow state, so changes back to the same values are skipped.
+ * 
+ * Does nothing if the engine owns the GL state, the shadow state is trusted instead.
+ * 
+ * @note Backing up the texture binding makes texture unit 0 active.
+ * 
+ * @param mask ImGuiVrStateBit flags of the state to back up
+ * @param backup Where to back the state up to
+ */
+static void ImGui_ImplOvr_StateBackup(unsigned int mask, ImGui_ImplOvr_GLState* backup)
+{
+	backup->Known = 0;
+	if (g_EngineOwnsGLState) return;
+
+	// the texture binding belongs to the active unit, so we need to know which one to restore to
+	if (mask & (ImGuiVrStateBit_Texture | ImGuiVrStateBit_Sampler)) mask |= ImGuiVrStateBit_ActiveTexture;
+
+	ImGui_ImplOvr_GLState& st = g_GLState;
+	GLint value;
+	if (mask & ImGuiVrStateBit_ActiveTexture) { glGetIntegerv(GL_ACTIVE_TEXTURE, &value); st.ActiveTexture = (GLenum)value; g_StateStats.StateQueries++; }
+	if (mask & ImGuiVrStateBit_Program) { glGetIntegerv(GL_CURRENT_PROGRAM, &value); st.Program = (GLuint)value; g_StateStats.StateQueries++; }
+	if (mask & ImGuiVrStateBit_ArrayBuffer) { glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &value); st.ArrayBuffer = (GLuint)value; g_StateStats.StateQueries++; }
+	if (mask & ImGuiVrStateBit_VertexArray) { glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &value); st.VertexArray = (GLuint)value; g_StateStats.StateQueries++; }
+	if (mask & ImGuiVrStateBit_Framebuffer) { glGetIntegerv(GL_FRAMEBUFFER_BINDING, &value); st.Framebuffer = (GLuint)value; g_StateStats.StateQueries++; }
+	if (mask & ImGuiVrStateBit_PolygonMode) { GLint modes[2]; glGetIntegerv(GL_POLYGON_MODE, modes); st.PolygonMode = (GLenum)modes[0]; g_StateStats.StateQueries++; }
+	if (mask & ImGuiVrStateBit_Viewport) { glGetIntegerv(GL_VIEWPORT, st.Viewport); g_StateStats.StateQueries++; }
+	if (mask & ImGuiVrStateBit_ScissorBox) { glGetIntegerv(GL_SCISSOR_BOX, st.ScissorBox); g_StateStats.StateQueries++; }
+	if (mask & ImGuiVrStateBit_BlendEquation)
+	{
+		glGetIntegerv(GL_BLEND_EQUATION_RGB, (GLint*)&st.BlendEquationRgb);
+		glGetIntegerv(GL_BLEND_EQUATION_ALPHA, (GLint*)&st.BlendEquationAlpha);
+		g_StateStats.StateQueries += 2;
+	}
+	if (mask & ImGuiVrStateBit_BlendFunc)
+	{
+		glGetIntegerv(GL_BLEND_SRC_RGB, (GLint*)&st.BlendSrcRgb);
+		glGetIntegerv(GL_BLEND_DST_RGB, (GLint*)&st.BlendDstRgb);
+		glGetIntegerv(GL_BLEND_SRC_ALPHA, (GLint*)&st.BlendSrcAlpha);
+		glGetIntegerv(GL_BLEND_DST_ALPHA, (GLint*)&st.BlendDstAlpha);
+		g_StateStats.StateQueries += 4;
+	}
+	if (mask & ImGuiVrStateBit_Blend) { st.Blend = glIsEnabled(GL_BLEND) == GL_TRUE; g_StateStats.StateQueries++; }
+	if (mask & ImGuiVrStateBit_CullFace) { st.CullFace = glIsEnabled(GL_CULL_FACE) == GL_TRUE; g_StateStats.StateQueries++; }
+	if (mask & ImGuiVrStateBit_DepthTest) { st.DepthTest = glIsEnabled(GL_DEPTH_TEST) == GL_TRUE; g_StateStats.StateQueries++; }
+	if (mask & ImGuiVrStateBit_ScissorTest) { st.ScissorTest = glIsEnabled(GL_SCISSOR_TEST) == GL_TRUE; g_StateStats.StateQueries++; }
+	st.Known |= mask & ~(ImGuiVrStateBit_Texture | ImGuiVrStateBit_Sampler);
+
+	// the per-unit bindings are queried on unit 0, which is the unit we use
+	if (mask & (ImGuiVrStateBit_Texture | ImGuiVrStateBit_Sampler))
+	{
+		const GLenum last_active_texture = st.ActiveTexture;
+		ImGui_ImplOvr_StateActiveTexture(GL_TEXTURE0);
+		if (mask & ImGuiVrStateBit_Texture) { glGetIntegerv(GL_TEXTURE_BINDING_2D, &value); st.Texture = (GLuint)value; g_StateStats.StateQueries++; }
+		if (mask & ImGuiVrStateBit_Sampler) { glGetIntegerv(GL_SAMPLER_BINDING, &value); st.Sampler = (GLuint)value; g_StateStats.StateQueries++; }
+		st.Known |= mask & (ImGuiVrStateBit_Texture | ImGuiVrStateBit_Sampler);
+		*backup = st;
+		backup->ActiveTexture = last_active_texture;
+	}
+	else
+	{
+		*backup = st;
+	}
+	backup->Known = mask;
+}
+
+/**
+ * @brief Restores GL state backed up with ImGui_ImplOvr_StateBackup(), skipping any state that already matches.
+ * 
+ * @param backup The backed up state
+ */
+static void ImGui_ImplOvr_StateRestore(const ImGui_ImplOvr_GLState& backup)
+{
+	const unsigned int mask = backup.Known;
+	if (mask & ImGuiVrStateBit_Program) ImGui_ImplOvr_StateUseProgram(backup.Program);
+	if (mask & ImGuiVrStateBit_Texture) ImGui_ImplOvr_StateBindTexture(backup.Texture);
+	if (mask & ImGuiVrStateBit_Sampler) ImGui_ImplOvr_StateBindSampler(backup.Sampler);
+	if (mask & ImGuiVrStateBit_ActiveTexture) ImGui_ImplOvr_StateActiveTexture(backup.ActiveTexture);
+	if (mask & ImGuiVrStateBit_VertexArray) ImGui_ImplOvr_StateBindVertexArray(backup.VertexArray);
+	if (mask & ImGuiVrStateBit_ArrayBuffer) ImGui_ImplOvr_StateBindArrayBuffer(backup.ArrayBuffer);
+	if (mask & ImGuiVrStateBit_BlendEquation) ImGui_ImplOvr_StateBlendEquation(backup.BlendEquationRgb, backup.BlendEquationAlpha);
+	if (mask & ImGuiVrStateBit_BlendFunc) ImGui_ImplOvr_StateBlendFunc(backup.BlendSrcRgb, backup.BlendDstRgb, backup.BlendSrcAlpha, backup.BlendDstAlpha);
+	if (mask & ImGuiVrStateBit_Blend) ImGui_ImplOvr_StateEnable(ImGuiVrStateBit_Blend, GL_BLEND, backup.Blend);
+	if (mask & ImGuiVrStateBit_CullFace) ImGui_ImplOvr_StateEnable(ImGuiVrStateBit_CullFace, GL_CULL_FACE, backup.CullFace);
+	if (mask & ImGuiVrStateBit_DepthTest) ImGui_ImplOvr_StateEnable(ImGuiVrStateBit_DepthTest, GL_DEPTH_TEST, backup.DepthTest);
+	if (mask & ImGuiVrStateBit_ScissorTest) ImGui_ImplOvr_StateEnable(ImGuiVrStateBit_ScissorTest, GL_SCISSOR_TEST, backup.ScissorTest);
+	if (mask & ImGuiVrStateBit_PolygonMode) ImGui_ImplOvr_StatePolygonMode(backup.PolygonMode);
+	if (mask & ImGuiVrStateBit_Viewport) ImGui_ImplOvr_StateViewport(backup.Viewport[0], backup.Viewport[1], backup.Viewport[2], backup.Viewport[3]);
+	if (mask & ImGuiVrStateBit_ScissorBox) ImGui_ImplOvr_StateScissor(backup.ScissorBox[0], backup.ScissorBox[1], backup.ScissorBox[2], backup.ScissorBox[3]);
+	if (mask & ImGuiVrStateBit_Framebuffer) ImGui_ImplOvr_StateBindFramebuffer(backup.Framebuffer);
+}
+
+/**
+ * @brief Points the bound VAO at the GUI render quad and the panel instance buffer.
+ * 
+ * @param divisor How many instances each panel's per-instance data is used for
+ */
+static void ImGui_ImplOvr_SetupQuadVao(GLuint divisor)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, g_QuadVbo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_QuadEbo);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * (3 + 2), nullptr);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * (3 + 2), reinterpret_cast<GLvoid*>(sizeof(GLfloat) * 3));
+
+	glBindBuffer(GL_ARRAY_BUFFER, g_PanelInstanceVbo);
+	for (int column = 0; column < 4; column++)
+	{
+		const GLuint location = IMGUI_OVR_QUAD_ATTRIB_MODEL_MTX + column;
+		glEnableVertexAttribArray(location);
+		glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(ImGui_ImplOvr_PanelInstance),
+			(GLvoid*)(IM_OFFSETOF(ImGui_ImplOvr_PanelInstance, ModelMtx) + sizeof(glm::vec4) * column));
+		glVertexAttribDivisor(location, divisor);
+	}
+	glEnableVertexAttribArray(IMGUI_OVR_QUAD_ATTRIB_ATLAS_RECT);
+	glVertexAttribPointer(IMGUI_OVR_QUAD_ATTRIB_ATLAS_RECT, 4, GL_FLOAT, GL_FALSE, sizeof(ImGui_ImplOvr_PanelInstance), (GLvoid*)IM_OFFSETOF(ImGui_ImplOvr_PanelInstance, AtlasRect));
+	glVertexAttribDivisor(IMGUI_OVR_QUAD_ATTRIB_ATLAS_RECT, divisor);
+	glEnableVertexAttribArray(IMGUI_OVR_QUAD_ATTRIB_ATLAS_LAYER);
+	glVertexAttribPointer(IMGUI_OVR_QUAD_ATTRIB_ATLAS_LAYER, 1, GL_FLOAT, GL_FALSE, sizeof(ImGui_ImplOvr_PanelInstance), (GLvoid*)IM_OFFSETOF(ImGui_ImplOvr_PanelInstance, AtlasLayer));
+	glVertexAttribDivisor(IMGUI_OVR_QUAD_ATTRIB_ATLAS_LAYER, divisor);
+}
+
+/**
+ * @brief Deletes a GL context's VAOs. Its context must be current.
+ * 
+ * @param vaos The VAOs to delete
+ */
+static void ImGui_ImplOvr_DeleteContextVaos(const ImGui_ImplOvr_ContextVaos& vaos)
+{
+	glDeleteVertexArrays(1, &vaos.DrawVao);
+	glDeleteVertexArrays(1, &vaos.QuadVao);
+	glDeleteVertexArrays(1, &vaos.QuadStereoVao);
+	glDeleteVertexArrays(1, &vaos.LineVao);
+}
+
+/**
+ * @brief Gets the VAOs for the current GL context, creating them if this is the first time
+ * we're drawing in this context.
+ * 
+ * @return The VAOs to use in the current GL context
+ */
+static const ImGui_ImplOvr_ContextVaos& ImGui_ImplOvr_GetContextVaos()
+{
+	void* const context = g_GetCurrentContextFunc ? g_GetCurrentContextFunc() : nullptr;
+	for (int i = 0; i < g_ContextVaos.Size; i++)
+	{
+		if (g_ContextVaos[i].Context != context) continue;
+		if (!g_ContextVaos[i].Stale) return g_ContextVaos[i];
+
+		// left over from before the device objects were rebuilt, its context is current now so they can go
+		ImGui_ImplOvr_DeleteContextVaos(g_ContextVaos[i]);
+		g_ContextVaos.erase(g_ContextVaos.begin() + i);
+		g_GLState.Known &= ~ImGuiVrStateBit_VertexArray;
+		break;
+	}
+
+	// first time in this context, build its VAOs
+	GLint last_array_buffer; glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &last_array_buffer);
+	GLint last_vertex_array; glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &last_vertex_array);
+
+	ImGui_ImplOvr_ContextVaos vaos = {};
+	vaos.Context = context;
+
+	// ImGui geometry, the buffers and offsets are set up each frame depending on upload mode
+	glGenVertexArrays(1, &vaos.DrawVao);
+	glBindVertexArray(vaos.DrawVao);
+	glBindBuffer(GL_ARRAY_BUFFER, g_VboHandle);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_ElementsHandle);
+	glEnableVertexAttribArray(g_AttribLocationPosition);
+	glEnableVertexAttribArray(g_AttribLocationUV);
+	glEnableVertexAttribArray(g_AttribLocationColor);
+	ImGui_ImplOvr_SetupVertexAttribs(0);
+
+	// GUI render quad, one instance per panel
+	glGenVertexArrays(1, &vaos.QuadVao);
+	glBindVertexArray(vaos.QuadVao);
+	ImGui_ImplOvr_SetupQuadVao(1);
+
+	// GUI render quad for the stereo program: when the eye comes from the instance ID, each panel's data
+	// spans two instances
+	glGenVertexArrays(1, &vaos.QuadStereoVao);
+	glBindVertexArray(vaos.QuadStereoVao);
+	ImGui_ImplOvr_SetupQuadVao(ImGui_ImplOvr_GetStereoMode() == ImGuiVrStereoMode_InstancedLayer ? 2 : 1);
+
+	// controller pointer line
+	glGenVertexArrays(1, &vaos.LineVao);
+	glBindVertexArray(vaos.LineVao);
+	glBindBuffer(GL_ARRAY_BUFFER, g_LineVbo);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+	glBindVertexArray(last_vertex_array);
+	glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
+
+	g_ContextVaos.push_back(vaos);
+	return g_ContextVaos.back();
+}
+
+/**
+ * @brief Get which single pass stereo technique the current context supports, if any. Multiview is preferred,
+ * as the driver can share vertex work between views; otherwise each draw is instanced once per eye and the
+ * vertex shader picks the layer with gl_Layer.
+ * 
+ * @return The stereo mode used by ImGui_ImplOvr_RenderGUIQuadStereo() and ImGui_ImplOvr_RenderControllerLineStereo()
+ */
+ImGuiVrStereoMode ImGui_ImplOvr_GetStereoMode()
+{
+	if (GLAD_GL_OVR_multiview && glFramebufferTextureMultiviewOVR) return ImGuiVrStereoMode_Multiview;
+	if (GLAD_GL_ARB_shader_viewport_layer_array) return ImGuiVrStereoMode_InstancedLayer;
+	return ImGuiVrStereoMode_None;
+}
+
+/**
+ * @brief Uploads both eyes' matrices to the eye matrices uniform buffer and binds it for the stereo shaders.
+ * 
+ * @param proj The projection matrices of the left and right eye
+ * @param view The view matrices of the left and right eye
+ */
+static void ImGui_ImplOvr_UploadEyeMatrices(const glm::mat4 proj[2], const glm::mat4 view[2])
+{
+	ImGui_ImplOvr_EyeMatrices matrices;
+	matrices.Proj[0] = proj[0];
+	matrices.Proj[1] = proj[1];
+	matrices.View[0] = view[0];
+	matrices.View[1] = view[1];
+
+	glBindBufferBase(GL_UNIFORM_BUFFER, IMGUI_OVR_EYE_MATRICES_BINDING, g_EyeMatricesUbo);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(matrices), &matrices);
+}
+
+/**
+ * @brief Issues a draw for both eyes with the current stereo program, either once with multiview or
+ * instanced once per eye.
+ * 
+ * @param mode The primitive type
+ * @param count The number of indices (or vertices if not indexed)
+ * @param indexed True to draw with glDrawElements from the bound element buffer, false for glDrawArrays
+ * @param instanceCount The number of instances to draw for each eye
+ */
+static void ImGui_ImplOvr_DrawStereo(GLenum mode, GLsizei count, bool indexed, GLsizei instanceCount = 1)
+{
+	const GLsizei instances = instanceCount * (ImGui_ImplOvr_GetStereoMode() == ImGuiVrStereoMode_Multiview ? 1 : 2);
+	if (indexed)
+		glDrawElementsInstanced(mode, count, GL_UNSIGNED_INT, nullptr, instances);
+	else
+		glDrawArraysInstanced(mode, 0, count, instances);
+}
+
+/**
+ * @brief One dimensional squared Euclidean distance transform of a sampled function, from
+ * Felzenszwalb & Huttenlocher, "Distance Transforms of Sampled Functions".
+ * 
+ * @param f The function to transform, n values
+ * @param d Output squared distances, n values
+ * @param v Scratch space for parabola locations, n values
+ * @param z Scratch space for parabola boundaries, n + 1 values
+ * @param n The number of samples
+ */
+static void ImGui_ImplOvr_DistanceTransform1D(const float* f, float* d, int* v, float* z, int n)
+{
+	int k = 0;
+	v[0] = 0;
+	z[0] = -FLT_MAX;
+	z[1] = FLT_MAX;
+	for (int q = 1; q < n; q++)
+	{
+		float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+		while (s <= z[k])
+		{
+			k--;
+			s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+		}
+		k++;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = FLT_MAX;
+	}
+
+	k = 0;
+	for (int q = 0; q < n; q++)
+	{
+		while (z[k + 1] < q) k++;
+		d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+	}
+}
+
+/**
+ * @brief Two dimensional squared Euclidean distance transform, done in place as a pass over
+ * the columns followed by a pass over the rows.
+ * 
+ * @param grid 0 for pixels to measure the distance to, a large value (but not infinity) elsewhere. Overwritten with squared distances.
+ * @param width The width of the grid
+ * @param height The height of the grid
+ */
+static void ImGui_ImplOvr_DistanceTransform2D(float* grid, int width, int height)
+{
+	const int n = ImMax(width, height);
+	ImVector<float> f, d, z;
+	ImVector<int> v;
+	f.resize(n);
+	d.resize(n);
+	z.resize(n + 1);
+	v.resize(n);
+
+	for (int x = 0; x < width; x++)
+	{
+		for (int y = 0; y < height; y++) f[y] = grid[y * width + x];
+		ImGui_ImplOvr_DistanceTransform1D(f.Data, d.Data, v.Data, z.Data, height);
+		for (int y = 0; y < height; y++) grid[y * width + x] = d[y];
+	}
+	for (int y = 0; y < height; y++)
+	{
+		memcpy(f.Data, grid + y * width, width * sizeof(float));
+		ImGui_ImplOvr_DistanceTransform1D(f.Data, d.Data, v.Data, z.Data, width);
+		memcpy(grid + y * width, d.Data, width * sizeof(float));
+	}
+}
+
+/**
+ * @brief Converts an 8-bit coverage font atlas into a signed distance field. 0.5 lies on the glyph edges, larger
+ * values are inside. Partially covered pixels use their coverage as a sub-pixel estimate of the edge.
+ * 
+ * The atlas' custom rectangles (the white pixel ImGui draws all untextured shapes with, and the mouse cursors)
+ * are kept as plain coverage, so solid shapes still come out opaque.
+ * 
+ * @param atlas The font atlas the coverage was built from
+ * @param coverage The 8-bit coverage of the atlas
+ * @param width The width of the atlas
+ * @param height The height of the atlas
+ * @param spread The distance in pixels mapped to the range [0, 0.5] on either side of the edge
+ * @param out_pixels The 8-bit distance field
+ */
+static void ImGui_ImplOvr_BuildFontSdf(const ImFontAtlas* atlas, const unsigned char* coverage, int width, int height, float spread, ImVector<unsigned char>* out_pixels)
+{
+	const int count = width * height;
+	ImVector<float> to_inside, to_outside;
+	to_inside.resize(count);
+	to_outside.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		const bool inside = coverage[i] >= 128;
+		to_inside[i] = inside ? 0.f : 1e20f;
+		to_outside[i] = inside ? 1e20f : 0.f;
+	}
+	ImGui_ImplOvr_DistanceTransform2D(to_inside.Data, width, height);
+	ImGui_ImplOvr_DistanceTransform2D(to_outside.Data, width, height);
+
+	out_pixels->resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		// signed distance from the edge in pixels, negative inside
+		float dist;
+		if (coverage[i] > 0 && coverage[i] < 255)
+			dist = 0.5f - coverage[i] / 255.f;
+		else if (coverage[i] >= 128)
+			dist = 0.5f - sqrtf(to_outside[i]);
+		else
+			dist = sqrtf(to_inside[i]) - 0.5f;
+
+		const float value = 0.5f - dist / (2.f * spread);
+		(*out_pixels)[i] = (unsigned char)(ImClamp(value, 0.f, 1.f) * 255.f + 0.5f);
+	}
+
+	for (int r = 0; r < atlas->CustomRects.Size; r++)
+	{
+		const ImFontAtlas::CustomRect& rect = atlas->CustomRects[r];
+		if (!rect.IsPacked()) continue;
+		for (int y = rect.Y; y < rect.Y + rect.Height; y++)
+		{
+			memcpy(out_pixels->Data + y * width + rect.X, coverage + y * width + rect.X, rect.Width);
+		}
+	}
+}
+
+/**
+ * @brief Check whether the current context can create immutable buffer storage.
+ * 
+ * @return True if ARB_buffer_storage (core in GL 4.4) was loaded, false otherwise
+ */
+static bool ImGui_ImplOvr_HasBufferStorage()
+{
+	return GLAD_GL_ARB_buffer_storage && glBufferStorage && glFenceSync && glClientWaitSync;
+}
+
+/**
+ * @brief Blocks until the GPU has finished reading from a segment of the upload ring buffer.
+ * 
+ * @param segment The index of the segment to wait on
+ */
+static void ImGui_ImplOvr_WaitUploadRingSegment(int segment)
+{
+	GLsync fence = g_UploadRing.Fences[segment];
+	if (!fence) return;
+
+	// flush on the first wait so the fence is guaranteed to be signalled eventually
+	GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	while (result == GL_TIMEOUT_EXPIRED)
+	{
+		result = glClientWaitSync(fence, 0, 1000000); // 1ms
+	}
+	glDeleteSync(fence);
+	g_UploadRing.Fences[segment] = 0;
+}
+
+/**
+ * @brief Unmaps and deletes the upload ring buffer, waiting for the GPU to finish with it first.
+ */
+static void ImGui_ImplOvr_DestroyUploadRing()
+{
+	for (int i = 0; i < IMGUI_OVR_UPLOAD_RING_SEGMENTS; i++)
+	{
+		ImGui_ImplOvr_WaitUploadRingSegment(i);
+	}
+
+	if (g_UploadRing.Handle)
+	{
+		GLint last_copy_write_buffer; glGetIntegerv(GL_COPY_WRITE_BUFFER_BINDING, &last_copy_write_buffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, g_UploadRing.Handle);
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, last_copy_write_buffer);
+		glDeleteBuffers(1, &g_UploadRing.Handle);
+	}
+	g_UploadRing = ImGui_ImplOvr_UploadRing();
+}
+
+/**
+ * @brief (Re)creates the upload ring buffer so that each segment holds at least the given number of bytes.
+ * 
+ * The buffer is created with immutable storage and mapped once for writing for its whole lifetime.
+ * 
+ * @param segment_size The minimum size in bytes of each segment
+ * @return True if successful, false if the buffer could not be mapped
+ */
+static bool ImGui_ImplOvr_CreateUploadRing(size_t segment_size)
+{
+	ImGui_ImplOvr_DestroyUploadRing();
+	g_MergedVtxBuffer.clear();
+	g_MergedIdxBuffer.clear();
+
+	// round up so that small frame-to-frame growth doesn't cause reallocation
+	size_t size = 512 * 1024;
+	while (size < segment_size) size *= 2;
+
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	const GLsizeiptr total_size = (GLsizeiptr)(size * IMGUI_OVR_UPLOAD_RING_SEGMENTS);
+
+	// use the copy write target so we don't disturb the array/element buffer bindings
+	GLint last_copy_write_buffer; glGetIntegerv(GL_COPY_WRITE_BUFFER_BINDING, &last_copy_write_buffer);
+	glGenBuffers(1, &g_UploadRing.Handle);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, g_UploadRing.Handle);
+	glBufferStorage(GL_COPY_WRITE_BUFFER, total_size, nullptr, flags);
+	g_UploadRing.Mapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, total_size, flags);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, last_copy_write_buffer);
+
+	if (!g_UploadRing.Mapped)
+	{
+		fprintf(stderr, "ERROR: ImGui_ImplOvr_CreateUploadRing: failed to map upload ring buffer!\n");
+		glDeleteBuffers(1, &g_UploadRing.Handle);
+		g_UploadRing = ImGui_ImplOvr_UploadRing();
+		return false;
+	}
+
+	g_UploadRing.SegmentSize = size;
+	g_UploadRing.Segment = 0;
+	return true;
+}
+
+/**
+ * @brief Initialise ImGui Oculus VR renderer. Must be called before any other ImGui_ImplOvr function.
+ * 
+ * @param hmd The HMD backend the session was created with, the Oculus runtime or a simulated HMD.
+ * @param frameIndex A pointer to where you're storing the current VR frame index.
+ * @return True if successful initialisation, false otherwise.
+ */
+bool ImGui_ImplOvr_Init(HmdBackend* hmd, long long* const frameIndex)
+{
+	if (!hmd || !frameIndex) return false;
+	g_VRFrameIndex = frameIndex;
+	g_Hmd = hmd;
+
+	// the eye buffer pixels a unit of tangent covers at the recommended resolution, to size canvases by
+	const ovrFovPort fov = g_Hmd->get_hmd_desc().DefaultEyeFov[ovrEye_Left];
+	const ovrSizei eye_size = g_Hmd->get_fov_texture_size(ovrEye_Left, fov, 1.f);
+	if (fov.LeftTan + fov.RightTan > 0.f && fov.UpTan + fov.DownTan > 0.f)
+	{
+		g_EyePixelsPerTangent = glm::vec2(eye_size.w / (fov.LeftTan + fov.RightTan), eye_size.h / (fov.UpTan + fov.DownTan));
+	}
+
+	// create haptic pulse buffer
+	g_HapticPulseBuffer.Samples = new unsigned char[7]{ 0, 255, 0, 255, 0, 255, 0 };
+	g_HapticPulseBuffer.SamplesCount = 7;
+	g_HapticPulseBuffer.SubmitMode = ovrHapticsBufferSubmit_Enqueue;
+	
+	ImGuiIO& io = ImGui::GetIO();
+
+	// the current ImGui context becomes the default panel, its font atlas is shared with any others
+	g_DefaultContext.ImGuiCtx = ImGui::GetCurrentContext();
+	g_Ctx = &g_DefaultContext;
+	g_InputContext = &g_DefaultContext;
+	g_Contexts.clear();
+	g_Contexts.push_back(&g_DefaultContext);
+
+	// HACK: create device objects here otherwise assertion that font is already
+	// built will fail in ImGui platform binding Init (i.e. ImGui_Impl_Glfw_Init())
+	ImGui_ImplOvr_CreateDeviceObjects();
+
+	return true;
+}
+
+/**
+ * @brief Shutdown the ImGui Oculus VR renderer. Call this when your program exits, cleans up
+ * OpenGL objects and deletes allocated memory.
+ */
+void ImGui_ImplOvr_Shutdown()
+{
+	// destroy every panel but the default one, whose ImGui context belongs to the user
+	while (g_Contexts.Size > 1)
+	{
+		ImGui_ImplOvr_DestroyContext(g_Contexts.back());
+	}
+
+	ImGui_ImplOvr_StopInputPolling();
+	ImGui_ImplOvr_StopRecording();
+	ImGui_ImplOvr_StopReplay();
+	ImGui_ImplOvr_StopProfileStream();
+	g_ProfileWriter.Stop();
+	ImGui_ImplOvr_DestroyDeviceObjects();
+	delete[] static_cast<unsigned char const*>(g_HapticPulseBuffer.Samples);
+}
+
+/**
+ * @brief The room a canvas takes in the canvas atlas along one side: its size plus IMGUI_OVR_CANVAS_ALIGN texels of
+ * padding, rounded up to a multiple of IMGUI_OVR_CANVAS_ALIGN.
+ * 
+ * @param size The width or height of the canvas
+ * @return The width or height it takes in the atlas
+ */
+static int ImGui_ImplOvr_AtlasPadded(int size)
+{
+	return (size + 2 * IMGUI_OVR_CANVAS_ALIGN - 1) & ~(IMGUI_OVR_CANVAS_ALIGN - 1);
+}
+
+/**
+ * @brief Allocates a rectangle of the canvas atlas on the shelf whose height fits it most closely, opening a new
+ * shelf if none has room. Doesn't grow or repack the atlas. The rectangle is aligned and padded, see
+ * ImGui_ImplOvr_AtlasPadded().
+ * 
+ * @param w The width of the rectangle
+ * @param h The height of the rectangle
+ * @param out_rect Set to the allocated rectangle
+ * @return True if the rectangle fit in the atlas
+ */
+static bool ImGui_ImplOvr_AtlasAlloc(int w, int h, ImGui_ImplOvr_AtlasRect* out_rect)
+{
+	ImGui_ImplOvr_CanvasAtlas& atlas = g_CanvasAtlas;
+	const int padded_w = ImGui_ImplOvr_AtlasPadded(w), padded_h = ImGui_ImplOvr_AtlasPadded(h);
+	if (padded_w > atlas.Size || padded_h > atlas.Size) return false;
+
+	// shelves with room take canvases up to a third shorter than them, empty shelves take any that fit
+	ImGui_ImplOvr_AtlasShelf* best = nullptr;
+	for (int i = 0; i < atlas.Shelves.Size; i++)
+	{
+		ImGui_ImplOvr_AtlasShelf& shelf = atlas.Shelves[i];
+		if (shelf.Height < padded_h || atlas.Size - shelf.Used < padded_w) continue;
+		if (shelf.Allocations > 0 && shelf.Height > padded_h + padded_h / 2) continue;
+		if (!best || shelf.Height < best->Height) best = &shelf;
+	}
+
+	// otherwise open a new shelf above the others in the first layer with room
+	for (int layer = 0; layer < atlas.Layers && !best; layer++)
+	{
+		int top = 0;
+		for (int i = 0; i < atlas.Shelves.Size; i++)
+		{
+			if (atlas.Shelves[i].Layer == layer) top = ImMax(top, atlas.Shelves[i].Y + atlas.Shelves[i].Height);
+		}
+		if (atlas.Size - top < padded_h) continue;
+
+		const ImGui_ImplOvr_AtlasShelf shelf = { layer, top, padded_h, 0, 0 };
+		atlas.Shelves.push_back(shelf);
+		best = &atlas.Shelves.back();
+	}
+	if (!best) return false;
+
+	out_rect->Layer = best->Layer;
+	out_rect->X = best->Used;
+	out_rect->Y = best->Y;
+	out_rect->W = w;
+	out_rect->H = h;
+	best->Used += padded_w;
+	best->Allocations++;
+	return true;
+}
+
+/**
+ * @brief Returns a rectangle to the canvas atlas. Its space is only reused right away if it was the last one on
+ * its shelf, otherwise it stays a hole until the shelf empties or the atlas is repacked.
+ * 
+ * @param rect The rectangle to free, reset to unallocated
+ */
+static void ImGui_ImplOvr_AtlasFree(ImGui_ImplOvr_AtlasRect* rect)
+{
+	if (rect->Layer < 0) return;
+
+	for (int i = 0; i < g_CanvasAtlas.Shelves.Size; i++)
+	{
+		ImGui_ImplOvr_AtlasShelf& shelf = g_CanvasAtlas.Shelves[i];
+		if (shelf.Layer != rect->Layer || shelf.Y != rect->Y) continue;
+
+		if (--shelf.Allocations == 0)
+			shelf.Used = 0;
+		else if (rect->X + ImGui_ImplOvr_AtlasPadded(rect->W) == shelf.Used)
+			shelf.Used -= ImGui_ImplOvr_AtlasPadded(rect->W);
+		break;
+	}
+	*rect = ImGui_ImplOvr_AtlasRect();
+}
+
+/**
+ * @brief The smallest power of 2 at least a given size.
+ * 
+ * @param size The size
+ * @return The power of 2
+ */
+static int ImGui_ImplOvr_NextPowerOfTwo(int size)
+{
+	int pow2 = 1;
+	while (pow2 < size) pow2 <<= 1;
+	return pow2;
+}
+
+/**
+ * @brief The smallest atlas layer size that could hold the canvas of every panel with an FBO: the power of 2 at
+ * least as big as the largest padded canvas and the square root of their padded area. Shelf packing wastes some
+ * space, so they may need a bigger one.
+ * 
+ * @param out_area Set to the padded area of the canvases, if not null
+ * @return The layer size
+ */
+static int ImGui_ImplOvr_CanvasAtlasMinSize(long long* out_area)
+{
+	int largest = 0;
+	long long area = 0;
+	for (int i = 0; i < g_Contexts.Size; i++)
+	{
+		if (!g_Contexts[i]->GuiFBO) continue;
+		const int w = ImGui_ImplOvr_AtlasPadded(g_Contexts[i]->VirtualCanvasSize.x), h = ImGui_ImplOvr_AtlasPadded(g_Contexts[i]->VirtualCanvasSize.y);
+		largest = ImMax(largest, ImMax(w, h));
+		area += (long long)w * h;
+	}
+	if (out_area) *out_area = area;
+	// no smaller than the smallest padded canvas, so every mip level exists even with no canvases at all
+	return ImGui_ImplOvr_NextPowerOfTwo(ImMax(ImMax(largest, (int)ceil(sqrt((double)area))), 2 * IMGUI_OVR_CANVAS_ALIGN));
+}
+
+/**
+ * @brief Attaches the atlas layer holding a panel's canvas to the panel's FBO.
+ * 
+ * @param ctx The panel
+ */
+static void ImGui_ImplOvr_AttachCanvas(ImGui_ImplOvr_Context* ctx)
+{
+	GLint last_framebuffer;
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &last_framebuffer);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, ctx->GuiFBO);
+	glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, g_CanvasAtlas.Texture, 0, ImMax(ctx->CanvasRect.Layer, 0));
+
+	glBindFramebuffer(GL_FRAMEBUFFER, last_framebuffer);
+}
+
+/**
+ * @brief Repacks the canvas of every panel with an FBO into a new atlas texture, tallest first. The layers start at
+ * ImGui_ImplOvr_CanvasAtlasMinSize() and double until the canvases fit or they reach IMGUI_OVR_CANVAS_ATLAS_SIZE,
+ * then layers are added. Canvases that were already drawn are copied over, so they don't need redrawing.
+ * 
+ * @return True if every canvas was placed
+ */
+static bool ImGui_ImplOvr_RepackCanvasAtlas()
+{
+	ImGui_ImplOvr_CanvasAtlas& atlas = g_CanvasAtlas;
+	GLint max_size = 0, max_layers = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers);
+
+	// the layers must at least fit the biggest canvas
+	ImVector<ImGui_ImplOvr_Context*> panels;
+	for (int i = 0; i < g_Contexts.Size; i++)
+	{
+		if (g_Contexts[i]->GuiFBO) panels.push_back(g_Contexts[i]);
+	}
+	const int max_layer_size = (int)max_size & ~(IMGUI_OVR_CANVAS_ALIGN - 1);
+	int size = ImMin(ImGui_ImplOvr_CanvasAtlasMinSize(nullptr), max_layer_size);
+	const int grow_limit = ImMax(size, ImMin(IMGUI_OVR_CANVAS_ATLAS_SIZE, max_layer_size));
+	std::stable_sort(panels.begin(), panels.end(), [](const ImGui_ImplOvr_Context* a, const ImGui_ImplOvr_Context* b)
+	{
+		return a->VirtualCanvasSize.y > b->VirtualCanvasSize.y;
+	});
+
+	// grow the layers, then add more, until everything fits
+	ImVector<ImGui_ImplOvr_AtlasRect> rects;
+	const GLuint old_texture = atlas.Texture;
+	int layers = 1, placed = 0;
+	for (;;)
+	{
+		atlas.Size = size;
+		atlas.Layers = layers;
+		atlas.Shelves.resize(0);
+		rects.resize(0);
+		for (placed = 0; placed < panels.Size; placed++)
+		{
+			rects.push_back(ImGui_ImplOvr_AtlasRect());
+			const glm::ivec2 canvas = glm::min(panels[placed]->VirtualCanvasSize, glm::ivec2(size - IMGUI_OVR_CANVAS_ALIGN));
+			if (!ImGui_ImplOvr_AtlasAlloc(canvas.x, canvas.y, &rects.back())) break;
+		}
+		if (placed == panels.Size) break;
+		if (size < grow_limit) size = ImMin(size * 2, grow_limit);
+		else if (layers < max_layers) layers++;
+		else break;
+	}
+	if (placed < panels.Size)
+	{
+		fprintf(stderr, "ERROR: ImGui_ImplOvr_RepackCanvasAtlas: panel canvases don't fit in %d atlas layers!\n", layers);
+	}
+
+	GLint last_texture;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D_ARRAY, &last_texture);
+	glGenTextures(1, &atlas.Texture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, atlas.Texture);
+	atlas.Levels = IMGUI_OVR_CANVAS_MIP_LEVELS;
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, atlas.Levels, GL_RGBA8, size, size, layers);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, atlas.Levels - 1);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, last_texture);
+
+	for (int i = 0; i < panels.Size; i++)
+	{
+		ImGui_ImplOvr_Context* ctx = panels[i];
+		const ImGui_ImplOvr_AtlasRect& from = ctx->CanvasRect;
+		const ImGui_ImplOvr_AtlasRect to = i < placed ? rects[i] : ImGui_ImplOvr_AtlasRect();
+		if (old_texture && ctx->CanvasDrawn && from.Layer >= 0 && to.Layer >= 0 && from.W == to.W && from.H == to.H)
+		{
+			// every level, padding included, so the mips needn't be generated again
+			for (int level = 0; level < atlas.Levels; level++)
+			{
+				glCopyImageSubData(old_texture, GL_TEXTURE_2D_ARRAY, level, from.X >> level, from.Y >> level, from.Layer,
+					atlas.Texture, GL_TEXTURE_2D_ARRAY, level, to.X >> level, to.Y >> level, to.Layer,
+					ImGui_ImplOvr_AtlasPadded(to.W) >> level, ImGui_ImplOvr_AtlasPadded(to.H) >> level, 1);
+			}
+		}
+		else
+		{
+			ctx->CanvasValid = false;
+			ctx->CanvasDrawn = false;
+			ctx->PrevCmdFingerprints.clear();
+		}
+		ctx->CanvasRect = to;
+		ImGui_ImplOvr_AttachCanvas(ctx);
+	}
+
+	if (old_texture)
+	{
+		glDeleteTextures(1, &old_texture);
+		atlas.Defragmentations++;
+	}
+	return placed == panels.Size;
+}
+
+/**
+ * @brief Repacks the canvas atlas if its canvases would fit in fewer layers, or in layers half the size, after panels
+ * were destroyed or shrunk.
+ */
+static void ImGui_ImplOvr_CompactCanvasAtlas()
+{
+	const ImGui_ImplOvr_CanvasAtlas& atlas = g_CanvasAtlas;
+	if (!atlas.Texture) return;
+
+	long long used_area = 0;
+	const int min_size = ImGui_ImplOvr_CanvasAtlasMinSize(&used_area);
+	const bool fewer_layers = atlas.Layers > 1 && used_area * 2 < (long long)atlas.Size * atlas.Size * (atlas.Layers - 1);
+	const bool smaller_layers = atlas.Layers == 1 && min_size < atlas.Size && used_area * 2 < (long long)atlas.Size * atlas.Size / 4;
+	if (fewer_layers || smaller_layers)
+	{
+		ImGui_ImplOvr_RepackCanvasAtlas();
+	}
+}
+
+/**
+ * @brief Places a panel's canvas in the canvas atlas at its current size, repacking the atlas if it doesn't fit.
+ * The canvas needs redrawing afterwards.
+ * 
+ * @param ctx The panel
+ */
+static void ImGui_ImplOvr_PlaceCanvas(ImGui_ImplOvr_Context* ctx)
+{
+	ImGui_ImplOvr_AtlasFree(&ctx->CanvasRect);
+	ctx->CanvasValid = false;
+	ctx->CanvasDrawn = false;
+	ctx->PrevCmdFingerprints.clear();
+
+	if (g_CanvasAtlas.Texture && ImGui_ImplOvr_AtlasAlloc(ctx->VirtualCanvasSize.x, ctx->VirtualCanvasSize.y, &ctx->CanvasRect))
+	{
+		ImGui_ImplOvr_AttachCanvas(ctx);
+		return;
+	}
+	ImGui_ImplOvr_RepackCanvasAtlas();
+}
+
+/**
+ * @brief Creates the FBO of a panel and places its virtual canvas in the canvas atlas.
+ * 
+ * @param ctx The panel
+ */
+static void ImGui_ImplOvr_CreateCanvas(ImGui_ImplOvr_Context* ctx)
+{
+	glGenFramebuffers(1, &ctx->GuiFBO);
+	ImGui_ImplOvr_PlaceCanvas(ctx);
+}
+
+/**
+ * @brief Destroys the FBO and layer swap chain of a panel, and frees its canvas in the canvas atlas.
+ * 
+ * @param ctx The panel
+ */
+static void ImGui_ImplOvr_DestroyCanvas(ImGui_ImplOvr_Context* ctx)
+{
+	ImGui_ImplOvr_AtlasFree(&ctx->CanvasRect);
+
+	if (ctx->GuiFBO) glDeleteFramebuffers(1, &ctx->GuiFBO);
+	ctx->GuiFBO = 0;
+
+	ImGui_ImplOvr_DestroyLayerSwapChain(ctx);
+	ctx->PrevCmdFingerprints.clear();
+	ctx->CanvasValid = false;
+	ctx->CanvasDrawn = false;
+}
+
+/**
+ * @brief Create an additional GUI panel with its own ImGui context and virtual canvas. The ImGui context shares
+ * the font atlas and copies the style of the default panel, and all GPU objects other than the canvas are shared.
+ * 
+ * Make a panel current with ImGui_ImplOvr_SetCurrentContext() before building and rendering its GUI.
+ * 
+ * @param canvasSize The size in pixels of the panel's virtual canvas
+ * @param model The model matrix of the panel's quad in the scene
+ * @return The new panel
+ */
+ImGui_ImplOvr_Context* ImGui_ImplOvr_CreateContext(glm::ivec2 canvasSize, glm::mat4 model)
+{
+	ImGuiContext* const shared = g_DefaultContext.ImGuiCtx;
+
+	ImGui_ImplOvr_Context* ctx = IM_NEW(ImGui_ImplOvr_Context)();
+	ctx->ImGuiCtx = ImGui::CreateContext(shared->IO.Fonts);
+	ctx->ImGuiCtx->Style = shared->Style;
+	ctx->ImGuiCtx->IO.ConfigFlags = shared->IO.ConfigFlags;
+	ctx->ImGuiCtx->IO.IniFilename = nullptr;
+	ctx->ModelMatrix = model;
+	ctx->VirtualCanvasSize = canvasSize;
+	ctx->PixelsPerUnit = g_DefaultContext.PixelsPerUnit;
+	g_Contexts.push_back(ctx);
+
+	// ImGui::CreateContext() makes the new context current if there wasn't one
+	if (g_Ctx->ImGuiCtx)
+	{
+		ImGui::SetCurrentContext(g_Ctx->ImGuiCtx);
+	}
+
+	if (g_FontTexture)
+	{
+		ImGui_ImplOvr_CreateCanvas(ctx);
+	}
+	return ctx;
+}
+
+/**
+ * @brief Destroy a panel created with ImGui_ImplOvr_CreateContext(), along with its ImGui context and canvas.
+ * If it's the current panel, the default panel becomes current.
+ * 
+ * @param ctx The panel to destroy
+ */
+void ImGui_ImplOvr_DestroyContext(ImGui_ImplOvr_Context* ctx)
+{
+	if (!ctx || ctx == &g_DefaultContext) return;
+
+	if (g_Ctx == ctx) ImGui_ImplOvr_SetCurrentContext(nullptr);
+	if (g_InputContext == ctx) g_InputContext = &g_DefaultContext;
+
+	for (int i = 0; i < g_Contexts.Size; i++)
+	{
+		if (g_Contexts[i] == ctx)
+		{
+			g_Contexts.erase(g_Contexts.begin() + i);
+			break;
+		}
+	}
+
+	ImGui_ImplOvr_DestroyCanvas(ctx);
+	ImGui_ImplOvr_CompactCanvasAtlas();
+	ImGui::DestroyContext(ctx->ImGuiCtx);
+	ImGui::SetCurrentContext(g_Ctx->ImGuiCtx);
+	IM_DELETE(ctx);
+}
+
+/**
+ * @brief Make a panel current, along with its ImGui context. ImGui_ImplOvr functions without a panel parameter,
+ * such as ImGui_ImplOvr_NewFrame() and ImGui_ImplOvr_RenderDrawData(), act on the current panel.
+ * 
+ * @param ctx The panel to make current, or nullptr for the default panel
+ */
+void ImGui_ImplOvr_SetCurrentContext(ImGui_ImplOvr_Context* ctx)
+{
+	g_Ctx = ctx ? ctx : &g_DefaultContext;
+	ImGui::SetCurrentContext(g_Ctx->ImGuiCtx);
+}
+
+/**
+ * @brief Get the current panel.
+ * 
+ * @return The current panel
+ */
+ImGui_ImplOvr_Context* ImGui_ImplOvr_GetCurrentContext()
+{
+	return g_Ctx;
+}
+
+/**
+ * @brief Move a panel's quad in the scene. Takes effect on hit testing and rendering from the next
+ * ImGui_ImplOvr_UpdatePointer().
+ * 
+ * @param ctx The panel
+ * @param model The model matrix of the panel's quad
+ */
+void ImGui_ImplOvr_SetContextModelMatrix(ImGui_ImplOvr_Context* ctx, glm::mat4 model)
+{
+	ctx->ModelMatrix = model;
+}
+
+/**
+ * @brief Update the controller pointer. Call this every HMD frame, even on frames where the GUI isn't
+ * updated (see ImGui_ImplOvr_SetGuiUpdateMode()), so the controller line and mouse position don't lag
+ * behind the controller. The pointer is tested against every panel at once.
+ * 
+ * @param guiModelMatrix The model matrix of the current panel's quad in the scene. Used for
+ * intersection calculations to determine mouse position.
+ */
+void ImGui_ImplOvr_UpdatePointer(glm::mat4 guiModelMatrix)
+{
+	IMGUI_OVR_PROFILE_SCOPE("ImGui_ImplOvr_UpdatePointer");
+	g_Ctx->ModelMatrix = guiModelMatrix;
+
+	if (ImGui_ImplOvr_GetDeviceSnapshot().Input.IndexTriggerRaw[g_OVRInputHand] > 0.5f)
+	{
+		g_MouseDownLatched = true;
+	}
+
+	ImGui_ImplOvr_UpdateMousePos();
+	g_PointerFrameIndex = *g_VRFrameIndex;
+}
+
+/**
+ * @brief Check whether the GUI update mode calls for a GUI update this HMD frame.
+ * 
+ * @return True if the GUI should be updated this frame
+ */
+static bool ImGui_ImplOvr_CheckGuiUpdate()
+{
+	// nothing on some panel's canvas to show in the meantime yet
+	for (int i = 0; i < g_Contexts.Size; i++)
+	{
+		if (!g_Contexts[i]->CanvasDrawn) return true;
+	}
+
+	switch (g_GuiUpdateMode)
+	{
+	case ImGuiVrGuiUpdateMode_FixedRate:
+	{
+		typedef std::chrono::steady_clock Clock;
+		const Clock::time_point now = Clock::now();
+		if (now < g_NextGuiTick) return false;
+
+		const Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / g_GuiUpdateRate));
+		g_NextGuiTick += period;
+
+		// don't try to catch up on ticks missed by a long stall
+		if (g_NextGuiTick < now)
+		{
+			g_NextGuiTick = now + period;
+		}
+		return true;
+	}
+	case ImGuiVrGuiUpdateMode_OnInput:
+	{
+		// hash everything that can affect the GUI: the pointer, controller buttons and keyboard
+		const ImGuiIO& io = g_InputContext->ImGuiCtx->IO;
+		const ovrInputState& in = ImGui_ImplOvr_GetDeviceSnapshot().Input;
+		const int mouse[2] = { (int)io.MousePos.x, (int)io.MousePos.y };
+		const unsigned int buttons[4] = { in.Buttons, (unsigned int)g_MouseDownLatched,
+			(unsigned int)(in.HandTriggerRaw[g_OVRInputHand] > 0.5f),
+			(unsigned int)(fabsf(in.ThumbstickNoDeadzone[g_OVRInputHand].x) > g_ThumbstickDeadzone) | ((unsigned int)(fabsf(in.ThumbstickNoDeadzone[g_OVRInputHand].y) > g_ThumbstickDeadzone) << 1) };
+		unsigned long long h = ImGui_ImplOvr_HashBytes(mouse, sizeof(mouse), 0);
+		h = ImGui_ImplOvr_HashBytes(buttons, sizeof(buttons), h);
+		h = ImGui_ImplOvr_HashBytes(io.KeysDown, sizeof(io.KeysDown), h);
+
+		// queued button events may hold changes the per-frame snapshot didn't see
+		if (h != g_LastGuiInputHash || io.InputCharacters[0] != 0 || !g_InputPoller.Queue.Empty())
+		{
+			g_LastGuiInputHash = h;
+			g_GuiSettleTicks = IMGUI_OVR_INPUT_SETTLE_TICKS;
+			return true;
+		}
+		if (g_GuiSettleTicks > 0)
+		{
+			g_GuiSettleTicks--;
+			return true;
+		}
+		return false;
+	}
+	default:
+		return true;
+	}
+}
+
+/**
+ * @brief Check whether the GUI should be updated this HMD frame, according to the GUI update mode. Call this
+ * once per HMD frame after ImGui_ImplOvr_UpdatePointer(); when it returns true, build the GUI and call
+ * ImGui_ImplOvr_RenderDrawData(), otherwise skip both and the last rasterized canvas is drawn again.
+ * 
+ * @return True if the GUI should be updated this frame
+ */
+bool ImGui_ImplOvr_ShouldUpdateGui()
+{
+	// replay updates the GUI on the same frames as the recording, whatever the clock says
+	if (g_DeviceReplay.IsOpen())
+	{
+		return g_DeviceReplay.ReadGuiTick();
+	}
+
+	const bool update = ImGui_ImplOvr_CheckGuiUpdate();
+	if (update && g_DeviceRecorder.IsOpen())
+	{
+		g_DeviceRecorder.WriteGuiTick();
+	}
+	return update;
+}
+
+/**
+ * @brief Estimates the fraction of a panel's virtual canvas size that matches the eye buffer pixels its quad covers,
+ * seen from the head pose of the current HMD frame: the longer of each pair of opposite edges, projected onto the
+ * eye's tangent plane.
+ * 
+ * @param ctx The panel
+ * @return The raster scale, 0 if the quad is behind the viewer and 1 if it's partly behind
+ */
+static float ImGui_ImplOvr_EstimateRasterScale(const ImGui_ImplOvr_Context* ctx)
+{
+	const ovrPosef head = ImGui_ImplOvr_GetDeviceSnapshot().Tracking.HeadPose.ThePose;
+	const glm::quat orientation = glm::quat(head.Orientation.w, head.Orientation.x, head.Orientation.y, head.Orientation.z);
+	const glm::mat4 view = glm::mat4_cast(glm::conjugate(orientation)) *
+		glm::translate(glm::mat4(1), -glm::vec3(head.Position.x, head.Position.y, head.Position.z));
+	const glm::mat4 model = view * ImGui_ImplOvr_PanelQuadMatrix(ctx, ctx->ModelMatrix);
+
+	// corners counter-clockwise from the bottom left, in eye buffer pixels
+	const glm::vec2 corners[4] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
+	glm::vec2 projected[4];
+	int behind = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		const glm::vec4 p = model * glm::vec4(corners[i], 0, 1);
+		if (p.z > -1e-3f)
+		{
+			behind++;
+			continue;
+		}
+		projected[i] = glm::vec2(p.x, p.y) / -p.z * g_EyePixelsPerTangent * g_EyeResolutionScale;
+	}
+	if (behind == 4) return 0.f;
+	if (behind > 0) return 1.f;
+
+	const float width = ImMax(glm::length(projected[1] - projected[0]), glm::length(projected[2] - projected[3]));
+	const float height = ImMax(glm::length(projected[3] - projected[0]), glm::length(projected[2] - projected[1]));
+	return ImMax(width / ctx->VirtualCanvasSize.x, height / ctx->VirtualCanvasSize.y);
+}
+
+/**
+ * @brief Updates the resolution a panel's canvas is rasterized at from its estimated size in the eye buffers. The
+ * scale goes up at once, so the panel is never blurry for long, but down only once the panel has needed a lower
+ * one for IMGUI_OVR_RASTER_SHRINK_TICKS GUI ticks, since every change redraws the whole canvas.
+ * 
+ * @param ctx The panel
+ */
+static void ImGui_ImplOvr_UpdateRasterScale(ImGui_ImplOvr_Context* ctx)
+{
+	float scale = 1.f;
+	if (g_AdaptiveCanvasResolution && g_EyePixelsPerTangent.x > 0.f)
+	{
+		scale = glm::ceil(ImGui_ImplOvr_EstimateRasterScale(ctx) / IMGUI_OVR_RASTER_SCALE_STEP) * IMGUI_OVR_RASTER_SCALE_STEP;
+		scale = glm::clamp(scale, g_MinRasterScale, 1.f);
+	}
+
+	if (scale >= ctx->RasterScale || ++ctx->RasterShrinkTicks >= IMGUI_OVR_RASTER_SHRINK_TICKS)
+	{
+		ctx->RasterScale = scale;
+		ctx->RasterShrinkTicks = 0;
+	}
+}
+
+/**
+ * @brief Begin a new frame with this renderer. Call this before you begin drawing
+ * ImGui elements, and before ImGui::NewFrame().
+ * 
+ * @param guiModelMatrix The model matrix of the quad to draw the GUI on in the scene. Used for
+ * intersection calculations to determine mouse position.
+ */
+void ImGui_ImplOvr_NewFrame(glm::mat4 guiModelMatrix)
+{
+	IMGUI_OVR_PROFILE_SCOPE("ImGui_ImplOvr_NewFrame");
+	ImGuiIO& io = ImGui::GetIO();
+
+	io.DisplaySize = ImVec2(g_Ctx->VirtualCanvasSize.x, g_Ctx->VirtualCanvasSize.y);
+
+	// every panel keeps its own time, as the platform binding only tracks one
+	typedef std::chrono::steady_clock Clock;
+	const Clock::time_point now = Clock::now();
+	if (g_Ctx->LastFrameTime != Clock::time_point())
+	{
+		io.DeltaTime = ImMax(std::chrono::duration<float>(now - g_Ctx->LastFrameTime).count(), 1e-5f);
+	}
+	g_Ctx->LastFrameTime = now;
+
+	if (!g_FontTexture)
+	{
+		ImGui_ImplOvr_CreateDeviceObjects();
+	}
+
+	// update mouse and gamepad, the pointer may already be up to date for this frame
+	g_Ctx->ModelMatrix = guiModelMatrix;
+
+	// ImGui keeps laying out in virtual canvas pixels, only the canvas is rasterized at a lower resolution
+	ImGui_ImplOvr_UpdateRasterScale(g_Ctx);
+	io.DisplayFramebufferScale = ImVec2(g_Ctx->RasterScale, g_Ctx->RasterScale);
+	if (g_PointerFrameIndex != *g_VRFrameIndex)
+	{
+		ImGui_ImplOvr_UpdatePointer(guiModelMatrix);
+	}
+	ImGui_ImplOvr_UpdateOculusTouchButtons();
+
+	// the input panel's pointer and buttons are what a replay must reproduce tick by tick
+	if (g_Ctx == g_InputContext && (g_DeviceRecorder.IsOpen() || g_DeviceReplay.IsOpen()))
+	{
+		unsigned long long h = ImGui_ImplOvr_HashBytes(&io.MousePos, sizeof(io.MousePos), 0);
+		h = ImGui_ImplOvr_HashBytes(io.NavInputs, sizeof(io.NavInputs), h);
+		if (g_DeviceReplay.IsOpen())
+		{
+			g_DeviceReplay.CheckTickHash(h);
+		}
+		else
+		{
+			g_DeviceRecorder.WriteTickHash(h);
+		}
+	}
+}
+
+/**
+ * @brief Call this every engine tick, will update internal state and do things
+ * like pulse the Touch controller if a UI element is hovered over.
+ */
+void ImGui_ImplOvr_Update()
+{
+	IMGUI_OVR_PROFILE_SCOPE("ImGui_ImplOvr_Update");
+	PulseIfItemHovered();
+
+	if (g_InputMode == ImGuiVrInputMode_Auto)
+	{
+		AutoDetectInputController();
+	}
+}
+
+/**
+ * @brief Set the size of the current panel's virtual GUI canvas in pixels. Can be changed at any time, the
+ * canvas is moved to a rectangle of the new size in the canvas atlas and redrawn on the next
+ * ImGui_ImplOvr_RenderDrawData().
+ * 
+ * @param size The size in pixels of the virtual canvas.
+ */
+void ImGui_ImplOvr_SetVirtualCanvasSize(glm::ivec2 size)
+{
+	if (g_Ctx->VirtualCanvasSize == size) return;
+
+	g_Ctx->VirtualCanvasSize = size;
+	if (g_Ctx->GuiFBO)
+	{
+		ImGui_ImplOvr_PlaceCanvas(g_Ctx);
+		ImGui_ImplOvr_CompactCanvasAtlas();
+	}
+}
+
+/**
+ * @brief Set the deadzone of the Oculus Touch thumbstick.
+ * 
+ * @param deadzone The deadzone.
+ */
+void ImGui_ImplOvr_SetThumbstickDeadzone(float deadzone)
+{
+	g_ThumbstickDeadzone = deadzone;
+	g_InputPoller.ThumbstickDeadzone = deadzone;
+}
+
+/**
+ * @brief Set the color of the line drawn from the Touch controller (indicating 'mouse' position on UI).
+ * 
+ * @param color RGB vector color to set
+ */
+void ImGui_ImplOvr_SetControllerLineColor(glm::vec3 color)
+{
+	g_LineColor = color;
+}
+
+/**
+ * @brief Set the pixels-per-unit (ppu) scale of the virtual canvas. Affects the rendered size of the
+ * GUI virtual canvas quad, which spans [-1, 1] scaled by the virtual canvas size divided by the ppu.
+ * 
  * For example: a PPU of 1000 with a virtual canvas size of 1500x500px would make a quad size of
- * 1.5x0.5 units.
+ * 3.0x1.0 units.
+ * 
+ * @param ppu The pixels-per-unit scale to set
+ */
+void ImGui_ImplOvr_SetPixelsPerUnit(float ppu)
+{
+	g_Ctx->PixelsPerUnit = ppu;
+}
+
+/**
+ * @brief Set which hand should be used for GUI input.
+ * 
+ * @note Will not do anything if the current input mode is not ImGuiVrInputMode_OneHand
+ * 
+ * @param hand The hand to use
+ */
+void ImGui_ImplOvr_SetInputHand(ovrHandType hand)
+{
+	if (g_InputMode != ImGuiVrInputMode_OneHand) return;
+	
+	g_OVRInputHand = hand;
+}
+
+/**
+ * @brief Set how often the GUI is rebuilt and rasterized, see ImGui_ImplOvr_ShouldUpdateGui(). Text and widgets
+ * rarely need the full HMD refresh rate, the GUI quad keeps being drawn every frame regardless.
+ * 
+ * @param mode The ImGuiVrGuiUpdateMode to use
+ * @param rate The GUI update rate in Hz, only used by ImGuiVrGuiUpdateMode_FixedRate
+ */
+void ImGui_ImplOvr_SetGuiUpdateMode(ImGuiVrGuiUpdateMode mode, float rate)
+{
+	g_GuiUpdateMode = mode;
+	if (rate > 0.f)
+	{
+		g_GuiUpdateRate = rate;
+	}
+	g_NextGuiTick = std::chrono::steady_clock::time_point();
+	g_GuiSettleTicks = 0;
+}
+
+/**
+ * @brief Set which input mode should be used currently
+ * 
+ * @param mode The ImGuiVrInputMode to use
+ */
+void ImGui_ImplOvr_SetInputMode(ImGuiVrInputMode mode)
+{
+	g_InputMode = mode;
+}
+
+/**
+ * @brief Share the application's per-frame device snapshot with the renderer, so the pointer and buttons are read
+ * from the same tracking and input state the application rendered the frame with, and the Oculus API isn't queried
+ * again. The snapshot must be captured before ImGui_ImplOvr_UpdatePointer() each HMD frame and stay valid until
+ * it's unset.
+ * 
+ * @note If no snapshot is shared, the renderer samples the device state itself once per HMD frame.
+ * 
+ * @param snapshot The application's device snapshot, or nullptr to sample the device state in the renderer
+ */
+void ImGui_ImplOvr_SetDeviceSnapshot(const ImGui_ImplOvr_DeviceSnapshot* snapshot)
+{
+	g_DeviceSnapshot = snapshot;
+}
+
+/**
+ * @brief Input source that samples the Touch controllers through the HMD backend.
+ * 
+ * @param userData The HmdBackend
+ * @param out_state Set to the input state
+ * @return True if the input state was read
+ */
+static bool ImGui_ImplOvr_HmdInputSource(void* userData, ovrInputState* out_state)
+{
+	return static_cast<HmdBackend*>(userData)->get_input_state(out_state);
+}
+
+/**
+ * @brief Set the input source the polling thread samples, e.g. ImGui_ImplOvr_ScriptedInput::Source to drive
+ * the GUI from a script. Takes effect the next time polling is started.
+ * 
+ * @param func The input source, or nullptr for the HMD backend
+ * @param userData Passed to the input source, must stay valid while polling
+ */
+void ImGui_ImplOvr_SetInputSource(ImGui_ImplOvr_InputSourceFunc func, void* userData)
+{
+	g_InputSourceFunc = func;
+	g_InputSourceUserData = userData;
+}
+
+/**
+ * @brief Start sampling Touch buttons, triggers and thumbsticks on a separate thread, much faster than the HMD
+ * frame rate. Each change is queued and replayed into ImGui in order on the following GUI frames, so presses
+ * shorter than a frame or a GUI tick still register as clicks.
+ * 
+ * @note The pointer position is still updated once per HMD frame from the device snapshot.
+ * 
+ * @param rate How many times a second to sample the input source, e.g. 500
+ * @return True if polling is running
+ */
+bool ImGui_ImplOvr_StartInputPolling(float rate)
+{
+	g_InputPoller.ThumbstickDeadzone = g_ThumbstickDeadzone;
+	if (g_InputSourceFunc)
+	{
+		return g_InputPoller.Start(g_InputSourceFunc, g_InputSourceUserData, rate);
+	}
+	return g_InputPoller.Start(ImGui_ImplOvr_HmdInputSource, g_Hmd, rate);
+}
+
+/**
+ * @brief Stop the input polling thread. Buttons are read from the device snapshot again once the events it
+ * already queued have been replayed.
+ */
+void ImGui_ImplOvr_StopInputPolling()
+{
+	g_InputPoller.Stop();
+}
+
+/**
+ * @brief Start recording the device state the renderer consumes to a file: each frame's device snapshot, which
+ * frames the GUI was updated in, the polled input events of each GUI tick and a hash of the input each GUI tick
+ * ended up with. Replaying the recording with ImGui_ImplOvr_StartReplay() reproduces the same pointer and button
+ * input, frame by frame, and ImGui_ImplOvr_GetReplayMismatches() counts the ticks where it didn't.
+ * 
+ * @note Only snapshots captured with ImGui_ImplOvr_CaptureDeviceSnapshot() are recorded.
+ * 
+ * @param path The file to record to, replaced if it exists
+ * @return True if recording started
+ */
+bool ImGui_ImplOvr_StartRecording(const char* path)
+{
+	return g_DeviceRecorder.Open(path);
+}
+
+/**
+ * @brief Stop recording and close the recording's file.
+ */
+void ImGui_ImplOvr_StopRecording()
+{
+	g_DeviceRecorder.Close();
+}
+
+/**
+ * @brief Replay a recording made with ImGui_ImplOvr_StartRecording() in place of the Oculus SDK's tracking and
+ * input state. The recording is streamed from disk a frame at a time. Input polling is stopped, as the recorded
+ * input events are replayed instead. Once the recording runs out, the live device state is used again.
+ * 
+ * @param path The recording
+ * @return True if the replay started
+ */
+bool ImGui_ImplOvr_StartReplay(const char* path)
+{
+	if (!g_DeviceReplay.Open(path)) return false;
+
+	ImGui_ImplOvr_StopInputPolling();
+	while (!g_InputPoller.Queue.Empty())
+	{
+		g_InputPoller.Queue.Pop();
+	}
+	g_PolledButtons = 0;
+	return true;
+}
+
+/**
+ * @brief Stop replaying and go back to the live device state.
+ */
+void ImGui_ImplOvr_StopReplay()
+{
+	g_DeviceReplay.Close();
+}
+
+/**
+ * @brief Check whether a recording is being replayed, e.g. to exit once it runs out.
+ * 
+ * @return True while replaying
+ */
+bool ImGui_ImplOvr_IsReplaying()
+{
+	return g_DeviceReplay.IsOpen();
+}
+
+/**
+ * @brief Get how many GUI ticks of the last replay had different pointer or button input than when they were
+ * recorded, e.g. because the application placed its panels differently. Each GUI tick's hash of the input panel's
+ * io.MousePos and io.NavInputs is compared with the recording's.
+ * 
+ * @param out_ticksChecked Set to how many GUI ticks were compared, can be nullptr
+ * @return The number of GUI ticks that diverged from the recording
+ */
+unsigned long long ImGui_ImplOvr_GetReplayMismatches(unsigned long long* out_ticksChecked)
+{
+	if (out_ticksChecked)
+	{
+		*out_ticksChecked = g_DeviceReplay.TicksChecked;
+	}
+	return g_DeviceReplay.Mismatches;
+}
+
+/**
+ * @brief Set the function used to identify the current GL context. VAOs are cached per GL context, so if you
+ * render the GUI from more than one GL context you must set this, e.g. to a function returning glfwGetCurrentContext().
+ * 
+ * @note If this is not set, only one GL context is assumed to be used.
+ * 
+ * @param func Function returning a pointer that uniquely identifies the current GL context
+ */
+void ImGui_ImplOvr_SetCurrentContextFunc(void* (*func)())
+{
+	g_GetCurrentContextFunc = func;
+}
+
+/**
+ * @brief Set how ImGui vertex and index data is uploaded to the GPU.
+ * 
+ * @note ImGuiVrUploadMode_PersistentRing falls back to ImGuiVrUploadMode_Orphan on contexts
+ * without ARB_buffer_storage.
+ * 
+ * @param mode The ImGuiVrUploadMode to use
+ */
+void ImGui_ImplOvr_SetUploadMode(ImGuiVrUploadMode mode)
+{
+	g_UploadMode = mode;
+}
+
+/**
+ * @brief Set whether all ImGui draw lists are uploaded as one contiguous block per frame and drawn
+ * with glDrawElementsBaseVertex, rather than uploading and rebinding each draw list separately.
  * 
- * @param ppu The pixels-per-unit scale to set
+ * @param merge True to merge draw lists (default), false to upload them one by one
  */
-void ImGui_ImplOvr_SetPixelsPerUnit(float ppu)
+void ImGui_ImplOvr_SetMergeDrawLists(bool merge)
 {
-	g_PixelsPerUnit = ppu;
+	g_MergeDrawLists = merge;
 }
 
 /**
- * @brief Set which hand should be used for GUI input.
+ * @brief Declare whether the host engine owns the GL state. If it does, the renderer won't back up and
+ * restore GL state around its draws (saving the glGet* queries), and will leave whatever state it set behind.
  * 
- * @note Will not do anything if the current input mode is not ImGuiVrInputMode_OneHand
+ * @note When the engine owns GL state, call ImGui_ImplOvr_InvalidateGLState() whenever you change GL state
+ * yourself, so the renderer doesn't skip state changes it thinks are redundant.
  * 
- * @param hand The hand to use
+ * @param owns True if the engine owns the GL state, false to have the renderer preserve it (default)
  */
-void ImGui_ImplOvr_SetInputHand(ovrHandType hand)
+void ImGui_ImplOvr_SetEngineOwnsGLState(bool owns)
+{
+	g_EngineOwnsGLState = owns;
+	g_GLState.Known = 0;
+}
+
+/**
+ * @brief Forget the renderer's shadow copy of the GL state, so every state change is made the next time it
+ * draws. Only needed when the engine owns the GL state, see ImGui_ImplOvr_SetEngineOwnsGLState().
+ */
+void ImGui_ImplOvr_InvalidateGLState()
+{
+	g_GLState.Known = 0;
+}
+
+/**
+ * @brief Get the number of GL state changes made, skipped as redundant, and GL state queries made
+ * since the last call to ImGui_ImplOvr_ResetStateStats().
+ * 
+ * @param out_stats Where to write the statistics to
+ */
+void ImGui_ImplOvr_GetStateStats(ImGui_ImplOvr_StateStats* out_stats)
+{
+	if (out_stats) *out_stats = g_StateStats;
+}
+
+/**
+ * @brief Reset the counters returned by ImGui_ImplOvr_GetStateStats() to zero.
+ */
+void ImGui_ImplOvr_ResetStateStats()
+{
+	g_StateStats = ImGui_ImplOvr_StateStats();
+}
+
+/**
+ * @brief Set whether the virtual canvas is only re-rasterized when the GUI changes. When enabled, the draw data
+ * is hashed each frame and if it matches the last rendered frame the canvas is left untouched. Frames with user
+ * callbacks or commands sampling a texture other than the font atlas (ImGui::Image()) are always redrawn, as the
+ * hash can't tell whether what they draw has changed.
+ * 
+ * @param enable True to reuse the canvas when the GUI is unchanged (default), false to redraw it every frame
+ */
+void ImGui_ImplOvr_SetCanvasCaching(bool enable)
+{
+	g_CanvasCaching = enable;
+	for (int i = 0; i < g_Contexts.Size; i++)
+	{
+		g_Contexts[i]->CanvasValid = false;
+	}
+}
+
+/**
+ * @brief Set whether the font atlas is uploaded as a single channel texture. Call this before ImGui_ImplOvr_Init()
+ * for it to have any effect. Large fonts, or fonts with many glyph ranges, make the atlas big enough for the
+ * 4x saving over RGBA32 to matter.
+ * 
+ * @param enable True to upload an 8-bit alpha atlas (default), false to upload RGBA32
+ */
+void ImGui_ImplOvr_SetAlpha8FontAtlas(bool enable)
+{
+	g_Alpha8FontAtlas = enable;
+}
+
+/**
+ * @brief Set whether the font atlas holds signed distance fields of the glyphs. Call this before ImGui_ImplOvr_Init(),
+ * and before the font atlas is built, for it to have any effect.
+ * 
+ * This saves atlas memory: fonts can be loaded once at a small size and scaled up with io.FontGlobalScale, and text is
+ * still rasterized into the canvas with sharp edges, where a scaled coverage atlas would be blurred. The distance field
+ * is resolved at canvas resolution though, and the canvas is then resampled into the eye buffers like any texture, so
+ * text is no more legible in the HMD than with a coverage atlas baked at the drawn size, and needs as big a canvas.
+ * `imgui-ovr-bench fonts` compares the atlas memory and the canvas size needed for the same legibility.
+ * Solid shapes and user textures draw as before.
+ * 
+ * @param enable True to build a distance field atlas, false to build a coverage atlas (default)
+ * @param spread The distance in atlas pixels the field covers on either side of glyph edges. Glyphs are padded by this much.
+ */
+void ImGui_ImplOvr_SetSdfFontAtlas(bool enable, float spread)
+{
+	g_SdfFontAtlas = enable;
+	if (spread > 0.f)
+	{
+		g_SdfSpread = spread;
+	}
+}
+
+/**
+ * @brief Get the size and build time of the font atlas texture, to compare atlas formats.
+ * 
+ * @param out_stats Where to write the statistics
+ */
+void ImGui_ImplOvr_GetFontAtlasStats(ImGui_ImplOvr_FontAtlasStats* out_stats)
+{
+	*out_stats = g_FontAtlasStats;
+}
+
+/**
+ * @brief Get how full the canvas atlas the panel canvases are packed into is, and how often it was repacked.
+ * 
+ * @param out_stats Where to write the statistics
+ */
+void ImGui_ImplOvr_GetCanvasAtlasStats(ImGui_ImplOvr_CanvasAtlasStats* out_stats)
+{
+	const ImGui_ImplOvr_CanvasAtlas& atlas = g_CanvasAtlas;
+	out_stats->LayerSize = atlas.Size;
+	out_stats->Layers = atlas.Layers;
+	out_stats->Panels = 0;
+	out_stats->Defragmentations = atlas.Defragmentations;
+
+	long long used_area = 0;
+	for (int i = 0; i < g_Contexts.Size; i++)
+	{
+		const ImGui_ImplOvr_AtlasRect& rect = g_Contexts[i]->CanvasRect;
+		if (rect.Layer < 0) continue;
+		used_area += (long long)rect.W * rect.H;
+		out_stats->Panels++;
+	}
+	const long long total_area = (long long)atlas.Size * atlas.Size * atlas.Layers;
+	out_stats->Occupancy = total_area > 0 ? (float)((double)used_area / (double)total_area) : 0.0f;
+}
+
+/**
+ * @brief Get how often the input polling thread sampled the input source and queued changes, and the sampling rate
+ * it achieved against the one asked for.
+ * 
+ * @param out_stats Where to write the statistics
+ */
+void ImGui_ImplOvr_GetInputPollingStats(ImGui_ImplOvr_InputPollingStats* out_stats)
+{
+	out_stats->Samples = g_InputPoller.Samples;
+	out_stats->Events = g_InputPoller.Events;
+	out_stats->EventsDropped = g_InputPoller.EventsDropped;
+	out_stats->TargetRate = g_InputPoller.TargetRate;
+	out_stats->AchievedRate = g_InputPoller.AchievedRate;
+	out_stats->Running = g_InputPoller.IsRunning();
+}
+
+/**
+ * @brief Set whether GPU phases are timed with timer queries and wrapped in KHR_debug groups. Takes effect from the
+ * next HMD frame.
+ * 
+ * @param enable True to time GPU phases (default), false to issue no queries or debug groups
+ */
+void ImGui_ImplOvr_SetGpuTiming(bool enable)
+{
+	g_GpuTiming = enable;
+}
+
+/**
+ * @brief Start timing a phase of the current HMD frame on the GPU, and push a debug group named after it so GPU
+ * captures show it. The renderer times its own passes, call this around the app's own, e.g. each eye pass.
+ * Phases may nest, and phases with the same name in a frame are summed.
+ * 
+ * @param name The name of the phase. Must be a string literal, or otherwise outlive the renderer.
+ * @return The phase, to pass to ImGui_ImplOvr_EndGpuPhase()
+ */
+int ImGui_ImplOvr_BeginGpuPhase(const char* name)
+{
+	if (!g_GpuTimer.IsCreated()) return -1;
+	g_GpuTimer.BeginFrame(*g_VRFrameIndex, g_GpuTiming);
+	return g_GpuTimer.Begin(name);
+}
+
+/**
+ * @brief End a phase started with ImGui_ImplOvr_BeginGpuPhase() and pop its debug group.
+ * 
+ * @param phase The phase returned by ImGui_ImplOvr_BeginGpuPhase()
+ */
+void ImGui_ImplOvr_EndGpuPhase(int phase)
+{
+	g_GpuTimer.End(phase);
+}
+
+/**
+ * @brief Get the GPU time of each phase of a recent HMD frame. Results are read back IMGUI_OVR_GPU_TIMER_FRAMES
+ * frames late so the CPU never waits on the GPU; a frame the GPU hadn't finished by then is skipped.
+ * 
+ * @param out_timings Where to write the timings, one per phase name in the order they were first issued
+ * @param maxTimings The number of timings out_timings has room for
+ * @param out_frameIndex Where to write the HMD frame index the timings are of, -1 if there are none yet. May be nullptr.
+ * @return The number of timings written
+ */
+int ImGui_ImplOvr_GetGpuTimings(ImGui_ImplOvr_GpuTiming* out_timings, int maxTimings, long long* out_frameIndex)
+{
+	const int count = g_GpuTimer.TimingCount < maxTimings ? g_GpuTimer.TimingCount : maxTimings;
+	for (int i = 0; i < count; i++)
+	{
+		out_timings[i] = g_GpuTimer.Timings[i];
+	}
+	if (out_frameIndex) *out_frameIndex = g_GpuTimer.TimingFrameIndex;
+	return count;
+}
+
+/**
+ * @brief Set whether CPU profiler scopes are recorded. The renderer's entry points, the input polling thread and
+ * whatever the app wraps in IMGUI_OVR_PROFILE_SCOPE() are recorded, each thread into its own ring buffer holding
+ * the latest IMGUI_OVR_PROFILE_RING_SIZE events. A disabled scope costs a single relaxed atomic load.
+ * 
+ * @param enable True to record scopes, false to stop (default)
+ */
+void ImGui_ImplOvr_SetProfiling(bool enable)
+{
+	g_ProfileEnabled = enable;
+	if (!enable)
+	{
+		g_ProfileFrameStart = 0;
+	}
+}
+
+/**
+ * @brief Name the calling thread in exported traces, e.g. "main".
+ * 
+ * @param name The name. Must be a string literal, or otherwise outlive the thread.
+ */
+void ImGui_ImplOvr_SetProfileThreadName(const char* name)
+{
+	ImGui_ImplOvr_ProfileSetThreadName(name);
+}
+
+/**
+ * @brief Write the CPU profiler events still held by every thread's ring buffer as a Chrome trace, for
+ * chrome://tracing or https://ui.perfetto.dev.
+ * 
+ * @param path The path of the trace
+ * @param seconds Only write events that ended this many seconds ago or later, 0 for every event held
+ * @return True if the trace was written
+ */
+bool ImGui_ImplOvr_WriteProfileTrace(const char* path, float seconds)
+{
+	const unsigned long long now = ImGui_ImplOvr_ProfileNow();
+	const unsigned long long window = (unsigned long long)(seconds * 1e9);
+	return ImGui_ImplOvr_ProfileWriteTrace(path, seconds > 0.f && now > window ? now - window : 0);
+}
+
+/**
+ * @brief Start writing CPU profiler events to a Chrome trace as they're recorded, on each call to
+ * ImGui_ImplOvr_EndProfileFrame(). Turns profiling on. The trace is complete once ImGui_ImplOvr_StopProfileStream()
+ * is called, but can be loaded before then: trace viewers accept a trace event array without its closing bracket.
+ * 
+ * @param path The path of the trace
+ * @return True if the trace was created
+ */
+bool ImGui_ImplOvr_StartProfileStream(const char* path)
+{
+	ImGui_ImplOvr_StopProfileStream();
+
+	g_ProfileStream = fopen(path, "w");
+	if (!g_ProfileStream)
+	{
+		fprintf(stderr, "ERROR: ImGui_ImplOvr_StartProfileStream: can't create %s\n", path);
+		return false;
+	}
+
+	// only events recorded from now on, and the thread names once the threads have had a chance to record
+	g_ProfileStreamCursor = ImGui_ImplOvr_ProfileCursor();
+	std::vector<ImGui_ImplOvr_ProfileEvent> skipped;
+	ImGui_ImplOvr_ProfileCollectNew(&g_ProfileStreamCursor, &skipped);
+	g_ProfileStreamCursor.Lost = 0;
+	g_ProfileEventsLost = 0;
+	g_ProfileStreamFirst = true;
+	fprintf(g_ProfileStream, "[");
+	g_ProfileStreaming = true;
+
+	ImGui_ImplOvr_SetProfiling(true);
+	return true;
+}
+
+/**
+ * @brief Write the events recorded since the last call to the profile stream. Runs on g_ProfileWriter's thread.
+ */
+static void ImGui_ImplOvr_WriteProfileStreamEvents()
+{
+	std::vector<ImGui_ImplOvr_ProfileEvent> events;
+	ImGui_ImplOvr_ProfileCollectNew(&g_ProfileStreamCursor, &events);
+	ImGui_ImplOvr_ProfileWriteEvents(g_ProfileStream, events, &g_ProfileStreamFirst);
+	g_ProfileEventsLost = g_ProfileStreamCursor.Lost;
+}
+
+/**
+ * @brief Write any events not streamed yet and close the trace started by ImGui_ImplOvr_StartProfileStream(). Waits
+ * for the trace writes already queued, including the flight recorder's. Profiling stays on.
+ */
+void ImGui_ImplOvr_StopProfileStream()
+{
+	if (!g_ProfileStreaming) return;
+
+	g_ProfileWriter.Queue([]
+	{
+		ImGui_ImplOvr_WriteProfileStreamEvents();
+		ImGui_ImplOvr_ProfileWriteThreadNames(g_ProfileStream, &g_ProfileStreamFirst);
+		fprintf(g_ProfileStream, "\n]\n");
+
+		fclose(g_ProfileStream);
+		g_ProfileStream = nullptr;
+	});
+	g_ProfileWriter.Flush();
+	g_ProfileStreaming = false;
+}
+
+/**
+ * @brief Set up the flight recorder: when a frame takes longer than the budget, the last few seconds of CPU
+ * profiler events are written to "<pathPrefix>-<frame index>.json", so the cause of a missed frame can be seen after
+ * the fact. Once a trace is written, the next one is only written when its window no longer overlaps it. Traces are
+ * written on a thread of their own, so the frame that triggers one isn't held up further. Turns profiling on.
+ * 
+ * @param pathPrefix Where to write the traces to, nullptr to turn the flight recorder off
+ * @param budgetMs The frame budget, e.g. 1000 / the HMD refresh rate
+ * @param seconds How many seconds of events each trace holds, up to what the ring buffers hold
+ */
+void ImGui_ImplOvr_SetFlightRecorder(const char* pathPrefix, float budgetMs, float seconds)
+{
+	g_FlightRecorderPrefix = pathPrefix ? pathPrefix : "";
+	g_FrameBudgetMs = budgetMs;
+	g_FlightRecorderSeconds = seconds;
+	g_LastFlightRecording = 0;
+
+	if (pathPrefix)
+	{
+		ImGui_ImplOvr_SetProfiling(true);
+	}
+}
+
+/**
+ * @brief Mark the end of a frame for the CPU profiler. Call this once per HMD frame, at the end of the frame loop.
+ * Records the whole frame as a "frame" event, streams new events if a stream was started, and runs the flight
+ * recorder if the frame went over its budget. Both only queue their writes, which happen on another thread.
+ */
+void ImGui_ImplOvr_EndProfileFrame()
+{
+	if (!g_ProfileEnabled) return;
+
+	const unsigned long long now = ImGui_ImplOvr_ProfileNow();
+	if (g_ProfileFrameStart)
+	{
+		ImGui_ImplOvr_ProfileRecord("frame", g_ProfileFrameStart, now);
+		g_ProfilerStats.Frames++;
+		g_ProfilerStats.LastFrameMs = (now - g_ProfileFrameStart) / 1e6;
+
+		if (g_FrameBudgetMs > 0.f && g_ProfilerStats.LastFrameMs > g_FrameBudgetMs)
+		{
+			g_ProfilerStats.FramesOverBudget++;
+
+			const unsigned long long window = (unsigned long long)(g_FlightRecorderSeconds * 1e9);
+			if (!g_FlightRecorderPrefix.empty() && (!g_LastFlightRecording || now - g_LastFlightRecording >= window))
+			{
+				const std::string path = g_FlightRecorderPrefix + "-" + std::to_string(g_VRFrameIndex ? *g_VRFrameIndex : 0) + ".json";
+				const unsigned long long since = now > window ? now - window : 0;
+				g_ProfileWriter.Queue([path, since]
+				{
+					if (ImGui_ImplOvr_ProfileWriteTrace(path.c_str(), since))
+					{
+						g_FlightRecordingsWritten++;
+					}
+				});
+				g_LastFlightRecording = now;
+			}
+		}
+	}
+
+	if (g_ProfileStreaming)
+	{
+		g_ProfileWriter.Queue(ImGui_ImplOvr_WriteProfileStreamEvents);
+	}
+
+	// time spent queueing writes above counts towards the next frame, it's time the loop really spent
+	g_ProfileFrameStart = now;
+}
+
+/**
+ * @brief Poll the compositor's stats of the frames it showed since the last poll and add them to the history. Call
+ * this once per HMD frame after submitting it, the runtime only keeps the last few frames between polls.
+ */
+void ImGui_ImplOvr_PollPerfStats()
+{
+	IMGUI_OVR_PROFILE_SCOPE("ImGui_ImplOvr_PollPerfStats");
+	ovrPerfStats stats;
+	if (g_Hmd->get_perf_stats(&stats))
+	{
+		g_PerfStats.Add(*g_VRFrameIndex, stats);
+	}
+}
+
+/**
+ * @brief Forget the perf stats history.
+ */
+void ImGui_ImplOvr_ResetPerfStats()
+{
+	g_PerfStats.Clear();
+}
+
+/**
+ * @brief Get the compositor's view of the frames in the perf stats history: dropped frames, ASW and percentiles of
+ * the app's and the compositor's timings.
+ * 
+ * @param out_summary Where to write the summary
+ */
+void ImGui_ImplOvr_GetPerfStatsSummary(ImGui_ImplOvr_PerfStatsSummary* out_summary)
+{
+	g_PerfStats.Summarize(out_summary);
+}
+
+/**
+ * @brief Get the compositor's stats of the frame that showed a given HMD frame, e.g. to line them up with the CPU
+ * profiler's or the GPU timer's results for the same frame.
+ * 
+ * @param frameIndex The HMD frame index
+ * @param out_stats Where to write the stats
+ * @return False if the frame isn't in the history, it was never shown or has been dropped from the history
+ */
+bool ImGui_ImplOvr_GetPerfStatsOfFrame(long long frameIndex, ovrPerfStatsPerCompositorFrame* out_stats)
+{
+	const ImGui_ImplOvr_PerfStatsHistory::Entry* entry = g_PerfStats.Find(frameIndex);
+	if (!entry) return false;
+
+	*out_stats = entry->Stats;
+	return true;
+}
+
+/**
+ * @brief Draw a row of percentiles for ImGui_ImplOvr_ShowPerfStatsWindow().
+ * 
+ * @param label The name of the timing
+ * @param percentiles Its percentiles
+ */
+static void ImGui_ImplOvr_PerfStatsRow(const char* label, const ImGui_ImplOvr_PerfStatsPercentiles& percentiles)
+{
+	ImGui::Text("%s", label); ImGui::NextColumn();
+	ImGui::Text("%.2f", percentiles.P50); ImGui::NextColumn();
+	ImGui::Text("%.2f", percentiles.P90); ImGui::NextColumn();
+	ImGui::Text("%.2f", percentiles.P99); ImGui::NextColumn();
+	ImGui::Text("%.2f", percentiles.Max); ImGui::NextColumn();
+}
+
+/**
+ * @brief Show a window with the compositor's perf stats next to the renderer's own timings: the CPU profiler's frame
+ * time and the GPU time of each phase. Call this between ImGui::NewFrame() and ImGui::Render(), like
+ * ImGui::ShowMetricsWindow().
+ * 
+ * @param p_open Set to false when the window is closed, nullptr for no close button
+ */
+void ImGui_ImplOvr_ShowPerfStatsWindow(bool* p_open)
+{
+	if (!ImGui::Begin("Performance", p_open))
+	{
+		ImGui::End();
+		return;
+	}
+
+	ImGui_ImplOvr_PerfStatsSummary summary;
+	g_PerfStats.Summarize(&summary);
+	ImGui::Text("Compositor, last %d frames (%lld to %lld)", summary.Frames, summary.FirstFrameIndex, summary.LastFrameIndex);
+	ImGui::Text("Dropped: %d by the app, %d by the compositor", summary.AppDroppedFrames, summary.CompositorDroppedFrames);
+	if (summary.AswIsAvailable)
+	{
+		ImGui::Text("ASW: active %d frames, %d presented, %d failed, %d toggles", summary.AswFrames, summary.AswPresentedFrames,
+			summary.AswFailedFrames, summary.AswActivations);
+	}
+	ImGui::Text("Adaptive GPU performance scale: %.2f", summary.AdaptiveGpuPerformanceScale);
+
+	ImGui::Columns(5, "perf_stats");
+	ImGui::Separator();
+	ImGui::Text("ms"); ImGui::NextColumn();
+	ImGui::Text("p50"); ImGui::NextColumn();
+	ImGui::Text("p90"); ImGui::NextColumn();
+	ImGui::Text("p99"); ImGui::NextColumn();
+	ImGui::Text("max"); ImGui::NextColumn();
+	ImGui::Separator();
+	ImGui_ImplOvr_PerfStatsRow("App CPU", summary.AppCpu);
+	ImGui_ImplOvr_PerfStatsRow("App GPU", summary.AppGpu);
+	ImGui_ImplOvr_PerfStatsRow("Motion to photon", summary.AppMotionToPhoton);
+	ImGui_ImplOvr_PerfStatsRow("Queue ahead", summary.AppQueueAhead);
+	ImGui_ImplOvr_PerfStatsRow("Compositor CPU", summary.CompositorCpu);
+	ImGui_ImplOvr_PerfStatsRow("Compositor GPU", summary.CompositorGpu);
+	ImGui_ImplOvr_PerfStatsRow("Compositor latency", summary.CompositorLatency);
+	ImGui::Columns(1);
+	ImGui::Separator();
+
+	if (g_ProfileEnabled)
+	{
+		ImGui::Text("CPU frame: %.2f ms, %llu of %llu frames over budget", g_ProfilerStats.LastFrameMs,
+			g_ProfilerStats.FramesOverBudget, g_ProfilerStats.Frames);
+	}
+
+	if (g_GpuTimer.TimingCount > 0)
+	{
+		ImGui::Text("GPU, frame %lld", g_GpuTimer.TimingFrameIndex);
+		for (int i = 0; i < g_GpuTimer.TimingCount; i++)
+		{
+			const ImGui_ImplOvr_GpuTiming& timing = g_GpuTimer.Timings[i];
+			ImGui::BulletText("%s: %.3f ms", timing.Name, timing.Milliseconds);
+		}
+	}
+
+	ImGui::End();
+}
+
+/**
+ * @brief Get how many frames the CPU profiler saw go over budget and how many traces the flight recorder wrote.
+ * 
+ * @param out_stats Where to write the statistics
+ */
+void ImGui_ImplOvr_GetProfilerStats(ImGui_ImplOvr_ProfilerStats* out_stats)
+{
+	*out_stats = g_ProfilerStats;
+	out_stats->FlightRecordings = g_FlightRecordingsWritten;
+	out_stats->EventsLost = g_ProfileEventsLost;
+}
+
+/**
+ * @brief Set whether only the changed regions of the virtual canvas are redrawn. When enabled, each draw command
+ * is compared against the last drawn frame and only the rectangles covered by changed commands are cleared and
+ * redrawn, saving fill rate on large, mostly idle canvases. Commands sampling a texture other than the font atlas
+ * are redrawn every frame, since their texture may have changed.
+ * 
+ * @note Partial redraws need draw lists to be merged, see ImGui_ImplOvr_SetMergeDrawLists().
+ * 
+ * @param enable True to redraw only changed regions (default), false to redraw the whole canvas
+ */
+void ImGui_ImplOvr_SetDamageTracking(bool enable)
+{
+	g_DamageTracking = enable;
+	for (int i = 0; i < g_Contexts.Size; i++)
+	{
+		g_Contexts[i]->PrevCmdFingerprints.resize(0);
+	}
+}
+
+/**
+ * @brief Set whether each panel's canvas is rasterized at the resolution it's seen at. When enabled, the eye
+ * buffer pixels the panel's quad covers are estimated every frame from its model matrix, pixels-per-unit and the
+ * HMD's field of view, and the canvas is drawn at that fraction of its virtual canvas size with mipmaps, so distant
+ * or glancing panels cost less fill rate and don't alias. ImGui's coordinates are unaffected.
+ * 
+ * @param enable True to adapt the canvas resolution (default), false to always rasterize at the virtual canvas size
+ * @param minScale The lowest fraction of the virtual canvas size to rasterize at, in (0, 1]. 0 keeps the current one.
+ */
+void ImGui_ImplOvr_SetAdaptiveCanvasResolution(bool enable, float minScale)
+{
+	g_AdaptiveCanvasResolution = enable;
+	if (minScale > 0.f)
+	{
+		g_MinRasterScale = ImMin(minScale, 1.f);
+	}
+}
+
+/**
+ * @brief Set the resolution the eye buffers are currently rendered at, relative to the HMD's recommended one (the
+ * pixelsPerDisplayPixel passed to ovr_GetFovTextureSize()). Call this every frame if the application scales its
+ * eye buffers dynamically, so adaptive canvas resolution rasterizes panels no sharper than the eyes they're seen in.
+ * 
+ * @param scale The eye buffers' resolution scale, 1 by default
+ */
+void ImGui_ImplOvr_SetEyeResolutionScale(float scale)
+{
+	if (scale > 0.f)
+	{
+		g_EyeResolutionScale = scale;
+	}
+}
+
+/**
+ * @brief Get statistics on how often the current panel's virtual canvas was reused instead of redrawn. The hit
+ * rate is CacheHits / Frames.
+ * 
+ * @param out_stats Where to write the statistics to
+ */
+void ImGui_ImplOvr_GetCanvasStats(ImGui_ImplOvr_CanvasStats* out_stats)
+{
+	if (out_stats) *out_stats = g_Ctx->CanvasStats;
+}
+
+/**
+ * @brief Reset the counters returned by ImGui_ImplOvr_GetCanvasStats() for the current panel to zero.
+ */
+void ImGui_ImplOvr_ResetCanvasStats()
 {
-	if (g_InputMode != ImGuiVrInputMode_OneHand) return;
-	
-	g_OVRInputHand = hand;
+	g_Ctx->CanvasStats = ImGui_ImplOvr_CanvasStats();
 }
 
 /**
- * @brief Set which input mode should be used currently
+ * @brief Get statistics about the current panel's last vertex and index uploads. Useful for comparing
+ * the cost of the different ImGuiVrUploadMode methods.
  * 
- * @param mode The ImGuiVrInputMode to use
+ * @param out_stats Where to write the statistics to
  */
-void ImGui_ImplOvr_SetInputMode(ImGuiVrInputMode mode)
+void ImGui_ImplOvr_GetUploadStats(ImGui_ImplOvr_UploadStats* out_stats)
 {
-	g_InputMode = mode;
+	if (out_stats) *out_stats = g_Ctx->UploadStats;
 }
 
 /**
@@ -525,27 +3437,65 @@ void ImGui_ImplOvr_SetInputMode(ImGuiVrInputMode mode)
  */
 bool ImGui_ImplOvr_CreateFontsTexture()
 {
+	typedef std::chrono::high_resolution_clock Clock;
+	const Clock::time_point build_start = Clock::now();
+
 	// Build texture atlas
 	ImGuiIO& io = ImGui::GetIO();
 	unsigned char* pixels;
 	int width, height;
-	io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);   // Load as RGBA 32-bits (75% of the memory is wasted, but default font is so small) because it is more likely to be compatible with user's existing shaders. If your ImTextureId represent a higher-level concept than just a GL texture id, consider calling GetTexDataAsAlpha8() instead to save on GPU memory.
+	const bool sdf = g_SdfFontAtlas;
+	if (sdf && !io.Fonts->TexPixelsAlpha8 && !io.Fonts->TexPixelsRGBA32)
+	{
+		// the distance field of a glyph spreads beyond its edges, keep neighbouring glyphs out of it
+		io.Fonts->TexGlyphPadding = ImMax(io.Fonts->TexGlyphPadding, (int)ceilf(g_SdfSpread));
+	}
+	if (g_Alpha8FontAtlas || sdf)
+		io.Fonts->GetTexDataAsAlpha8(&pixels, &width, &height);   // Load as 8-bit alpha, the swizzle below makes it sample like the RGBA32 atlas
+	else
+		io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);   // Load as RGBA 32-bits (75% of the memory is wasted)
 
-															  // Upload texture to graphics system
-	GLint last_texture;
+	ImVector<unsigned char> sdf_pixels;
+	if (sdf)
+	{
+		ImGui_ImplOvr_BuildFontSdf(io.Fonts, pixels, width, height, g_SdfSpread, &sdf_pixels);
+		pixels = sdf_pixels.Data;
+	}
+
+	// Upload texture to graphics system
+	GLint last_texture, last_unpack_alignment;
 	glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
+	glGetIntegerv(GL_UNPACK_ALIGNMENT, &last_unpack_alignment);
 	glGenTextures(1, &g_FontTexture);
 	glBindTexture(GL_TEXTURE_2D, g_FontTexture);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	if (g_Alpha8FontAtlas || sdf)
+	{
+		// white with the coverage (or distance) in alpha, so the ImGui shader and colored user textures work unchanged
+		const GLint swizzle[4] = { GL_ONE, GL_ONE, GL_ONE, GL_RED };
+		glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, pixels);
+	}
+	else
+	{
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	}
 
 	// Store our identifier
 	io.Fonts->TexID = (void *)(intptr_t)g_FontTexture;
 
 	// Restore state
 	glBindTexture(GL_TEXTURE_2D, last_texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, last_unpack_alignment);
+
+	g_FontAtlasStats.Width = width;
+	g_FontAtlasStats.Height = height;
+	g_FontAtlasStats.Bytes = (unsigned long long)width * height * (g_Alpha8FontAtlas || sdf ? 1 : 4);
+	g_FontAtlasStats.Sdf = sdf;
+	g_FontAtlasStats.BuildCpuTimeMs = std::chrono::duration<double, std::milli>(Clock::now() - build_start).count();
 
 	return true;
 }
@@ -593,29 +3543,39 @@ bool ImGui_ImplOvr_CreateDeviceObjects()
 
 	const GLchar* fragment_shader =
 		"uniform sampler2D Texture;\n"
+		"uniform bool IsSdf;\n"
 		"in vec2 Frag_UV;\n"
 		"in vec4 Frag_Color;\n"
 		"out vec4 Out_Color;\n"
 		"void main()\n"
 		"{\n"
-		"    Out_Color = Frag_Color * texture(Texture, Frag_UV.st);\n"
+		"    vec4 tex = texture(Texture, Frag_UV.st);\n"
+		"    if (IsSdf)\n"
+		"    {\n"
+		"        float w = max(fwidth(tex.a), 1e-4) * 0.7;\n"
+		"        tex.a = smoothstep(0.5 - w, 0.5 + w, tex.a);\n"
+		"    }\n"
+		"    Out_Color = Frag_Color * tex;\n"
 		"}\n";
 
 	const GLchar* quad_vert_shader =
-		"uniform mat4 ModelViewMtx;\n"
+		"uniform mat4 ViewMtx;\n"
 		"uniform mat4 ProjMtx;\n"
 		"in vec3 Position;\n"
 		"in vec2 UV;\n"
-		"out vec2 Frag_UV;\n"
+		"in mat4 ModelMtx;\n"
+		"in vec4 AtlasRect;\n"
+		"in float AtlasLayer;\n"
+		"out vec3 Frag_UV;\n"
 		"void main()\n"
 		"{\n"
-		"    Frag_UV = UV;\n"
-		"    gl_Position = ProjMtx * ModelViewMtx * vec4(Position.xyz, 1.0);\n"
+		"    Frag_UV = vec3(AtlasRect.xy + UV * AtlasRect.zw, AtlasLayer);\n"
+		"    gl_Position = ProjMtx * ViewMtx * ModelMtx * vec4(Position.xyz, 1.0);\n"
 		"}\n";
 
 	const GLchar* quad_frag_shader =
-		"uniform sampler2D Texture;\n"
-		"in vec2 Frag_UV;\n"
+		"uniform sampler2DArray Texture;\n"
+		"in vec3 Frag_UV;\n"
 		"out vec4 Out_Color;\n"
 		"void main()\n"
 		"{\n"
@@ -639,6 +3599,42 @@ bool ImGui_ImplOvr_CreateDeviceObjects()
 		"    Out_Color = vec4(LineColor.rgb, 1.0);\n"
 		"}\n";
 
+	// the stereo vertex shaders are prefixed with one of these, picking the eye by view or instance
+	const GLchar* multiview_header =
+		"#extension GL_OVR_multiview : require\n"
+		"layout(num_views = 2) in;\n"
+		"#define EYE int(gl_ViewID_OVR)\n"
+		"#define SET_LAYER\n";
+
+	const GLchar* instanced_layer_header =
+		"#extension GL_ARB_shader_viewport_layer_array : require\n"
+		"#define EYE (gl_InstanceID & 1)\n"
+		"#define SET_LAYER gl_Layer = EYE\n";
+
+	const GLchar* quad_stereo_vert_shader =
+		"layout(std140) uniform EyeMatrices { mat4 Proj[2]; mat4 View[2]; };\n"
+		"in vec3 Position;\n"
+		"in vec2 UV;\n"
+		"in mat4 ModelMtx;\n"
+		"in vec4 AtlasRect;\n"
+		"in float AtlasLayer;\n"
+		"out vec3 Frag_UV;\n"
+		"void main()\n"
+		"{\n"
+		"    Frag_UV = vec3(AtlasRect.xy + UV * AtlasRect.zw, AtlasLayer);\n"
+		"    SET_LAYER;\n"
+		"    gl_Position = Proj[EYE] * View[EYE] * ModelMtx * vec4(Position.xyz, 1.0);\n"
+		"}\n";
+
+	const GLchar* line_stereo_vert_shader =
+		"layout(std140) uniform EyeMatrices { mat4 Proj[2]; mat4 View[2]; };\n"
+		"in vec3 Position;\n"
+		"void main()\n"
+		"{\n"
+		"    SET_LAYER;\n"
+		"    gl_Position = Proj[EYE] * View[EYE] * vec4(Position.xyz, 1.0);\n"
+		"}\n";
+
 	// Create shaders for GUI
 	const GLchar* vertex_shader_with_version[2] = { g_GlslVersionString.c_str(), vertex_shader };
 	g_VertHandle = glCreateShader(GL_VERTEX_SHADER);
@@ -659,6 +3655,7 @@ bool ImGui_ImplOvr_CreateDeviceObjects()
 	CheckProgram(g_ShaderHandle, "shader program");
 
 	g_AttribLocationTex = glGetUniformLocation(g_ShaderHandle, "Texture");
+	g_AttribLocationIsSdf = glGetUniformLocation(g_ShaderHandle, "IsSdf");
 	g_AttribLocationProjMtx = glGetUniformLocation(g_ShaderHandle, "ProjMtx");
 	g_AttribLocationPosition = glGetAttribLocation(g_ShaderHandle, "Position");
 	g_AttribLocationUV = glGetAttribLocation(g_ShaderHandle, "UV");
@@ -680,12 +3677,13 @@ bool ImGui_ImplOvr_CreateDeviceObjects()
 	g_QuadShaderHandle = glCreateProgram();
 	glAttachShader(g_QuadShaderHandle, g_QuadVertHandle);
 	glAttachShader(g_QuadShaderHandle, g_QuadFragHandle);
+	ImGui_ImplOvr_BindQuadAttribLocations(g_QuadShaderHandle);
 	glLinkProgram(g_QuadShaderHandle);
 	CheckProgram(g_QuadShaderHandle, "quad shader program");
 
 	g_QuadAttribLocationTex = glGetUniformLocation(g_QuadShaderHandle, "Texture");
 	g_QuadAttribLocationProjMtx = glGetUniformLocation(g_QuadShaderHandle, "ProjMtx");
-	g_QuadAttribLocationModelViewMtx = glGetUniformLocation(g_QuadShaderHandle, "ModelViewMtx");
+	g_QuadAttribLocationViewMtx = glGetUniformLocation(g_QuadShaderHandle, "ViewMtx");
 
 	// create shaders for line
 	const GLchar* line_vertex_shader_with_version[2] = { g_GlslVersionString.c_str(), line_vert_shader };
@@ -710,49 +3708,89 @@ bool ImGui_ImplOvr_CreateDeviceObjects()
 	g_LineAttribLocationViewMtx = glGetUniformLocation(g_LineShaderHandle, "ViewMtx");
 	g_LineAttribLocationLineColor = glGetUniformLocation(g_LineShaderHandle, "LineColor");
 
-	// create vao for quad
-	glGenVertexArrays(1, &g_QuadVao);
-	glBindVertexArray(g_QuadVao);
+	// create stereo shaders for quad and line, reusing the fragment shaders above
+	const ImGuiVrStereoMode stereo_mode = ImGui_ImplOvr_GetStereoMode();
+	if (stereo_mode != ImGuiVrStereoMode_None)
+	{
+		const GLchar* stereo_header = stereo_mode == ImGuiVrStereoMode_Multiview ? multiview_header : instanced_layer_header;
+
+		const GLchar* quad_stereo_vertex_shader_with_version[3] = { g_GlslVersionString.c_str(), stereo_header, quad_stereo_vert_shader };
+		g_QuadStereoVertHandle = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(g_QuadStereoVertHandle, 3, quad_stereo_vertex_shader_with_version, nullptr);
+		glCompileShader(g_QuadStereoVertHandle);
+		CheckShader(g_QuadStereoVertHandle, "quad stereo vertex shader");
+
+		g_QuadStereoShaderHandle = glCreateProgram();
+		glAttachShader(g_QuadStereoShaderHandle, g_QuadStereoVertHandle);
+		glAttachShader(g_QuadStereoShaderHandle, g_QuadFragHandle);
+		ImGui_ImplOvr_BindQuadAttribLocations(g_QuadStereoShaderHandle);
+		glLinkProgram(g_QuadStereoShaderHandle);
+		CheckProgram(g_QuadStereoShaderHandle, "quad stereo shader program");
+
+		g_QuadStereoAttribLocationTex = glGetUniformLocation(g_QuadStereoShaderHandle, "Texture");
+		glUniformBlockBinding(g_QuadStereoShaderHandle, glGetUniformBlockIndex(g_QuadStereoShaderHandle, "EyeMatrices"), IMGUI_OVR_EYE_MATRICES_BINDING);
+
+		const GLchar* line_stereo_vertex_shader_with_version[3] = { g_GlslVersionString.c_str(), stereo_header, line_stereo_vert_shader };
+		g_LineStereoVertHandle = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(g_LineStereoVertHandle, 3, line_stereo_vertex_shader_with_version, nullptr);
+		glCompileShader(g_LineStereoVertHandle);
+		CheckShader(g_LineStereoVertHandle, "line stereo vertex shader");
+
+		g_LineStereoShaderHandle = glCreateProgram();
+		glAttachShader(g_LineStereoShaderHandle, g_LineStereoVertHandle);
+		glAttachShader(g_LineStereoShaderHandle, g_LineFragHandle);
+		glBindAttribLocation(g_LineStereoShaderHandle, 0, "Position");
+		glLinkProgram(g_LineStereoShaderHandle);
+		CheckProgram(g_LineStereoShaderHandle, "line stereo shader program");
+
+		g_LineStereoAttribLocationLineColor = glGetUniformLocation(g_LineStereoShaderHandle, "LineColor");
+		glUniformBlockBinding(g_LineStereoShaderHandle, glGetUniformBlockIndex(g_LineStereoShaderHandle, "EyeMatrices"), IMGUI_OVR_EYE_MATRICES_BINDING);
+
+		glGenBuffers(1, &g_EyeMatricesUbo);
+		glBindBuffer(GL_UNIFORM_BUFFER, g_EyeMatricesUbo);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(ImGui_ImplOvr_EyeMatrices), nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+
+	// create buffers for quad, use the copy target so no VAO's element buffer binding is touched
 	glGenBuffers(1, &g_QuadVbo);
 	glGenBuffers(1, &g_QuadEbo);
 	glBindBuffer(GL_ARRAY_BUFFER, g_QuadVbo);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * (3 + 2) * 4, g_QuadVertexBuffer, GL_STATIC_DRAW);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_QuadEbo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * 6, g_QuadIndices, GL_STATIC_DRAW);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * (3 + 2), nullptr);
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * (3 + 2), reinterpret_cast<GLvoid*>(sizeof(GLfloat) * 3));
-	glBindVertexArray(0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, g_QuadEbo);
+	glBufferData(GL_COPY_WRITE_BUFFER, sizeof(GLuint) * 6, g_QuadIndices, GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	glGenBuffers(1, &g_PanelInstanceVbo);
 
 	// Create buffers
 	glGenBuffers(1, &g_VboHandle);
 	glGenBuffers(1, &g_ElementsHandle);
 	glGenBuffers(1, &g_LineVbo);
 
+	// FBOs to generate the canvas atlas' mips with
+	glGenFramebuffers(2, g_CanvasMipFBOs);
+
+	// create the VAOs for the context we're being created in up front, so the first frame doesn't have to
+	ImGui_ImplOvr_GetContextVaos();
+
 	ImGui_ImplOvr_CreateFontsTexture();
 
-	// create GUI render texture
-	glGenTextures(1, &g_GuiTexture);
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, g_GuiTexture);
-	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, g_VirtualCanvasSize.x, g_VirtualCanvasSize.y);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	// create GUI fbo
-	glGenFramebuffers(1, &g_GuiFBO);
-	glBindFramebuffer(GL_FRAMEBUFFER, g_GuiFBO);
-	glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, g_GuiTexture, 0);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	g_GpuTimer.Create();
 
 	// Restore modified GL state
 	glBindTexture(GL_TEXTURE_2D, last_texture);
 	glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
 	glBindVertexArray(last_vertex_array);
 
+	// create the canvas of every panel
+	for (int i = 0; i < g_Contexts.Size; i++)
+	{
+		ImGui_ImplOvr_CreateCanvas(g_Contexts[i]);
+	}
+
+	// the active texture unit was changed above, don't trust the shadow state
+	g_GLState.Known = 0;
+
 	return true;
 }
 
@@ -765,9 +3803,26 @@ void ImGui_ImplOvr_DestroyDeviceObjects()
 	if (g_ElementsHandle) glDeleteBuffers(1, &g_ElementsHandle);
 	g_VboHandle = g_ElementsHandle = 0;
 
+	ImGui_ImplOvr_DestroyUploadRing();
+	g_CmdFingerprints.clear();
+	g_RebasedIndices.clear();
+	g_DamageRects.clear();
+
 	if (g_LineVbo) glDeleteBuffers(1, &g_LineVbo);
 	g_LineVbo = 0;
 
+	// stereo programs go first, they share the fragment shaders of the single eye programs
+	if (g_QuadStereoShaderHandle) glDeleteProgram(g_QuadStereoShaderHandle);
+	if (g_QuadStereoVertHandle) glDeleteShader(g_QuadStereoVertHandle);
+	g_QuadStereoShaderHandle = g_QuadStereoVertHandle = 0;
+
+	if (g_LineStereoShaderHandle) glDeleteProgram(g_LineStereoShaderHandle);
+	if (g_LineStereoVertHandle) glDeleteShader(g_LineStereoVertHandle);
+	g_LineStereoShaderHandle = g_LineStereoVertHandle = 0;
+
+	if (g_EyeMatricesUbo) glDeleteBuffers(1, &g_EyeMatricesUbo);
+	g_EyeMatricesUbo = 0;
+
 	if (g_ShaderHandle && g_VertHandle) glDetachShader(g_ShaderHandle, g_VertHandle);
 	if (g_VertHandle) glDeleteShader(g_VertHandle);
 	g_VertHandle = 0;
@@ -801,14 +3856,31 @@ void ImGui_ImplOvr_DestroyDeviceObjects()
 	if (g_LineShaderHandle) glDeleteProgram(g_LineShaderHandle);
 	g_LineShaderHandle = 0;
 
-	if (g_GuiTexture) glDeleteTextures(1, &g_GuiTexture);
-	g_GuiTexture = 0;
+	for (int i = 0; i < g_Contexts.Size; i++)
+	{
+		ImGui_ImplOvr_DestroyCanvas(g_Contexts[i]);
+	}
+
+	if (g_CanvasAtlas.Texture) glDeleteTextures(1, &g_CanvasAtlas.Texture);
+	g_CanvasAtlas.Texture = 0;
+	g_CanvasAtlas.Size = g_CanvasAtlas.Layers = g_CanvasAtlas.Levels = 0;
+	g_CanvasAtlas.Shelves.clear();
 
-	if (g_GuiFBO) glDeleteFramebuffers(1, &g_GuiFBO);
-	g_GuiFBO = 0;
+	if (g_CanvasMipFBOs[0]) glDeleteFramebuffers(2, g_CanvasMipFBOs);
+	g_CanvasMipFBOs[0] = g_CanvasMipFBOs[1] = 0;
 
-	if (g_QuadVao) glDeleteVertexArrays(1, &g_QuadVao);
-	g_QuadVao = 0;
+	// we can only delete the VAOs of the current context, the others are kept until their context is current again
+	void* const context = g_GetCurrentContextFunc ? g_GetCurrentContextFunc() : nullptr;
+	for (int i = g_ContextVaos.Size - 1; i >= 0; i--)
+	{
+		if (g_ContextVaos[i].Context != context)
+		{
+			g_ContextVaos[i].Stale = true;
+			continue;
+		}
+		ImGui_ImplOvr_DeleteContextVaos(g_ContextVaos[i]);
+		g_ContextVaos.erase(g_ContextVaos.begin() + i);
+	}
 
 	if (g_QuadVbo) glDeleteBuffers(1, &g_QuadVbo);
 	g_QuadVbo = 0;
@@ -816,7 +3888,50 @@ void ImGui_ImplOvr_DestroyDeviceObjects()
 	if (g_QuadEbo) glDeleteBuffers(1, &g_QuadEbo);
 	g_QuadEbo = 0;
 
+	if (g_PanelInstanceVbo) glDeleteBuffers(1, &g_PanelInstanceVbo);
+	g_PanelInstanceVbo = 0;
+
 	ImGui_ImplOvr_DestroyFontsTexture();
+
+	g_GpuTimer.Destroy();
+
+	// deleting bound objects resets their bindings to 0
+	g_GLState.Known = 0;
+}
+
+/**
+ * @brief Downsamples a panel's freshly drawn canvas into the lower mip levels of its atlas rectangle, each level
+ * from the one above it. glGenerateMipmap() would redo every canvas of every layer.
+ * 
+ * @param ctx The panel, with its canvas drawn at RasterSize
+ * @param whole_rect True to fill the whole atlas rectangle, padding included, rather than just the raster
+ */
+static void ImGui_ImplOvr_GenerateCanvasMips(const ImGui_ImplOvr_Context* ctx, bool whole_rect)
+{
+	const ImGui_ImplOvr_AtlasRect& rect = ctx->CanvasRect;
+	if (g_CanvasAtlas.Levels <= 1 || !g_CanvasMipFBOs[0]) return;
+
+	// a texel past the raster, so the level below filters in the cleared border rather than stale texels
+	glm::ivec2 size = whole_rect ? glm::ivec2(ImGui_ImplOvr_AtlasPadded(rect.W), ImGui_ImplOvr_AtlasPadded(rect.H))
+		: glm::min(ctx->RasterSize + 1, glm::ivec2(ImGui_ImplOvr_AtlasPadded(rect.W), ImGui_ImplOvr_AtlasPadded(rect.H)));
+	size = (size + 1) & ~1;
+
+	ImGui_ImplOvr_StateEnable(ImGuiVrStateBit_ScissorTest, GL_SCISSOR_TEST, false);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, g_CanvasMipFBOs[0]);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, g_CanvasMipFBOs[1]);
+	for (int level = 1; level < g_CanvasAtlas.Levels; level++)
+	{
+		glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, g_CanvasAtlas.Texture, level - 1, rect.Layer);
+		glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, g_CanvasAtlas.Texture, level, rect.Layer);
+		const glm::ivec2 src = glm::ivec2(rect.X, rect.Y) >> (level - 1);
+		const glm::ivec2 dst = glm::ivec2(rect.X, rect.Y) >> level;
+		glBlitFramebuffer(src.x, src.y, src.x + size.x, src.y + size.y, dst.x, dst.y, dst.x + size.x / 2, dst.y + size.y / 2,
+			GL_COLOR_BUFFER_BIT, GL_LINEAR);
+		size = ((size / 2) + 1) & ~1;
+	}
+
+	// the framebuffer binding was changed behind the state cache's back
+	g_GLState.Known &= ~ImGuiVrStateBit_Framebuffer;
 }
 
 /**
@@ -827,6 +3942,11 @@ void ImGui_ImplOvr_DestroyDeviceObjects()
  */
 void ImGui_ImplOvr_RenderDrawData(ImDrawData * draw_data)
 {
+	IMGUI_OVR_PROFILE_SCOPE("ImGui_ImplOvr_RenderDrawData");
+	typedef std::chrono::high_resolution_clock Clock;
+	const Clock::time_point render_start = Clock::now();
+	g_Ctx->UploadStats = ImGui_ImplOvr_UploadStats();
+
 	// Avoid rendering when minimized, scale coordinates for retina displays (screen coordinates != framebuffer coordinates)
 	ImGuiIO& io = ImGui::GetIO();
 	int fb_width = (int)(draw_data->DisplaySize.x * io.DisplayFramebufferScale.x);
@@ -835,45 +3955,66 @@ void ImGui_ImplOvr_RenderDrawData(ImDrawData * draw_data)
 		return;
 	draw_data->ScaleClipRects(io.DisplayFramebufferScale);
 
-	// Backup GL state
-	GLenum last_active_texture; glGetIntegerv(GL_ACTIVE_TEXTURE, (GLint*)&last_active_texture);
-	glActiveTexture(GL_TEXTURE0);
-	GLint last_program; glGetIntegerv(GL_CURRENT_PROGRAM, &last_program);
-	GLint last_texture; glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
-	GLint last_sampler; glGetIntegerv(GL_SAMPLER_BINDING, &last_sampler);
-	GLint last_array_buffer; glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &last_array_buffer);
-	GLint last_vertex_array; glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &last_vertex_array);
-	GLint last_polygon_mode[2]; glGetIntegerv(GL_POLYGON_MODE, last_polygon_mode);
-	GLint last_viewport[4]; glGetIntegerv(GL_VIEWPORT, last_viewport);
-	GLint last_scissor_box[4]; glGetIntegerv(GL_SCISSOR_BOX, last_scissor_box);
-	GLint last_framebuffer; glGetIntegerv(GL_FRAMEBUFFER_BINDING, &last_framebuffer);
-	GLenum last_blend_src_rgb; glGetIntegerv(GL_BLEND_SRC_RGB, (GLint*)&last_blend_src_rgb);
-	GLenum last_blend_dst_rgb; glGetIntegerv(GL_BLEND_DST_RGB, (GLint*)&last_blend_dst_rgb);
-	GLenum last_blend_src_alpha; glGetIntegerv(GL_BLEND_SRC_ALPHA, (GLint*)&last_blend_src_alpha);
-	GLenum last_blend_dst_alpha; glGetIntegerv(GL_BLEND_DST_ALPHA, (GLint*)&last_blend_dst_alpha);
-	GLenum last_blend_equation_rgb; glGetIntegerv(GL_BLEND_EQUATION_RGB, (GLint*)&last_blend_equation_rgb);
-	GLenum last_blend_equation_alpha; glGetIntegerv(GL_BLEND_EQUATION_ALPHA, (GLint*)&last_blend_equation_alpha);
-	GLboolean last_enable_blend = glIsEnabled(GL_BLEND);
-	GLboolean last_enable_cull_face = glIsEnabled(GL_CULL_FACE);
-	GLboolean last_enable_depth_test = glIsEnabled(GL_DEPTH_TEST);
-	GLboolean last_enable_scissor_test = glIsEnabled(GL_SCISSOR_TEST);
+	// the draw data must fit the canvas' rectangle of the atlas, or it would draw over other canvases
+	const ImGui_ImplOvr_AtlasRect canvas_rect = g_Ctx->CanvasRect;
+	if (canvas_rect.Layer < 0 || fb_width > canvas_rect.W || fb_height > canvas_rect.H)
+		return;
+	const glm::ivec2 raster_size(fb_width, fb_height);
+
+	// If the GUI hasn't changed since the canvas was last drawn, it already holds exactly what we'd draw
+	const Clock::time_point hash_start = Clock::now();
+	bool cacheable = false, has_callbacks = true;
+	const unsigned long long hash = (g_CanvasCaching || g_DamageTracking) ? ImGui_ImplOvr_HashDrawData(draw_data, &cacheable, &has_callbacks) : 0;
+	g_Ctx->CanvasStats.HashCpuTimeMs = std::chrono::duration<double, std::milli>(Clock::now() - hash_start).count();
+	g_Ctx->CanvasStats.Frames++;
+	if (g_CanvasCaching && cacheable && g_Ctx->CanvasValid && hash == g_Ctx->CanvasHash && raster_size == g_Ctx->RasterSize)
+	{
+		g_Ctx->CanvasStats.CacheHits++;
+		g_Ctx->UploadStats.RenderCpuTimeMs = std::chrono::duration<double, std::milli>(Clock::now() - render_start).count();
+		return;
+	}
+	// at a new raster size nothing drawn before can be kept, and the rest of the rectangle must be cleared too so
+	// mips don't blend in what's left of a larger raster
+	const bool whole_rect = !g_Ctx->CanvasDrawn || raster_size != g_Ctx->RasterSize;
+	if (raster_size != g_Ctx->RasterSize)
+	{
+		if (g_Ctx->CanvasDrawn) g_Ctx->CanvasStats.RasterScaleChanges++;
+		g_Ctx->RasterSize = raster_size;
+	}
+	g_Ctx->CanvasStats.RasterScale = g_Ctx->RasterScale;
+	const bool had_canvas = g_Ctx->CanvasValid && !whole_rect;
+	g_Ctx->CanvasHash = hash;
+	g_Ctx->CanvasValid = !has_callbacks;
 
-	// Setup render state: alpha-blending enabled, no face culling, no depth testing, scissor enabled, polygon fill
-	glEnable(GL_BLEND);
-	glBlendEquation(GL_FUNC_ADD);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glDisable(GL_CULL_FACE);
-	glDisable(GL_DEPTH_TEST);
-	glEnable(GL_SCISSOR_TEST);
-	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	const int gpu_phase = ImGui_ImplOvr_BeginGpuPhase("ImGui_ImplOvr_RenderDrawData");
 
-	glBindFramebuffer(GL_FRAMEBUFFER, g_GuiFBO);
+	// Backup GL state
+	ImGui_ImplOvr_GLState last_state;
+	ImGui_ImplOvr_StateBackup(ImGuiVrStateBit_ActiveTexture | ImGuiVrStateBit_Program | ImGuiVrStateBit_Texture | ImGuiVrStateBit_Sampler
+		| ImGuiVrStateBit_ArrayBuffer | ImGuiVrStateBit_VertexArray | ImGuiVrStateBit_PolygonMode | ImGuiVrStateBit_Viewport
+		| ImGuiVrStateBit_ScissorBox | ImGuiVrStateBit_Framebuffer | ImGuiVrStateBit_BlendEquation | ImGuiVrStateBit_BlendFunc
+		| ImGuiVrStateBit_Blend | ImGuiVrStateBit_CullFace | ImGuiVrStateBit_DepthTest | ImGuiVrStateBit_ScissorTest, &last_state);
+	ImGui_ImplOvr_StateActiveTexture(GL_TEXTURE0);
 
-	glScissor(0, 0, draw_data->DisplaySize.x, draw_data->DisplaySize.y);
+	// Setup render state: alpha-blending enabled, no face culling, no depth testing, scissor enabled, polygon fill
+	ImGui_ImplOvr_StateEnable(ImGuiVrStateBit_Blend, GL_BLEND, true);
+	ImGui_ImplOvr_StateBlendEquation(GL_FUNC_ADD, GL_FUNC_ADD);
+	ImGui_ImplOvr_StateBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	ImGui_ImplOvr_StateEnable(ImGuiVrStateBit_CullFace, GL_CULL_FACE, false);
+	ImGui_ImplOvr_StateEnable(ImGuiVrStateBit_DepthTest, GL_DEPTH_TEST, false);
+	ImGui_ImplOvr_StateEnable(ImGuiVrStateBit_ScissorTest, GL_SCISSOR_TEST, true);
+	ImGui_ImplOvr_StatePolygonMode(GL_FILL);
+
+	ImGui_ImplOvr_StateBindFramebuffer(g_Ctx->GuiFBO);
+	if (whole_rect)
+	{
+		ImGui_ImplOvr_StateScissor(canvas_rect.X, canvas_rect.Y, ImGui_ImplOvr_AtlasPadded(canvas_rect.W), ImGui_ImplOvr_AtlasPadded(canvas_rect.H));
+		glClear(GL_COLOR_BUFFER_BIT);
+	}
 
 	// Setup viewport, orthographic projection matrix
 	// Our visible imgui space lies from draw_data->DisplayPps (top left) to draw_data->DisplayPos+data_data->DisplaySize (bottom right). DisplayMin is typically (0,0) for single viewport apps.
-	glViewport(0, 0, (GLsizei)fb_width, (GLsizei)fb_height);
+	ImGui_ImplOvr_StateViewport(canvas_rect.X, canvas_rect.Y, fb_width, fb_height);
 	float L = draw_data->DisplayPos.x;
 	float R = draw_data->DisplayPos.x + draw_data->DisplaySize.x;
 	float T = draw_data->DisplayPos.y;
@@ -886,142 +4027,523 @@ void ImGui_ImplOvr_RenderDrawData(ImDrawData * draw_data)
 		{ (R + L) / (L - R),  (T + B) / (B - T),  0.0f,   1.0f },
 	};
 
-	glUseProgram(g_ShaderHandle);
+	ImGui_ImplOvr_StateUseProgram(g_ShaderHandle);
 	glUniform1i(g_AttribLocationTex, 0);
+	glUniform1i(g_AttribLocationIsSdf, 0);
+	bool sdf_bound = false;
 	glUniformMatrix4fv(g_AttribLocationProjMtx, 1, GL_FALSE, &ortho_projection[0][0]);
-	if (glBindSampler) glBindSampler(0, 0); // We use combined texture/sampler state. Applications using GL 3.3 may set that otherwise.
+	ImGui_ImplOvr_StateBindSampler(0); // We use combined texture/sampler state. Applications using GL 3.3 may set that otherwise.
+
+	// Use this GL context's cached VAO (VAOs are not shared among GL contexts), and reset its attributes
+	// as the upload mode may have pointed them elsewhere last frame
+	ImGui_ImplOvr_StateBindVertexArray(ImGui_ImplOvr_GetContextVaos().DrawVao);
+	ImGui_ImplOvr_StateBindArrayBuffer(g_VboHandle);
+	ImGui_ImplOvr_SetupVertexAttribs(0);
+
+	// Upload the whole frame's geometry into the ring buffer up front if we can, each segment is laid out as
+	// [all vertices][padding][all indices]
+	const size_t vtx_bytes = (size_t)draw_data->TotalVtxCount * sizeof(ImDrawVert);
+	const size_t idx_bytes = (size_t)draw_data->TotalIdxCount * sizeof(ImDrawIdx);
+	const size_t idx_region_offset = (vtx_bytes + 15) & ~(size_t)15;
+	size_t ring_vtx_offset = 0, ring_idx_offset = 0;
+	bool use_ring = g_UploadMode != ImGuiVrUploadMode_Orphan && ImGui_ImplOvr_HasBufferStorage();
+	if (use_ring)
+	{
+		const Clock::time_point upload_start = Clock::now();
+		if (!g_UploadRing.Mapped || g_UploadRing.SegmentSize < idx_region_offset + idx_bytes)
+		{
+			use_ring = ImGui_ImplOvr_CreateUploadRing(idx_region_offset + idx_bytes);
+		}
+		else
+		{
+			// move on to the oldest segment, making sure the GPU is done reading from it
+			g_UploadRing.Segment = (g_UploadRing.Segment + 1) % IMGUI_OVR_UPLOAD_RING_SEGMENTS;
+			ImGui_ImplOvr_WaitUploadRingSegment(g_UploadRing.Segment);
+		}
 
-											// Recreate the VAO every time 
-											// (This is to easily allow multiple GL contexts. VAO are not shared among GL contexts, and we don't track creation/deletion of windows so we don't have an obvious key to use to cache them.)
-	GLuint vao_handle = 0;
-	glGenVertexArrays(1, &vao_handle);
-	glBindVertexArray(vao_handle);
-	glBindBuffer(GL_ARRAY_BUFFER, g_VboHandle);
-	glEnableVertexAttribArray(g_AttribLocationPosition);
-	glEnableVertexAttribArray(g_AttribLocationUV);
-	glEnableVertexAttribArray(g_AttribLocationColor);
-	glVertexAttribPointer(g_AttribLocationPosition, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, pos));
-	glVertexAttribPointer(g_AttribLocationUV, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, uv));
-	glVertexAttribPointer(g_AttribLocationColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, col));
+		if (use_ring)
+		{
+			ring_vtx_offset = g_UploadRing.Segment * g_UploadRing.SegmentSize;
+			ring_idx_offset = ring_vtx_offset + idx_region_offset;
+			unsigned char* vtx_dst = g_UploadRing.Mapped + ring_vtx_offset;
+			unsigned char* idx_dst = g_UploadRing.Mapped + ring_idx_offset;
+			for (int n = 0; n < draw_data->CmdListsCount; n++)
+			{
+				const ImDrawList* cmd_list = draw_data->CmdLists[n];
+				const size_t list_vtx_bytes = (size_t)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert);
+				const size_t list_idx_bytes = (size_t)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx);
+				memcpy(vtx_dst, cmd_list->VtxBuffer.Data, list_vtx_bytes);
+				memcpy(idx_dst, cmd_list->IdxBuffer.Data, list_idx_bytes);
+				vtx_dst += list_vtx_bytes;
+				idx_dst += list_idx_bytes;
+				g_Ctx->UploadStats.RingWrites += 2;
+			}
+			g_Ctx->UploadStats.BytesUploaded = vtx_bytes + idx_bytes;
+			g_Ctx->UploadStats.PersistentRing = true;
 
-	glClear(GL_COLOR_BUFFER_BIT);
+			ImGui_ImplOvr_StateBindArrayBuffer(g_UploadRing.Handle);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_UploadRing.Handle);
+		}
+		g_Ctx->UploadStats.UploadCpuTimeMs += std::chrono::duration<double, std::milli>(Clock::now() - upload_start).count();
+	}
 
-	// Draw
-	ImVec2 pos = draw_data->DisplayPos;
-	for (int n = 0; n < draw_data->CmdListsCount; n++)
+	// Without the ring we can still merge every list into one contiguous upload by staging it on the CPU first
+	const bool merge_lists = g_MergeDrawLists && glDrawElementsBaseVertex;
+	if (!use_ring && merge_lists)
 	{
-		const ImDrawList* cmd_list = draw_data->CmdLists[n];
-		const ImDrawIdx* idx_buffer_offset = 0;
-
-		glBindBuffer(GL_ARRAY_BUFFER, g_VboHandle);
-		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert), (const GLvoid*)cmd_list->VtxBuffer.Data, GL_STREAM_DRAW);
+		const Clock::time_point upload_start = Clock::now();
+		g_MergedVtxBuffer.resize((int)vtx_bytes);
+		g_MergedIdxBuffer.resize((int)idx_bytes);
+		unsigned char* vtx_dst = g_MergedVtxBuffer.Data;
+		unsigned char* idx_dst = g_MergedIdxBuffer.Data;
+		for (int n = 0; n < draw_data->CmdListsCount; n++)
+		{
+			const ImDrawList* cmd_list = draw_data->CmdLists[n];
+			const size_t list_vtx_bytes = (size_t)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert);
+			const size_t list_idx_bytes = (size_t)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx);
+			memcpy(vtx_dst, cmd_list->VtxBuffer.Data, list_vtx_bytes);
+			memcpy(idx_dst, cmd_list->IdxBuffer.Data, list_idx_bytes);
+			vtx_dst += list_vtx_bytes;
+			idx_dst += list_idx_bytes;
+		}
 
+		ImGui_ImplOvr_StateBindArrayBuffer(g_VboHandle);
+		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vtx_bytes, (const GLvoid*)g_MergedVtxBuffer.Data, GL_STREAM_DRAW);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_ElementsHandle);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx), (const GLvoid*)cmd_list->IdxBuffer.Data, GL_STREAM_DRAW);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)idx_bytes, (const GLvoid*)g_MergedIdxBuffer.Data, GL_STREAM_DRAW);
 
-		for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
+		g_Ctx->UploadStats.BufferUpdates += 2;
+		g_Ctx->UploadStats.BytesUploaded = vtx_bytes + idx_bytes;
+		g_Ctx->UploadStats.UploadCpuTimeMs += std::chrono::duration<double, std::milli>(Clock::now() - upload_start).count();
+	}
+
+	// When merged, the attributes point at the first vertex of the frame once, and each list is
+	// addressed with a base vertex instead of rebinding
+	if (merge_lists)
+	{
+		ImGui_ImplOvr_SetupVertexAttribs(ring_vtx_offset);
+	}
+
+	// Work out which parts of the canvas changed since it was last drawn. Redrawing only parts of the canvas
+	// needs the whole frame's geometry uploaded up front, so only do it when draw lists are merged.
+	const bool track_damage = g_DamageTracking && !has_callbacks;
+	bool full_redraw = true;
+	if (track_damage)
+	{
+		full_redraw = !ImGui_ImplOvr_ComputeDamage(draw_data, fb_width, fb_height, had_canvas && merge_lists, &g_DamageRects);
+	}
+	else
+	{
+		g_Ctx->PrevCmdFingerprints.resize(0);
+	}
+
+	float redrawn_area = 0.0f;
+	const int pass_count = full_redraw ? 1 : g_DamageRects.Size;
+	if (!full_redraw)
+	{
+		g_Ctx->CanvasStats.PartialRedraws++;
+	}
+
+	// Draw, once per damaged region, or once for the whole canvas
+	ImVec2 pos = draw_data->DisplayPos;
+	const GLenum idx_type = sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	const size_t first_vtx_offset = ring_vtx_offset, first_idx_offset = ring_idx_offset;
+	for (int pass = 0; pass < pass_count; pass++)
+	{
+		// region is (x1, y1, x2, y2) in canvas pixels, top left origin like the ImGui clip rects
+		const ImVec4 region = full_redraw ? ImVec4(0.0f, 0.0f, (float)fb_width, (float)fb_height) : g_DamageRects[pass];
+		redrawn_area += (region.z - region.x) * (region.w - region.y);
+
+		ImGui_ImplOvr_StateScissor(canvas_rect.X + (int)region.x, canvas_rect.Y + (int)(fb_height - region.w), (int)(region.z - region.x), (int)(region.w - region.y));
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		ring_vtx_offset = first_vtx_offset;
+		ring_idx_offset = first_idx_offset;
+		GLint global_vtx_offset = 0;
+		for (int n = 0; n < draw_data->CmdListsCount; n++)
 		{
-			const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
-			if (pcmd->UserCallback)
+			const ImDrawList* cmd_list = draw_data->CmdLists[n];
+			const ImDrawIdx* idx_buffer_offset = 0;
+
+			if (merge_lists)
 			{
-				// User callback (registered via ImDrawList::AddCallback)
-				pcmd->UserCallback(cmd_list, pcmd);
+				// this list's data is part of the merged upload, offset into it
+				idx_buffer_offset = (const ImDrawIdx*)(intptr_t)ring_idx_offset;
+				ring_idx_offset += (size_t)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx);
+			}
+			else if (use_ring)
+			{
+				// this list's data is already in the ring, just point at it
+				ImGui_ImplOvr_SetupVertexAttribs(ring_vtx_offset);
+				idx_buffer_offset = (const ImDrawIdx*)(intptr_t)ring_idx_offset;
+				ring_vtx_offset += (size_t)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert);
+				ring_idx_offset += (size_t)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx);
 			}
 			else
 			{
-				ImVec4 clip_rect = ImVec4(pcmd->ClipRect.x - pos.x, pcmd->ClipRect.y - pos.y, pcmd->ClipRect.z - pos.x, pcmd->ClipRect.w - pos.y);
-				if (clip_rect.x < fb_width && clip_rect.y < fb_height && clip_rect.z >= 0.0f && clip_rect.w >= 0.0f)
+				const Clock::time_point upload_start = Clock::now();
+
+				ImGui_ImplOvr_StateBindArrayBuffer(g_VboHandle);
+				glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert), (const GLvoid*)cmd_list->VtxBuffer.Data, GL_STREAM_DRAW);
+
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_ElementsHandle);
+				glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx), (const GLvoid*)cmd_list->IdxBuffer.Data, GL_STREAM_DRAW);
+
+				g_Ctx->UploadStats.BufferUpdates += 2;
+				g_Ctx->UploadStats.BytesUploaded += (unsigned long long)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert) + (unsigned long long)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx);
+				g_Ctx->UploadStats.UploadCpuTimeMs += std::chrono::duration<double, std::milli>(Clock::now() - upload_start).count();
+			}
+
+			for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
+			{
+				const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
+				if (pcmd->UserCallback)
 				{
-					// Apply scissor/clipping rectangle
-					glScissor((int)clip_rect.x, (int)(fb_height - clip_rect.w), (int)(clip_rect.z - clip_rect.x), (int)(clip_rect.w - clip_rect.y));
+					// User callback (registered via ImDrawList::AddCallback)
+					pcmd->UserCallback(cmd_list, pcmd);
 
-					// Bind texture, Draw
-					glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)pcmd->TextureId);
-					glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, idx_buffer_offset);
+					// the callback may have changed anything
+					g_GLState.Known = 0;
 				}
+				else
+				{
+					// clip to both the command's clip rect and the region being redrawn
+					ImVec4 clip_rect = ImVec4(pcmd->ClipRect.x - pos.x, pcmd->ClipRect.y - pos.y, pcmd->ClipRect.z - pos.x, pcmd->ClipRect.w - pos.y);
+					clip_rect = ImVec4(ImMax(clip_rect.x, region.x), ImMax(clip_rect.y, region.y), ImMin(clip_rect.z, region.z), ImMin(clip_rect.w, region.w));
+					if (clip_rect.x < clip_rect.z && clip_rect.y < clip_rect.w)
+					{
+						// Apply scissor/clipping rectangle
+						ImGui_ImplOvr_StateScissor(canvas_rect.X + (int)clip_rect.x, canvas_rect.Y + (int)(fb_height - clip_rect.w), (int)(clip_rect.z - clip_rect.x), (int)(clip_rect.w - clip_rect.y));
+
+						// Bind texture, Draw
+						ImGui_ImplOvr_StateBindTexture((GLuint)(intptr_t)pcmd->TextureId);
+						const bool is_sdf = g_SdfFontAtlas && (GLuint)(intptr_t)pcmd->TextureId == g_FontTexture;
+						if (is_sdf != sdf_bound)
+						{
+							glUniform1i(g_AttribLocationIsSdf, is_sdf);
+							sdf_bound = is_sdf;
+						}
+						if (merge_lists)
+							glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, idx_type, idx_buffer_offset, global_vtx_offset);
+						else
+							glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, idx_type, idx_buffer_offset);
+					}
+				}
+				idx_buffer_offset += pcmd->ElemCount;
 			}
-			idx_buffer_offset += pcmd->ElemCount;
+			global_vtx_offset += cmd_list->VtxBuffer.Size;
 		}
 	}
-	glDeleteVertexArrays(1, &vao_handle);
+	g_Ctx->CanvasStats.RedrawnFraction = redrawn_area / ((float)fb_width * (float)fb_height);
+	ImGui_ImplOvr_GenerateCanvasMips(g_Ctx, whole_rect);
+	g_Ctx->CanvasDrawn = true;
+	g_Ctx->LayerStale = true;
+
+	// mark this segment as in use until the GPU has consumed the draws above
+	if (use_ring)
+	{
+		g_UploadRing.Fences[g_UploadRing.Segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
 
 	// Restore modified GL state
-	glUseProgram(last_program);
-	glBindTexture(GL_TEXTURE_2D, last_texture);
-	if (glBindSampler) glBindSampler(0, last_sampler);
-	glActiveTexture(last_active_texture);
-	glBindVertexArray(last_vertex_array);
-	glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
-	glBlendEquationSeparate(last_blend_equation_rgb, last_blend_equation_alpha);
-	glBlendFuncSeparate(last_blend_src_rgb, last_blend_dst_rgb, last_blend_src_alpha, last_blend_dst_alpha);
-	if (last_enable_blend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
-	if (last_enable_cull_face) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE);
-	if (last_enable_depth_test) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
-	if (last_enable_scissor_test) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST);
-	glPolygonMode(GL_FRONT_AND_BACK, (GLenum)last_polygon_mode[0]);
-	glViewport(last_viewport[0], last_viewport[1], (GLsizei)last_viewport[2], (GLsizei)last_viewport[3]);
-	glScissor(last_scissor_box[0], last_scissor_box[1], (GLsizei)last_scissor_box[2], (GLsizei)last_scissor_box[3]);
-	glBindFramebuffer(GL_FRAMEBUFFER, last_framebuffer);
+	ImGui_ImplOvr_StateRestore(last_state);
+
+	ImGui_ImplOvr_EndGpuPhase(gpu_phase);
+
+	g_Ctx->UploadStats.RenderCpuTimeMs = std::chrono::duration<double, std::milli>(Clock::now() - render_start).count();
 }
 
 /**
- * @brief Renders the GUI virtual canvas quad. Call this when you're rendering your VR scene
- * and make sure that it gets rendered as any other geometry would in VR (i.e. by both eyes).
+ * @brief Streams the per-instance data of panel quads into the panel instance buffer.
+ * 
+ * @param single The only panel to write, drawn with singleModel, or nullptr to write every panel that has been drawn
+ * @param singleModel The model matrix of the single panel's quad
+ * @return The number of instances written
+ */
+static int ImGui_ImplOvr_UploadPanelInstances(const ImGui_ImplOvr_Context* single, const glm::mat4& singleModel)
+{
+	g_PanelInstances.resize(0);
+	const int count = single ? 1 : g_Contexts.Size;
+	for (int i = 0; i < count; i++)
+	{
+		const ImGui_ImplOvr_Context* ctx = single ? single : g_Contexts[i];
+		const ImGui_ImplOvr_AtlasRect& rect = ctx->CanvasRect;
+		if (rect.Layer < 0 || (!single && !ctx->CanvasDrawn)) continue;
+
+		ImGui_ImplOvr_PanelInstance instance;
+		instance.ModelMtx = ImGui_ImplOvr_PanelQuadMatrix(ctx, single ? singleModel : ctx->ModelMatrix);
+
+		// only the bottom left of the rectangle holds the canvas at its raster size, inset by half a texel so linear
+		// filtering never reads past it
+		const glm::ivec2 raster = ctx->CanvasDrawn ? ctx->RasterSize : glm::ivec2(rect.W, rect.H);
+		const float texel = 1.0f / g_CanvasAtlas.Size;
+		instance.AtlasRect = glm::vec4((rect.X + 0.5f) * texel, (rect.Y + 0.5f) * texel, (raster.x - 1) * texel, (raster.y - 1) * texel);
+		instance.AtlasLayer = (float)rect.Layer;
+		g_PanelInstances.push_back(instance);
+	}
+	if (g_PanelInstances.Size == 0) return 0;
+
+	ImGui_ImplOvr_StateBindArrayBuffer(g_PanelInstanceVbo);
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)g_PanelInstances.Size * sizeof(ImGui_ImplOvr_PanelInstance), (const GLvoid*)g_PanelInstances.Data, GL_STREAM_DRAW);
+	return g_PanelInstances.Size;
+}
+
+/**
+ * @brief Draws panel quads with one instanced draw sampling the canvas atlas.
  * 
  * @param proj The projection matrix
  * @param view The view matrix
- * @param model The model matrix of the GUI quad. Use this to move it around to wherever you want it.
+ * @param single The only panel to draw, or nullptr to draw every panel
+ * @param singleModel The model matrix of the single panel's quad
  */
-void ImGui_ImplOvr_RenderGUIQuad(glm::mat4 proj, glm::mat4 view, glm::mat4 model)
+static void ImGui_ImplOvr_DrawPanelQuads(glm::mat4 proj, glm::mat4 view, const ImGui_ImplOvr_Context* single, glm::mat4 singleModel)
 {
 	// Backup GL state
-	GLenum last_active_texture; glGetIntegerv(GL_ACTIVE_TEXTURE, (GLint*)&last_active_texture);
-	glActiveTexture(GL_TEXTURE0);
-	GLint last_program; glGetIntegerv(GL_CURRENT_PROGRAM, &last_program);
-	GLint last_texture; glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
-	GLint last_array_buffer; glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &last_array_buffer);
-	GLint last_vertex_array; glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &last_vertex_array);
-	GLboolean last_enable_blend = glIsEnabled(GL_BLEND);
-	GLboolean last_enable_cull_face = glIsEnabled(GL_CULL_FACE);
-	GLint last_polygon_mode[2]; glGetIntegerv(GL_POLYGON_MODE, last_polygon_mode);
-	GLenum last_blend_src_rgb; glGetIntegerv(GL_BLEND_SRC_RGB, (GLint*)&last_blend_src_rgb);
-	GLenum last_blend_dst_rgb; glGetIntegerv(GL_BLEND_DST_RGB, (GLint*)&last_blend_dst_rgb);
-	GLenum last_blend_src_alpha; glGetIntegerv(GL_BLEND_SRC_ALPHA, (GLint*)&last_blend_src_alpha);
-	GLenum last_blend_dst_alpha; glGetIntegerv(GL_BLEND_DST_ALPHA, (GLint*)&last_blend_dst_alpha);
-	GLenum last_blend_equation_rgb; glGetIntegerv(GL_BLEND_EQUATION_RGB, (GLint*)&last_blend_equation_rgb);
-	GLenum last_blend_equation_alpha; glGetIntegerv(GL_BLEND_EQUATION_ALPHA, (GLint*)&last_blend_equation_alpha);
+	ImGui_ImplOvr_GLState last_state;
+	ImGui_ImplOvr_StateBackup(ImGuiVrStateBit_ActiveTexture | ImGuiVrStateBit_Program | ImGuiVrStateBit_ArrayBuffer
+		| ImGuiVrStateBit_VertexArray | ImGuiVrStateBit_Blend | ImGuiVrStateBit_CullFace | ImGuiVrStateBit_PolygonMode
+		| ImGuiVrStateBit_BlendEquation | ImGuiVrStateBit_BlendFunc, &last_state);
+	ImGui_ImplOvr_StateActiveTexture(GL_TEXTURE0);
+	GLint last_texture_array = 0;
+	if (!g_EngineOwnsGLState) glGetIntegerv(GL_TEXTURE_BINDING_2D_ARRAY, &last_texture_array);
 
 	// Setup render state: alpha-blending enabled, no face culling, polygon fill
-	glEnable(GL_BLEND);
-	glBlendEquation(GL_FUNC_ADD);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glDisable(GL_CULL_FACE);
-	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-
-	glm::mat4 modelView = view * model * 
-		glm::scale(glm::mat4(1), 
-			glm::vec3(g_VirtualCanvasSize.x / g_PixelsPerUnit, 
-				g_VirtualCanvasSize.y / g_PixelsPerUnit, 1.0f));
-
-	glUseProgram(g_QuadShaderHandle);
-	glBindTexture(GL_TEXTURE_2D, g_GuiTexture);
-	glUniform1i(g_QuadAttribLocationTex, 0);
-	glUniformMatrix4fv(g_QuadAttribLocationProjMtx, 1, GL_FALSE, glm::value_ptr(proj));
-	glUniformMatrix4fv(g_QuadAttribLocationModelViewMtx, 1, GL_FALSE, glm::value_ptr(modelView));
-	glBindVertexArray(g_QuadVao);
-	glDrawElements(GL_TRIANGLES, sizeof(g_QuadIndices) / sizeof(*g_QuadIndices), GL_UNSIGNED_INT, nullptr);
+	ImGui_ImplOvr_StateEnable(ImGuiVrStateBit_Blend, GL_BLEND, true);
+	ImGui_ImplOvr_StateBlendEquation(GL_FUNC_ADD, GL_FUNC_ADD);
+	ImGui_ImplOvr_StateBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	ImGui_ImplOvr_StateEnable(ImGuiVrStateBit_CullFace, GL_CULL_FACE, false);
+	ImGui_ImplOvr_StatePolygonMode(GL_FILL);
+
+	const int instances = ImGui_ImplOvr_UploadPanelInstances(single, singleModel);
+	if (instances > 0)
+	{
+		ImGui_ImplOvr_StateUseProgram(g_QuadShaderHandle);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, g_CanvasAtlas.Texture);
+		glUniform1i(g_QuadAttribLocationTex, 0);
+		glUniformMatrix4fv(g_QuadAttribLocationProjMtx, 1, GL_FALSE, glm::value_ptr(proj));
+		glUniformMatrix4fv(g_QuadAttribLocationViewMtx, 1, GL_FALSE, glm::value_ptr(view));
+		ImGui_ImplOvr_StateBindVertexArray(ImGui_ImplOvr_GetContextVaos().QuadVao);
+		glDrawElementsInstanced(GL_TRIANGLES, sizeof(g_QuadIndices) / sizeof(*g_QuadIndices), GL_UNSIGNED_INT, nullptr, instances);
+	}
 
 	// Restore modified GL state
-	glUseProgram(last_program);
-	glBindTexture(GL_TEXTURE_2D, last_texture);
-	glActiveTexture(last_active_texture);
-	glBindVertexArray(last_vertex_array);
-	glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
-	if (last_enable_blend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
-	if (last_enable_cull_face) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE);
-	glPolygonMode(GL_FRONT_AND_BACK, (GLenum)last_polygon_mode[0]);
-	glBlendEquationSeparate(last_blend_equation_rgb, last_blend_equation_alpha);
-	glBlendFuncSeparate(last_blend_src_rgb, last_blend_dst_rgb, last_blend_src_alpha, last_blend_dst_alpha);
+	if (!g_EngineOwnsGLState) glBindTexture(GL_TEXTURE_2D_ARRAY, (GLuint)last_texture_array);
+	ImGui_ImplOvr_StateRestore(last_state);
+}
+
+/**
+ * @brief Draws panel quads to both eyes with one instanced draw sampling the canvas atlas, see ImGui_ImplOvr_DrawPanelQuads().
+ * 
+ * @param proj The projection matrices of the left and right eye
+ * @param view The view matrices of the left and right eye
+ * @param single The only panel to draw, or nullptr to draw every panel
+ * @param singleModel The model matrix of the single panel's quad
+ */
+static void ImGui_ImplOvr_DrawPanelQuadsStereo(const glm::mat4 proj[2], const glm::mat4 view[2], const ImGui_ImplOvr_Context* single, glm::mat4 singleModel)
+{
+	if (!g_QuadStereoShaderHandle) return;
+
+	// Backup GL state
+	ImGui_ImplOvr_GLState last_state;
+	ImGui_ImplOvr_StateBackup(ImGuiVrStateBit_ActiveTexture | ImGuiVrStateBit_Program | ImGuiVrStateBit_ArrayBuffer
+		| ImGuiVrStateBit_VertexArray | ImGuiVrStateBit_Blend | ImGuiVrStateBit_CullFace | ImGuiVrStateBit_PolygonMode
+		| ImGuiVrStateBit_BlendEquation | ImGuiVrStateBit_BlendFunc, &last_state);
+	ImGui_ImplOvr_StateActiveTexture(GL_TEXTURE0);
+	GLint last_texture_array = 0, last_uniform_buffer = 0;
+	if (!g_EngineOwnsGLState) glGetIntegerv(GL_TEXTURE_BINDING_2D_ARRAY, &last_texture_array);
+	if (!g_EngineOwnsGLState) glGetIntegeri_v(GL_UNIFORM_BUFFER_BINDING, IMGUI_OVR_EYE_MATRICES_BINDING, &last_uniform_buffer);
+
+	// Setup render state: alpha-blending enabled, no face culling, polygon fill
+	ImGui_ImplOvr_StateEnable(ImGuiVrStateBit_Blend, GL_BLEND, true);
+	ImGui_ImplOvr_StateBlendEquation(GL_FUNC_ADD, GL_FUNC_ADD);
+	ImGui_ImplOvr_StateBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	ImGui_ImplOvr_StateEnable(ImGuiVrStateBit_CullFace, GL_CULL_FACE, false);
+	ImGui_ImplOvr_StatePolygonMode(GL_FILL);
+
+	const int instances = ImGui_ImplOvr_UploadPanelInstances(single, singleModel);
+	if (instances > 0)
+	{
+		ImGui_ImplOvr_UploadEyeMatrices(proj, view);
+		ImGui_ImplOvr_StateUseProgram(g_QuadStereoShaderHandle);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, g_CanvasAtlas.Texture);
+		glUniform1i(g_QuadStereoAttribLocationTex, 0);
+		ImGui_ImplOvr_StateBindVertexArray(ImGui_ImplOvr_GetContextVaos().QuadStereoVao);
+		ImGui_ImplOvr_DrawStereo(GL_TRIANGLES, sizeof(g_QuadIndices) / sizeof(*g_QuadIndices), true, instances);
+	}
+
+	// Restore modified GL state
+	if (!g_EngineOwnsGLState) glBindBufferBase(GL_UNIFORM_BUFFER, IMGUI_OVR_EYE_MATRICES_BINDING, (GLuint)last_uniform_buffer);
+	if (!g_EngineOwnsGLState) glBindTexture(GL_TEXTURE_2D_ARRAY, (GLuint)last_texture_array);
+	ImGui_ImplOvr_StateRestore(last_state);
+}
+
+/**
+ * @brief Renders the GUI virtual canvas quad of the current panel. Call this when you're rendering your VR scene
+ * and make sure that it gets rendered as any other geometry would in VR (i.e. by both eyes).
+ * 
+ * @param proj The projection matrix
+ * @param view The view matrix
+ * @param model The model matrix of the GUI quad. Use this to move it around to wherever you want it.
+ */
+void ImGui_ImplOvr_RenderGUIQuad(glm::mat4 proj, glm::mat4 view, glm::mat4 model)
+{
+	IMGUI_OVR_PROFILE_SCOPE("ImGui_ImplOvr_RenderGUIQuad");
+	const int gpu_phase = ImGui_ImplOvr_BeginGpuPhase("ImGui_ImplOvr_RenderGUIQuad");
+	ImGui_ImplOvr_DrawPanelQuads(proj, view, g_Ctx, model);
+	ImGui_ImplOvr_EndGpuPhase(gpu_phase);
+}
+
+/**
+ * @brief Renders the GUI quads of every panel with a single instanced draw, whatever the number of panels.
+ * Each instance carries the panel's model matrix and where its canvas lies in the canvas atlas.
+ * 
+ * @param proj The projection matrix
+ * @param view The view matrix
+ */
+void ImGui_ImplOvr_RenderPanels(glm::mat4 proj, glm::mat4 view)
+{
+	IMGUI_OVR_PROFILE_SCOPE("ImGui_ImplOvr_RenderPanels");
+	const int gpu_phase = ImGui_ImplOvr_BeginGpuPhase("ImGui_ImplOvr_RenderPanels");
+	ImGui_ImplOvr_DrawPanelQuads(proj, view, nullptr, glm::mat4(1));
+	ImGui_ImplOvr_EndGpuPhase(gpu_phase);
+}
+
+/**
+ * @brief Renders the GUI quads of every panel to both eyes in a single pass with a single instanced draw,
+ * see ImGui_ImplOvr_RenderPanels() and ImGui_ImplOvr_RenderGUIQuadStereo().
+ * 
+ * @param proj The projection matrices of the left and right eye
+ * @param view The view matrices of the left and right eye
+ */
+void ImGui_ImplOvr_RenderPanelsStereo(const glm::mat4 proj[2], const glm::mat4 view[2])
+{
+	IMGUI_OVR_PROFILE_SCOPE("ImGui_ImplOvr_RenderPanelsStereo");
+	const int gpu_phase = ImGui_ImplOvr_BeginGpuPhase("ImGui_ImplOvr_RenderPanelsStereo");
+	ImGui_ImplOvr_DrawPanelQuadsStereo(proj, view, nullptr, glm::mat4(1));
+	ImGui_ImplOvr_EndGpuPhase(gpu_phase);
+}
+
+/**
+ * @brief Renders the GUI virtual canvas quad of the current panel to both eyes in a single pass. Call this instead of
+ * ImGui_ImplOvr_RenderGUIQuad() when rendering both eyes at once into a layered framebuffer, with layer 0
+ * the left eye and layer 1 the right eye. With multiview the color attachment must be attached with
+ * glFramebufferTextureMultiviewOVR() for 2 views, otherwise as a layered attachment with glFramebufferTexture().
+ * 
+ * @note Does nothing if ImGui_ImplOvr_GetStereoMode() returns ImGuiVrStereoMode_None.
+ * 
+ * @param proj The projection matrices of the left and right eye
+ * @param view The view matrices of the left and right eye
+ * @param model The model matrix of the GUI quad
+ */
+void ImGui_ImplOvr_RenderGUIQuadStereo(const glm::mat4 proj[2], const glm::mat4 view[2], glm::mat4 model)
+{
+	IMGUI_OVR_PROFILE_SCOPE("ImGui_ImplOvr_RenderGUIQuadStereo");
+	const int gpu_phase = ImGui_ImplOvr_BeginGpuPhase("ImGui_ImplOvr_RenderGUIQuadStereo");
+	ImGui_ImplOvr_DrawPanelQuadsStereo(proj, view, g_Ctx, model);
+	ImGui_ImplOvr_EndGpuPhase(gpu_phase);
+}
+
+/**
+ * @brief Render the controller pointer line to both eyes in a single pass, see ImGui_ImplOvr_RenderGUIQuadStereo().
+ * 
+ * @note Will only be rendered if the controller is pointed at the virtual canvas.
+ * 
+ * @param proj The projection matrices of the left and right eye
+ * @param view The view matrices of the left and right eye
+ */
+void ImGui_ImplOvr_RenderControllerLineStereo(const glm::mat4 proj[2], const glm::mat4 view[2])
+{
+	IMGUI_OVR_PROFILE_SCOPE("ImGui_ImplOvr_RenderControllerLineStereo");
+	if (!g_MouseOverUI || !g_LineStereoShaderHandle) return;
+
+	// backup GL state
+	ImGui_ImplOvr_GLState last_state;
+	ImGui_ImplOvr_StateBackup(ImGuiVrStateBit_Program | ImGuiVrStateBit_ArrayBuffer | ImGuiVrStateBit_VertexArray
+		| ImGuiVrStateBit_DepthTest, &last_state);
+	GLint last_uniform_buffer = 0;
+	if (!g_EngineOwnsGLState) glGetIntegeri_v(GL_UNIFORM_BUFFER_BINDING, IMGUI_OVR_EYE_MATRICES_BINDING, &last_uniform_buffer);
+
+	GLfloat lineVerts[6] = { g_LineStart.x, g_LineStart.y, g_LineStart.z, g_LineEnd.x, g_LineEnd.y, g_LineEnd.z };
+
+	ImGui_ImplOvr_StateEnable(ImGuiVrStateBit_DepthTest, GL_DEPTH_TEST, false);
+
+	ImGui_ImplOvr_UploadEyeMatrices(proj, view);
+	ImGui_ImplOvr_StateBindVertexArray(ImGui_ImplOvr_GetContextVaos().LineVao);
+	ImGui_ImplOvr_StateBindArrayBuffer(g_LineVbo);
+	glBufferData(GL_ARRAY_BUFFER, 6 * sizeof(GLfloat), lineVerts, GL_STREAM_DRAW);
+	ImGui_ImplOvr_StateUseProgram(g_LineStereoShaderHandle);
+	glUniform3fv(g_LineStereoAttribLocationLineColor, 1, glm::value_ptr(g_LineColor));
+
+	ImGui_ImplOvr_DrawStereo(GL_LINES, 2, false);
+
+	// restore modified GL state
+	if (!g_EngineOwnsGLState) glBindBufferBase(GL_UNIFORM_BUFFER, IMGUI_OVR_EYE_MATRICES_BINDING, (GLuint)last_uniform_buffer);
+	ImGui_ImplOvr_StateRestore(last_state);
+}
+
+/**
+ * @brief Get the virtual canvas as a compositor quad layer, to submit with ovr_EndFrame() alongside the eye
+ * layer instead of drawing it with ImGui_ImplOvr_RenderGUIQuad(). The compositor then samples the canvas
+ * directly, which saves drawing it into both eye buffers and keeps text sharper through timewarp.
+ * 
+ * The canvas is only copied into the layer's swap chain and committed when it was redrawn since the last
+ * call, so call this once per HMD frame after ImGui_ImplOvr_RenderDrawData(), if the GUI was updated.
+ * 
+ * @note The layer is composited on top of the eye layer, so it isn't occluded by scene geometry.
+ * 
+ * @param model The model matrix of the GUI quad, as passed to ImGui_ImplOvr_RenderGUIQuad(). Like the pointer
+ * raycast, it's taken to be in the tracking space of the HMD.
+ * @return The quad layer header, or nullptr if there's nothing to show yet or the swap chain couldn't be created
+ */
+const ovrLayerHeader* ImGui_ImplOvr_GetCanvasLayer(glm::mat4 model)
+{
+	IMGUI_OVR_PROFILE_SCOPE("ImGui_ImplOvr_GetCanvasLayer");
+	if (!g_Ctx->CanvasDrawn) return nullptr;
+
+	if (!g_Ctx->LayerSwapChain || g_Ctx->LayerSize != g_Ctx->VirtualCanvasSize)
+	{
+		if (!ImGui_ImplOvr_CreateLayerSwapChain(g_Ctx)) return nullptr;
+	}
+
+	// copy the canvas into the next swap chain image, only if it changed
+	if (g_Ctx->LayerStale)
+	{
+		const GLuint texture = g_Hmd->get_swap_chain_buffer(g_Ctx->LayerSwapChain, g_Hmd->get_swap_chain_current_index(g_Ctx->LayerSwapChain));
+		const ImGui_ImplOvr_AtlasRect& rect = g_Ctx->CanvasRect;
+		for (int level = 0; level < g_Ctx->LayerLevels; level++)
+		{
+			const glm::ivec2 size = glm::min(g_Ctx->RasterSize + ((1 << level) - 1), g_Ctx->LayerSize) >> level;
+			if (size.x <= 0 || size.y <= 0) break;
+			glCopyImageSubData(g_CanvasAtlas.Texture, GL_TEXTURE_2D_ARRAY, level, rect.X >> level, rect.Y >> level, rect.Layer,
+				texture, GL_TEXTURE_2D, level, 0, 0, 0, size.x, size.y, 1);
+		}
+		g_Hmd->commit_swap_chain(g_Ctx->LayerSwapChain);
+		g_Ctx->LayerStale = false;
+	}
+
+	// split the model matrix into the layer pose and size, the quad spans [-1, 1] scaled by the canvas size in units
+	const glm::vec3 scale(glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])));
+	const glm::quat orientation = glm::quat_cast(glm::mat3(glm::vec3(model[0]) / scale.x, glm::vec3(model[1]) / scale.y, glm::vec3(model[2]) / scale.z));
+	const glm::vec3 position = glm::vec3(model[3]);
+
+	g_Ctx->CanvasLayer.Header.Type = ovrLayerType_Quad;
+	g_Ctx->CanvasLayer.Header.Flags = ovrLayerFlag_TextureOriginAtBottomLeft | ovrLayerFlag_HighQuality;
+	g_Ctx->CanvasLayer.ColorTexture = g_Ctx->LayerSwapChain;
+	g_Ctx->CanvasLayer.Viewport.Pos.x = 0;
+	g_Ctx->CanvasLayer.Viewport.Pos.y = 0;
+	g_Ctx->CanvasLayer.Viewport.Size.w = g_Ctx->RasterSize.x;
+	g_Ctx->CanvasLayer.Viewport.Size.h = g_Ctx->RasterSize.y;
+	g_Ctx->CanvasLayer.QuadPoseCenter.Orientation.x = orientation.x;
+	g_Ctx->CanvasLayer.QuadPoseCenter.Orientation.y = orientation.y;
+	g_Ctx->CanvasLayer.QuadPoseCenter.Orientation.z = orientation.z;
+	g_Ctx->CanvasLayer.QuadPoseCenter.Orientation.w = orientation.w;
+	g_Ctx->CanvasLayer.QuadPoseCenter.Position.x = position.x;
+	g_Ctx->CanvasLayer.QuadPoseCenter.Position.y = position.y;
+	g_Ctx->CanvasLayer.QuadPoseCenter.Position.z = position.z;
+	g_Ctx->CanvasLayer.QuadSize.x = 2.f * scale.x * g_Ctx->VirtualCanvasSize.x / g_Ctx->PixelsPerUnit;
+	g_Ctx->CanvasLayer.QuadSize.y = 2.f * scale.y * g_Ctx->VirtualCanvasSize.y / g_Ctx->PixelsPerUnit;
+
+	return &g_Ctx->CanvasLayer.Header;
 }
 
 /**
@@ -1037,36 +4559,28 @@ void ImGui_ImplOvr_RenderGUIQuad(glm::mat4 proj, glm::mat4 view, glm::mat4 model
  */
 void ImGui_ImplOvr_RenderControllerLine(glm::mat4 proj, glm::mat4 view)
 {
+	IMGUI_OVR_PROFILE_SCOPE("ImGui_ImplOvr_RenderControllerLine");
 	if (!g_MouseOverUI) return;
 	
 	// backup GL state
-	GLint last_program; glGetIntegerv(GL_CURRENT_PROGRAM, &last_program);
-	GLint last_array_buffer; glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &last_array_buffer);
-	GLboolean last_enable_depth_test = glIsEnabled(GL_DEPTH_TEST);
+	ImGui_ImplOvr_GLState last_state;
+	ImGui_ImplOvr_StateBackup(ImGuiVrStateBit_Program | ImGuiVrStateBit_ArrayBuffer | ImGuiVrStateBit_VertexArray
+		| ImGuiVrStateBit_DepthTest, &last_state);
 
 	GLfloat lineVerts[6] = { g_LineStart.x, g_LineStart.y, g_LineStart.z, g_LineEnd.x, g_LineEnd.y, g_LineEnd.z };
 
-	glDisable(GL_DEPTH_TEST);
+	ImGui_ImplOvr_StateEnable(ImGuiVrStateBit_DepthTest, GL_DEPTH_TEST, false);
 
-	glGenVertexArrays(1, &g_LineVao);
-	glBindVertexArray(g_LineVao);
-	glBindBuffer(GL_ARRAY_BUFFER, g_LineVbo);
+	ImGui_ImplOvr_StateBindVertexArray(ImGui_ImplOvr_GetContextVaos().LineVao);
+	ImGui_ImplOvr_StateBindArrayBuffer(g_LineVbo);
 	glBufferData(GL_ARRAY_BUFFER, 6 * sizeof(GLfloat), lineVerts, GL_STREAM_DRAW);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, false, 0, nullptr);
-	glUseProgram(g_LineShaderHandle);
+	ImGui_ImplOvr_StateUseProgram(g_LineShaderHandle);
 	glUniformMatrix4fv(g_LineAttribLocationProjMtx, 1, GL_FALSE, glm::value_ptr(proj));
 	glUniformMatrix4fv(g_LineAttribLocationViewMtx, 1, GL_FALSE, glm::value_ptr(view));
 	glUniform3fv(g_LineAttribLocationLineColor, 1, glm::value_ptr(g_LineColor));
 
 	glDrawArrays(GL_LINES, 0, 2);
-	glDisableVertexAttribArray(0);
-
-	glDeleteVertexArrays(1, &g_LineVao);
-	g_LineVao = 0;
 
 	// restore modified GL state
-	glUseProgram(last_program);
-	glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
-	if (last_enable_depth_test) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
+	ImGui_ImplOvr_StateRestore(last_state);
 }
@@ -18,16 +18,184 @@ enum ImGuiVrInputMode
 	ImGuiVrInputMode_OneHand
 };
 
+enum ImGuiVrGuiUpdateMode
+{
+	ImGuiVrGuiUpdateMode_EveryFrame,	// rebuild and rasterize the GUI every HMD frame
+	ImGuiVrGuiUpdateMode_FixedRate,		// rebuild the GUI at a fixed rate, e.g. 30 or 45 Hz
+	ImGuiVrGuiUpdateMode_OnInput		// rebuild the GUI only when the pointer, controller buttons or keyboard change
+};
+
+enum ImGuiVrStereoMode
+{
+	ImGuiVrStereoMode_None,				// no single pass stereo support, render each eye separately
+	ImGuiVrStereoMode_Multiview,		// GL_OVR_multiview, one draw renders both views of a 2 layer framebuffer
+	ImGuiVrStereoMode_InstancedLayer	// draws are instanced per eye and gl_Layer picks the layer (ARB_shader_viewport_layer_array)
+};
+
+enum ImGuiVrUploadMode
+{
+	ImGuiVrUploadMode_Auto,				// persistent mapped ring buffer if ARB_buffer_storage is available, orphaning otherwise
+	ImGuiVrUploadMode_Orphan,			// glBufferData(..., GL_STREAM_DRAW) per draw list
+	ImGuiVrUploadMode_PersistentRing	// glBufferStorage backed ring buffer written with memcpy
+};
+
+// Statistics of a panel's last ImGui vertex/index uploads, see ImGui_ImplOvr_GetUploadStats()
+struct ImGui_ImplOvr_UploadStats
+{
+	unsigned long long BytesUploaded;	// vertex + index bytes uploaded last frame
+	int BufferUpdates;					// number of glBufferData calls last frame
+	int RingWrites;						// number of copies into the persistent mapped ring buffer last frame, no GL calls
+	double UploadCpuTimeMs;				// CPU time spent uploading vertex/index data last frame
+	double RenderCpuTimeMs;				// CPU time spent in ImGui_ImplOvr_RenderDrawData() last frame
+	bool PersistentRing;				// true if the persistent mapped ring buffer was used last frame
+};
+
+// Counts of GL state changes made by the renderer, see ImGui_ImplOvr_GetStateStats()
+struct ImGui_ImplOvr_StateStats
+{
+	unsigned long long StateChanges;		// state changes passed on to GL
+	unsigned long long StateChangesElided;	// state changes skipped because the state was already set
+	unsigned long long StateQueries;		// glGet*/glIsEnabled queries made to back up GL state
+};
+
+// Statistics on reuse of a panel's rasterized virtual canvas, see ImGui_ImplOvr_GetCanvasStats()
+struct ImGui_ImplOvr_CanvasStats
+{
+	unsigned long long Frames;			// calls to ImGui_ImplOvr_RenderDrawData()
+	unsigned long long CacheHits;		// calls where the draw data was unchanged and the canvas wasn't redrawn
+	unsigned long long PartialRedraws;	// calls where only the damaged regions of the canvas were redrawn
+	float RedrawnFraction;				// fraction of the canvas area redrawn last time it was drawn
+	double HashCpuTimeMs;				// CPU time spent hashing the draw data last frame
+	float RasterScale;					// fraction of the virtual canvas size the canvas was last rasterized at
+	unsigned long long RasterScaleChanges;	// calls where the canvas was redrawn at a new raster size
+};
+
+// Size of the font atlas texture, see ImGui_ImplOvr_GetFontAtlasStats()
+struct ImGui_ImplOvr_FontAtlasStats
+{
+	int Width, Height;				// atlas size in pixels
+	unsigned long long Bytes;		// texture memory used by the atlas
+	bool Sdf;						// true if the atlas holds signed distance fields
+	double BuildCpuTimeMs;			// CPU time spent building and uploading the atlas
+};
+
+// Occupancy of the texture array the panel canvases are packed into, see ImGui_ImplOvr_GetCanvasAtlasStats()
+struct ImGui_ImplOvr_CanvasAtlasStats
+{
+	int LayerSize;						// width and height of each atlas layer in pixels
+	int Layers;							// layers in the atlas texture array
+	int Panels;							// panels with a canvas in the atlas
+	float Occupancy;					// fraction of the atlas area taken by panel canvases
+	unsigned long long Defragmentations;	// times the atlas was repacked into a new texture
+};
+
+// Device state sampled once per HMD frame, see ImGui_ImplOvr_SetDeviceSnapshot()
+struct ImGui_ImplOvr_DeviceSnapshot
+{
+	long long FrameIndex;				// HMD frame index the state was predicted for
+	double DisplayTime;					// predicted display time of the frame, in seconds
+	ovrTrackingState Tracking;			// head and hand poses at DisplayTime
+	ovrInputState Input;				// Touch controller buttons, triggers and thumbsticks
+};
+
+// Counts of the input polling thread's work, see ImGui_ImplOvr_GetInputPollingStats()
+struct ImGui_ImplOvr_InputPollingStats
+{
+	unsigned long long Samples;			// input states read from the input source
+	unsigned long long Events;			// button changes queued for the GUI
+	unsigned long long EventsDropped;	// button changes that found the queue full, they're queued again later
+	float TargetRate;					// samples per second asked for in ImGui_ImplOvr_StartInputPolling()
+	float AchievedRate;					// samples per second actually taken over the last second, 0 until then
+	bool Running;						// true if the polling thread is running
+};
+
+// GPU time of a named phase of a frame, see ImGui_ImplOvr_GetGpuTimings()
+struct ImGui_ImplOvr_GpuTiming
+{
+	const char* Name;					// the name passed to ImGui_ImplOvr_BeginGpuPhase()
+	double Milliseconds;				// GPU time of every phase with this name in the frame, summed
+	int Count;							// phases with this name in the frame, e.g. 2 for a quad drawn to each eye
+};
+
+// Counts of the CPU profiler's work, see ImGui_ImplOvr_GetProfilerStats()
+struct ImGui_ImplOvr_ProfilerStats
+{
+	unsigned long long Frames;				// frames ended with ImGui_ImplOvr_EndProfileFrame() while profiling
+	unsigned long long FramesOverBudget;	// frames that took longer than the flight recorder's budget
+	unsigned long long FlightRecordings;	// traces written by the flight recorder
+	unsigned long long EventsLost;			// events overwritten before the stream could write them
+	double LastFrameMs;						// wall time of the last frame
+};
+
+// Percentiles of a compositor timing over the perf stats history, in milliseconds
+struct ImGui_ImplOvr_PerfStatsPercentiles
+{
+	float P50, P90, P99, Max;
+};
+
+// The compositor's view of the frames in the perf stats history, see ImGui_ImplOvr_GetPerfStatsSummary()
+struct ImGui_ImplOvr_PerfStatsSummary
+{
+	int Frames;								// compositor frames in the history
+	long long FirstFrameIndex;				// HMD frame index shown by the oldest of them
+	long long LastFrameIndex;				// HMD frame index shown by the newest of them
+	int AppDroppedFrames;					// frames the app didn't deliver in time for the compositor
+	int CompositorDroppedFrames;			// frames the compositor itself didn't finish in time
+	int AswFrames;							// compositor frames ASW was active for
+	int AswActivations;						// times ASW was switched on or off
+	int AswPresentedFrames;					// frames ASW synthesized
+	int AswFailedFrames;					// frames ASW failed to synthesize
+	float AdaptiveGpuPerformanceScale;		// the runtime's advice from the last poll, below 1 means the GPU is overloaded
+	bool AswIsAvailable;					// whether ASW can kick in on this machine
+	unsigned long long StatsLost;			// polls where the runtime had shown more frames than it could report
+	ImGui_ImplOvr_PerfStatsPercentiles AppCpu;				// CPU time of the app's frames
+	ImGui_ImplOvr_PerfStatsPercentiles AppGpu;				// GPU time of the app's frames
+	ImGui_ImplOvr_PerfStatsPercentiles AppMotionToPhoton;	// from the app's tracking sample to photons
+	ImGui_ImplOvr_PerfStatsPercentiles AppQueueAhead;		// how far ahead of the compositor the app started frames
+	ImGui_ImplOvr_PerfStatsPercentiles CompositorCpu;		// CPU time of the compositor's frames
+	ImGui_ImplOvr_PerfStatsPercentiles CompositorGpu;		// GPU time of the compositor's frames
+	ImGui_ImplOvr_PerfStatsPercentiles CompositorLatency;	// from the compositor's tracking sample to photons
+};
+
+// Reads the current Touch input state, see ImGui_ImplOvr_SetInputSource(). Called on the input polling thread.
+typedef bool (*ImGui_ImplOvr_InputSourceFunc)(void* userData, ovrInputState* out_state);
+
 struct ImDrawData;
 
+// The HMD session calls the renderer makes go through this, see HmdBackend.h
+class HmdBackend;
+
+// A GUI panel: an ImGui context with its own virtual canvas, see ImGui_ImplOvr_CreateContext()
+struct ImGui_ImplOvr_Context;
+
 // functions called by user to use renderer
-bool ImGui_ImplOvr_Init(ovrSession session, long long* const frameIndex);
+bool ImGui_ImplOvr_Init(HmdBackend* hmd, long long* const frameIndex);
 void ImGui_ImplOvr_Shutdown();
+void ImGui_ImplOvr_CaptureDeviceSnapshot(ImGui_ImplOvr_DeviceSnapshot* out_snapshot);
+ImGui_ImplOvr_Context* ImGui_ImplOvr_CreateContext(glm::ivec2 canvasSize, glm::mat4 model);
+void ImGui_ImplOvr_DestroyContext(ImGui_ImplOvr_Context* ctx);
+void ImGui_ImplOvr_SetCurrentContext(ImGui_ImplOvr_Context* ctx);
+ImGui_ImplOvr_Context* ImGui_ImplOvr_GetCurrentContext();
+void ImGui_ImplOvr_SetContextModelMatrix(ImGui_ImplOvr_Context* ctx, glm::mat4 model);
+void ImGui_ImplOvr_UpdatePointer(glm::mat4 guiModelMatrix);
+bool ImGui_ImplOvr_ShouldUpdateGui();
 void ImGui_ImplOvr_NewFrame(glm::mat4 guiModelMatrix);
 void ImGui_ImplOvr_Update();
 void ImGui_ImplOvr_RenderDrawData(ImDrawData* draw_data);
 void ImGui_ImplOvr_RenderGUIQuad(glm::mat4 proj, glm::mat4 view, glm::mat4 model);
 void ImGui_ImplOvr_RenderControllerLine(glm::mat4 proj, glm::mat4 view);
+void ImGui_ImplOvr_RenderPanels(glm::mat4 proj, glm::mat4 view);
+void ImGui_ImplOvr_RenderPanelsStereo(const glm::mat4 proj[2], const glm::mat4 view[2]);
+void ImGui_ImplOvr_RenderGUIQuadStereo(const glm::mat4 proj[2], const glm::mat4 view[2], glm::mat4 model);
+void ImGui_ImplOvr_RenderControllerLineStereo(const glm::mat4 proj[2], const glm::mat4 view[2]);
+const ovrLayerHeader* ImGui_ImplOvr_GetCanvasLayer(glm::mat4 model);
+int ImGui_ImplOvr_BeginGpuPhase(const char* name);
+void ImGui_ImplOvr_EndGpuPhase(int phase);
+void ImGui_ImplOvr_EndProfileFrame();
+void ImGui_ImplOvr_PollPerfStats();
+void ImGui_ImplOvr_ResetPerfStats();
+void ImGui_ImplOvr_ShowPerfStatsWindow(bool* p_open = nullptr);
+bool ImGui_ImplOvr_WriteProfileTrace(const char* path, float seconds = 0.f);
 
 // mutation functions to modify various globals
 void ImGui_ImplOvr_SetVirtualCanvasSize(glm::ivec2 size);
@@ -36,6 +204,49 @@ void ImGui_ImplOvr_SetControllerLineColor(glm::vec3 color);
 void ImGui_ImplOvr_SetPixelsPerUnit(float ppu);
 void ImGui_ImplOvr_SetInputHand(ovrHandType hand);
 void ImGui_ImplOvr_SetInputMode(ImGuiVrInputMode mode);
+void ImGui_ImplOvr_SetDeviceSnapshot(const ImGui_ImplOvr_DeviceSnapshot* snapshot);
+void ImGui_ImplOvr_SetInputSource(ImGui_ImplOvr_InputSourceFunc func, void* userData);
+bool ImGui_ImplOvr_StartInputPolling(float rate = 500.f);
+void ImGui_ImplOvr_StopInputPolling();
+bool ImGui_ImplOvr_StartRecording(const char* path);
+void ImGui_ImplOvr_StopRecording();
+bool ImGui_ImplOvr_StartReplay(const char* path);
+void ImGui_ImplOvr_StopReplay();
+void ImGui_ImplOvr_SetGuiUpdateMode(ImGuiVrGuiUpdateMode mode, float rate = 0.f);
+void ImGui_ImplOvr_SetUploadMode(ImGuiVrUploadMode mode);
+void ImGui_ImplOvr_SetMergeDrawLists(bool merge);
+void ImGui_ImplOvr_SetCurrentContextFunc(void* (*func)());
+void ImGui_ImplOvr_SetEngineOwnsGLState(bool owns);
+void ImGui_ImplOvr_InvalidateGLState();
+void ImGui_ImplOvr_SetCanvasCaching(bool enable);
+void ImGui_ImplOvr_SetDamageTracking(bool enable);
+void ImGui_ImplOvr_SetAdaptiveCanvasResolution(bool enable, float minScale = 0.f);
+void ImGui_ImplOvr_SetEyeResolutionScale(float scale);
+void ImGui_ImplOvr_SetAlpha8FontAtlas(bool enable);
+void ImGui_ImplOvr_SetSdfFontAtlas(bool enable, float spread = 0.f);
+void ImGui_ImplOvr_SetGpuTiming(bool enable);
+void ImGui_ImplOvr_SetProfiling(bool enable);
+void ImGui_ImplOvr_SetProfileThreadName(const char* name);
+bool ImGui_ImplOvr_StartProfileStream(const char* path);
+void ImGui_ImplOvr_StopProfileStream();
+void ImGui_ImplOvr_SetFlightRecorder(const char* pathPrefix, float budgetMs, float seconds = 5.f);
+
+// query functions
+ImGuiVrStereoMode ImGui_ImplOvr_GetStereoMode();
+bool ImGui_ImplOvr_IsReplaying();
+unsigned long long ImGui_ImplOvr_GetReplayMismatches(unsigned long long* out_ticksChecked = nullptr);
+void ImGui_ImplOvr_GetUploadStats(ImGui_ImplOvr_UploadStats* out_stats);
+void ImGui_ImplOvr_GetStateStats(ImGui_ImplOvr_StateStats* out_stats);
+void ImGui_ImplOvr_ResetStateStats();
+void ImGui_ImplOvr_GetCanvasStats(ImGui_ImplOvr_CanvasStats* out_stats);
+void ImGui_ImplOvr_ResetCanvasStats();
+void ImGui_ImplOvr_GetFontAtlasStats(ImGui_ImplOvr_FontAtlasStats* out_stats);
+void ImGui_ImplOvr_GetCanvasAtlasStats(ImGui_ImplOvr_CanvasAtlasStats* out_stats);
+void ImGui_ImplOvr_GetInputPollingStats(ImGui_ImplOvr_InputPollingStats* out_stats);
+void ImGui_ImplOvr_GetProfilerStats(ImGui_ImplOvr_ProfilerStats* out_stats);
+void ImGui_ImplOvr_GetPerfStatsSummary(ImGui_ImplOvr_PerfStatsSummary* out_summary);
+bool ImGui_ImplOvr_GetPerfStatsOfFrame(long long frameIndex, ovrPerfStatsPerCompositorFrame* out_stats);
+int ImGui_ImplOvr_GetGpuTimings(ImGui_ImplOvr_GpuTiming* out_timings, int maxTimings, long long* out_frameIndex = nullptr);
 
 // called internally
 bool ImGui_ImplOvr_CreateFontsTexture();
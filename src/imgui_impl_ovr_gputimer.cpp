@@ -0,0 +1,158 @@
+// GPU timer queries for the Oculus Rift renderer (imgui_impl_ovr)
+// See imgui_impl_ovr_gputimer.h
+
+#include "imgui_impl_ovr_gputimer.h"
+
+#include <cstdio>
+#include <cstring>
+
+/**
+ * @brief Create the query objects. Call this with the GL context current.
+ *
+ * @return True if the queries were created
+ */
+bool ImGui_ImplOvr_GpuTimer::Create()
+{
+	if (IsCreated()) return true;
+
+	glGenQueries(IMGUI_OVR_GPU_TIMER_FRAMES * IMGUI_OVR_GPU_TIMER_MAX_PHASES * 2, &Queries[0][0][0]);
+	if (!IsCreated())
+	{
+		fprintf(stderr, "ERROR: ImGui_ImplOvr_GpuTimer::Create: can't create timer queries\n");
+		return false;
+	}
+
+	for (Frame& frame : Frames)
+	{
+		frame.FrameIndex = -1;
+		frame.PhaseCount = 0;
+		frame.LastQuery = 0;
+	}
+	Current = 0;
+	Enabled = false;
+	TimingCount = 0;
+	TimingFrameIndex = -1;
+	return true;
+}
+
+/**
+ * @brief Delete the query objects, dropping any results not read back yet.
+ */
+void ImGui_ImplOvr_GpuTimer::Destroy()
+{
+	if (!IsCreated()) return;
+
+	glDeleteQueries(IMGUI_OVR_GPU_TIMER_FRAMES * IMGUI_OVR_GPU_TIMER_MAX_PHASES * 2, &Queries[0][0][0]);
+	memset(Queries, 0, sizeof(Queries));
+	TimingCount = 0;
+	TimingFrameIndex = -1;
+}
+
+/**
+ * @brief Start recording a frame, if it isn't already being recorded. Moves on to the oldest slot of the ring and
+ * reads back the results of the frame recorded in it, unless the GPU hasn't finished it yet.
+ *
+ * @param frameIndex The HMD frame index
+ * @param enabled False to neither time phases nor push debug groups this frame
+ */
+void ImGui_ImplOvr_GpuTimer::BeginFrame(long long frameIndex, bool enabled)
+{
+	if (!IsCreated() || Frames[Current].FrameIndex == frameIndex) return;
+
+	Current = (Current + 1) % IMGUI_OVR_GPU_TIMER_FRAMES;
+	Resolve(Current);
+
+	Frame& frame = Frames[Current];
+	frame.FrameIndex = frameIndex;
+	frame.PhaseCount = 0;
+	frame.LastQuery = 0;
+	Enabled = enabled;
+}
+
+/**
+ * @brief Start a phase: push a debug group named after it and write a timestamp before its commands.
+ *
+ * @param name The name of the phase. Must outlive the timer, it's kept until the results are read back.
+ * @return The phase, to pass to End(), or -1 if it isn't timed
+ */
+int ImGui_ImplOvr_GpuTimer::Begin(const char* name)
+{
+	if (!IsCreated() || !Enabled) return -1;
+
+	Frame& frame = Frames[Current];
+	const int phase = frame.PhaseCount < IMGUI_OVR_GPU_TIMER_MAX_PHASES ? frame.PhaseCount++ : -1;
+
+	// KHR_debug is core in GL 4.3, but may be missing from older contexts
+	if (glPushDebugGroup) glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, (GLuint)(phase + 1), -1, name);
+
+	if (phase < 0) return -1;
+
+	frame.Names[phase] = name;
+	frame.Ended[phase] = false;
+	glQueryCounter(Queries[Current][phase][0], GL_TIMESTAMP);
+	frame.LastQuery = Queries[Current][phase][0];
+	return phase;
+}
+
+/**
+ * @brief End a phase started by Begin(): write a timestamp after its commands and pop its debug group.
+ *
+ * @param phase The phase returned by Begin()
+ */
+void ImGui_ImplOvr_GpuTimer::End(int phase)
+{
+	if (!IsCreated() || !Enabled) return;
+
+	Frame& frame = Frames[Current];
+	if (phase >= 0 && phase < frame.PhaseCount && !frame.Ended[phase])
+	{
+		glQueryCounter(Queries[Current][phase][1], GL_TIMESTAMP);
+		frame.Ended[phase] = true;
+		frame.LastQuery = Queries[Current][phase][1];
+	}
+
+	if (glPopDebugGroup) glPopDebugGroup();
+}
+
+/**
+ * @brief Read back the results of the frame recorded in a slot, summing the phases with the same name. Never
+ * waits on the GPU: if the frame's last query isn't available the frame is dropped.
+ *
+ * @param slot The slot in the ring
+ */
+void ImGui_ImplOvr_GpuTimer::Resolve(int slot)
+{
+	const Frame& frame = Frames[slot];
+	if (frame.FrameIndex < 0 || !frame.LastQuery) return;
+
+	// timestamps are written in order, so once the last one is available so are the others
+	GLint available = 0;
+	glGetQueryObjectiv(frame.LastQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+	{
+		FramesDropped++;
+		return;
+	}
+
+	TimingCount = 0;
+	TimingFrameIndex = frame.FrameIndex;
+	for (int phase = 0; phase < frame.PhaseCount; phase++)
+	{
+		// a phase that was never ended has no end timestamp to read
+		if (!frame.Ended[phase]) continue;
+
+		GLuint64 begin = 0, end = 0;
+		glGetQueryObjectui64v(Queries[slot][phase][0], GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(Queries[slot][phase][1], GL_QUERY_RESULT, &end);
+		const double ms = end > begin ? (end - begin) / 1e6 : 0.0;
+
+		int timing = 0;
+		while (timing < TimingCount && strcmp(Timings[timing].Name, frame.Names[phase]) != 0) timing++;
+		if (timing == TimingCount)
+		{
+			Timings[TimingCount++] = { frame.Names[phase], 0.0, 0 };
+		}
+		Timings[timing].Milliseconds += ms;
+		Timings[timing].Count++;
+	}
+}
@@ -0,0 +1,55 @@
+// GPU timer queries for the Oculus Rift renderer (imgui_impl_ovr)
+// Times named phases of each frame on the GPU and wraps them in KHR_debug groups, so GPU captures show the same
+// regions. A ring of query objects is kept per frame in flight and a frame's results are only read back when its
+// queries are about to be reused, IMGUI_OVR_GPU_TIMER_FRAMES frames later, so reading them never stalls the CPU.
+// Phases are timed with a pair of GL_TIMESTAMP queries rather than a GL_TIME_ELAPSED query: phases nest (the GUI
+// quad is drawn inside an eye pass) and only one GL_TIME_ELAPSED query can be active at a time.
+
+#pragma once
+
+#include "imgui_impl_ovr.h"
+
+#include <glad/glad.h>
+
+// Frames of queries in flight. A frame's results are read back this many frames after it was rendered.
+#define IMGUI_OVR_GPU_TIMER_FRAMES 4
+
+// Phases timed per frame. Phases past this still get a debug group, but aren't timed.
+#define IMGUI_OVR_GPU_TIMER_MAX_PHASES 32
+
+struct ImGui_ImplOvr_GpuTimer
+{
+	bool Create();
+	void Destroy();
+	bool IsCreated() const { return Queries[0][0][0] != 0; }
+
+	void BeginFrame(long long frameIndex, bool enabled);
+	int Begin(const char* name);
+	void End(int phase);
+
+	// GPU time of each phase name in the newest frame read back, and which frame that was
+	ImGui_ImplOvr_GpuTiming Timings[IMGUI_OVR_GPU_TIMER_MAX_PHASES];
+	int TimingCount = 0;
+	long long TimingFrameIndex = -1;
+
+	// frames whose queries weren't finished when they were due to be reused, their results are lost
+	unsigned long long FramesDropped = 0;
+
+private:
+	// the phases issued in one frame, and the queries they used
+	struct Frame
+	{
+		long long FrameIndex;
+		int PhaseCount;
+		const char* Names[IMGUI_OVR_GPU_TIMER_MAX_PHASES];
+		bool Ended[IMGUI_OVR_GPU_TIMER_MAX_PHASES];
+		GLuint LastQuery;	// the last query issued, once it's available every other query of the frame is too
+	};
+
+	void Resolve(int slot);
+
+	Frame Frames[IMGUI_OVR_GPU_TIMER_FRAMES] = {};
+	GLuint Queries[IMGUI_OVR_GPU_TIMER_FRAMES][IMGUI_OVR_GPU_TIMER_MAX_PHASES][2] = {};
+	int Current = 0;			// the slot of the frame being recorded
+	bool Enabled = false;		// only changes between frames, so a phase's End() always matches its Begin()
+};
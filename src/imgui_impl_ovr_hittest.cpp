@@ -0,0 +1,404 @@
+// Ray hit testing against GUI panel quads for the Oculus Rift renderer (imgui_impl_ovr)
+// See imgui_impl_ovr_hittest.h
+
+#include "imgui_impl_ovr_hittest.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// SSE is used whenever the compiler targets it, which x64 always does
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMGUI_OVR_HITTEST_SSE 1
+#include <xmmintrin.h>
+#else
+#define IMGUI_OVR_HITTEST_SSE 0
+#endif
+
+// Below this many panels every packet is tested, a BVH costs more to traverse than it saves
+#define IMGUI_OVR_HITTEST_BVH_MIN_PANELS 32
+
+// Deepest BVH traversal stack needed, the tree is balanced so this covers far more panels than we'll ever have
+#define IMGUI_OVR_HITTEST_MAX_DEPTH 64
+
+/**
+ * @brief Compute the world space bounds of a panel quad from the corners of its [-1, 1] local extent.
+ *
+ * @param model The model matrix of the panel
+ * @param out_min The minimum corner of the bounds
+ * @param out_max The maximum corner of the bounds
+ */
+static void ImGui_ImplOvr_PanelBounds(const glm::mat4& model, glm::vec3* out_min, glm::vec3* out_max)
+{
+	*out_min = glm::vec3(FLT_MAX);
+	*out_max = glm::vec3(-FLT_MAX);
+	for (int corner = 0; corner < 4; corner++)
+	{
+		const glm::vec3 p = glm::vec3(model * glm::vec4(corner & 1 ? 1.f : -1.f, corner & 2 ? 1.f : -1.f, 0.f, 1.f));
+		*out_min = glm::min(*out_min, p);
+		*out_max = glm::max(*out_max, p);
+	}
+}
+
+/**
+ * @brief Set the number of panels to test against. Panels keep their model matrices if they were already set,
+ * new ones have to be set with SetPanel() before casting rays.
+ *
+ * @param count The number of panels
+ */
+void ImGui_ImplOvr_HitTester::SetPanelCount(int count)
+{
+	if (count == (int)Models.size()) return;
+
+	Models.resize(count, glm::mat4(0));
+	Dirty.assign(count, true);
+	BoundsMin.resize(count);
+	BoundsMax.resize(count);
+	NeedsBuild = true;
+}
+
+/**
+ * @brief Set the model matrix of a panel's quad. The panel's world-to-local transform is only recomputed if the
+ * matrix changed since it was last set.
+ *
+ * @param index The index of the panel
+ * @param model The model matrix, including the scale of the quad to the panel's size in world units
+ */
+void ImGui_ImplOvr_HitTester::SetPanel(int index, const glm::mat4& model)
+{
+	if (Models[index] == model) return;
+
+	Models[index] = model;
+	Dirty[index] = true;
+	NeedsRefit = true;
+}
+
+/**
+ * @brief Find the nearest panel a ray hits. Both sides of a panel can be hit.
+ *
+ * @param origin The origin of the ray
+ * @param dir The direction of the ray
+ * @param useBvh False to test the ray against every panel even when there's a BVH, for comparison
+ * @return The nearest hit, with Panel -1 if there was none
+ */
+ImGui_ImplOvr_HitResult ImGui_ImplOvr_HitTester::CastRay(const glm::vec3& origin, const glm::vec3& dir, bool useBvh)
+{
+	Update();
+
+	ImGui_ImplOvr_HitResult best = { -1, FLT_MAX, glm::vec2(0) };
+	if (!useBvh || Nodes.empty())
+	{
+		for (size_t i = 0; i < Packets.size(); i++)
+		{
+			TestPacket(Packets[i], origin, dir, &best);
+		}
+		return best;
+	}
+
+	// slab test each node's bounds, visiting the nearer child first so the farther one can often be skipped
+	const glm::vec3 inv_dir = 1.0f / dir;
+	int stack[IMGUI_OVR_HITTEST_MAX_DEPTH];
+	float stack_entry[IMGUI_OVR_HITTEST_MAX_DEPTH];
+	int stack_size = 0;
+	stack[stack_size] = 0;
+	stack_entry[stack_size++] = 0.0f;
+	while (stack_size > 0)
+	{
+		// a nearer hit may have been found since the node was pushed
+		stack_size--;
+		if (stack_entry[stack_size] >= best.Distance) continue;
+
+		const Node& node = Nodes[stack[stack_size]];
+		if (node.Packet >= 0)
+		{
+			TestPacket(Packets[node.Packet], origin, dir, &best);
+			continue;
+		}
+
+		float entry[2];
+		const int children[2] = { (int)(&node - &Nodes[0]) + 1, node.SecondChild };
+		for (int c = 0; c < 2; c++)
+		{
+			const Node& child = Nodes[children[c]];
+			const glm::vec3 t0 = (child.Min - origin) * inv_dir;
+			const glm::vec3 t1 = (child.Max - origin) * inv_dir;
+			const glm::vec3 t_near = glm::min(t0, t1), t_far = glm::max(t0, t1);
+			const float t_enter = std::max(std::max(t_near.x, t_near.y), std::max(t_near.z, 0.0f));
+			const float t_exit = std::min(std::min(t_far.x, t_far.y), t_far.z);
+			entry[c] = t_enter <= t_exit && t_enter < best.Distance ? t_enter : FLT_MAX;
+		}
+
+		const int nearer = entry[1] < entry[0] ? 1 : 0;
+		for (int c = 1; c >= 0; c--)
+		{
+			const int child = c ? 1 - nearer : nearer;
+			if (entry[child] == FLT_MAX || stack_size == IMGUI_OVR_HITTEST_MAX_DEPTH) continue;
+			stack[stack_size] = children[child];
+			stack_entry[stack_size++] = entry[child];
+		}
+	}
+	return best;
+}
+
+/**
+ * @brief Bring the packets and BVH up to date with the panels' model matrices.
+ */
+void ImGui_ImplOvr_HitTester::Update()
+{
+	if (NeedsBuild)
+	{
+		Build();
+		return;
+	}
+	if (!NeedsRefit) return;
+
+	for (size_t i = 0; i < Models.size(); i++)
+	{
+		if (Dirty[i]) WritePanel((int)i);
+	}
+	if (!Nodes.empty()) Refit();
+	NeedsRefit = false;
+}
+
+/**
+ * @brief Recompute every panel's transform and lay the packets out again, with a BVH if there are enough panels.
+ */
+void ImGui_ImplOvr_HitTester::Build()
+{
+	const int count = (int)Models.size();
+	Order.resize(count);
+	Slots.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		Order[i] = i;
+
+		// panel bounds are needed to build the BVH before the packets are written
+		ImGui_ImplOvr_PanelBounds(Models[i], &BoundsMin[i], &BoundsMax[i]);
+	}
+
+	Packets.clear();
+	Nodes.clear();
+	if (count >= IMGUI_OVR_HITTEST_BVH_MIN_PANELS)
+	{
+		BuildNode(0, count);
+		Stats.BvhBuilds++;
+	}
+	else
+	{
+		// panels in index order, 4 to a packet
+		for (int begin = 0; begin < count; begin += 4)
+		{
+			Packets.push_back(Packet());
+		}
+	}
+
+	// packets were laid out in Order above, fill in where each panel went
+	for (int i = 0; i < count; i++)
+	{
+		Slots[Order[i]] = i;
+	}
+	for (size_t p = 0; p < Packets.size(); p++)
+	{
+		// lanes without a panel get a transform that never hits: the ray never reaches local z = 0
+		Packet& packet = Packets[p];
+		for (int lane = 0; lane < 4; lane++)
+		{
+			const int index = (int)p * 4 + lane;
+			packet.Panels[lane] = index < count ? Order[index] : -1;
+			for (int r = 0; r < 12; r++)
+			{
+				packet.Rows[r][lane] = r == 11 ? 1.f : 0.f;
+			}
+		}
+	}
+	for (int i = 0; i < count; i++)
+	{
+		WritePanel(i);
+	}
+
+	NeedsBuild = false;
+	NeedsRefit = false;
+}
+
+/**
+ * @brief Build the BVH node over a range of Order, splitting at the median panel on the axis its centers spread
+ * along the most. Ranges of up to 4 panels become leaves with a packet each.
+ *
+ * @param begin The first index into Order
+ * @param end One past the last index into Order
+ * @return The index of the node
+ */
+int ImGui_ImplOvr_HitTester::BuildNode(int begin, int end)
+{
+	const int index = (int)Nodes.size();
+	Nodes.push_back(Node());
+
+	glm::vec3 bounds_min(FLT_MAX), bounds_max(-FLT_MAX), center_min(FLT_MAX), center_max(-FLT_MAX);
+	for (int i = begin; i < end; i++)
+	{
+		const int panel = Order[i];
+		bounds_min = glm::min(bounds_min, BoundsMin[panel]);
+		bounds_max = glm::max(bounds_max, BoundsMax[panel]);
+		center_min = glm::min(center_min, (BoundsMin[panel] + BoundsMax[panel]) * 0.5f);
+		center_max = glm::max(center_max, (BoundsMin[panel] + BoundsMax[panel]) * 0.5f);
+	}
+	Nodes[index].Min = bounds_min;
+	Nodes[index].Max = bounds_max;
+
+	if (end - begin <= 4)
+	{
+		// Order[begin, end) is the range the packet's lanes are laid out from
+		Nodes[index].SecondChild = -1;
+		Nodes[index].Packet = (int)Packets.size();
+		Packets.push_back(Packet());
+		return index;
+	}
+
+	// split on a multiple of 4 so the leaves' packets are full
+	const glm::vec3 extent = center_max - center_min;
+	const int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+	const int mid = begin + std::max(4, ((end - begin) / 2 + 3) & ~3);
+	const std::vector<glm::vec3>& bmin = BoundsMin;
+	const std::vector<glm::vec3>& bmax = BoundsMax;
+	std::nth_element(Order.begin() + begin, Order.begin() + mid, Order.begin() + end, [&](int a, int b)
+	{
+		return bmin[a][axis] + bmax[a][axis] < bmin[b][axis] + bmax[b][axis];
+	});
+
+	Nodes[index].Packet = -1;
+	BuildNode(begin, mid);
+	const int second = BuildNode(mid, end);
+	Nodes[index].SecondChild = second;
+	return index;
+}
+
+/**
+ * @brief Update the BVH's bounds after panels moved, keeping its structure. Children always come after their
+ * parent, so walking the nodes backwards visits every child before its parent.
+ */
+void ImGui_ImplOvr_HitTester::Refit()
+{
+	for (int i = (int)Nodes.size() - 1; i >= 0; i--)
+	{
+		Node& node = Nodes[i];
+		if (node.Packet >= 0)
+		{
+			const Packet& packet = Packets[node.Packet];
+			node.Min = glm::vec3(FLT_MAX);
+			node.Max = glm::vec3(-FLT_MAX);
+			for (int lane = 0; lane < 4; lane++)
+			{
+				if (packet.Panels[lane] < 0) continue;
+				node.Min = glm::min(node.Min, BoundsMin[packet.Panels[lane]]);
+				node.Max = glm::max(node.Max, BoundsMax[packet.Panels[lane]]);
+			}
+		}
+		else
+		{
+			node.Min = glm::min(Nodes[i + 1].Min, Nodes[node.SecondChild].Min);
+			node.Max = glm::max(Nodes[i + 1].Max, Nodes[node.SecondChild].Max);
+		}
+	}
+	Stats.BvhRefits++;
+}
+
+/**
+ * @brief Recompute a panel's world-to-local transform and bounds from its model matrix, and write the transform
+ * into its packet lane.
+ *
+ * @param panel The index of the panel
+ */
+void ImGui_ImplOvr_HitTester::WritePanel(int panel)
+{
+	const glm::mat4 inv = glm::inverse(Models[panel]);
+	ImGui_ImplOvr_PanelBounds(Models[panel], &BoundsMin[panel], &BoundsMax[panel]);
+
+	// glm is column major, row r of the inverse is inv[0][r], inv[1][r], inv[2][r], inv[3][r]
+	Packet& packet = Packets[Slots[panel] / 4];
+	const int lane = Slots[panel] % 4;
+	for (int r = 0; r < 3; r++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			packet.Rows[r * 4 + c][lane] = inv[c][r];
+		}
+	}
+
+	Dirty[panel] = false;
+	Stats.TransformUpdates++;
+}
+
+/**
+ * @brief Test a ray against the 4 panels of a packet. The ray is moved into each panel's local space, where the
+ * quad lies in the z = 0 plane within [-1, 1] on x and y, and the hit is kept if it's nearer than the best so far.
+ *
+ * @param packet The packet to test
+ * @param origin The origin of the ray
+ * @param dir The direction of the ray
+ * @param best The nearest hit so far, updated if one of the panels is hit nearer
+ */
+void ImGui_ImplOvr_HitTester::TestPacket(const Packet& packet, const glm::vec3& origin, const glm::vec3& dir, ImGui_ImplOvr_HitResult* best)
+{
+	Stats.PacketTests++;
+
+	float t[4], x[4], y[4];
+	int hits = 0;
+#if IMGUI_OVR_HITTEST_SSE
+	const float (*rows)[4] = packet.Rows;
+	const __m128 ox = _mm_set1_ps(origin.x), oy = _mm_set1_ps(origin.y), oz = _mm_set1_ps(origin.z);
+	const __m128 dx = _mm_set1_ps(dir.x), dy = _mm_set1_ps(dir.y), dz = _mm_set1_ps(dir.z);
+
+	// local ray origin (w = 1) and direction (w = 0), one row of the transform at a time
+	#define IMGUI_OVR_ROW_DOT(r, vx, vy, vz) _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(rows[r * 4 + 0]), vx), \
+		_mm_mul_ps(_mm_loadu_ps(rows[r * 4 + 1]), vy)), _mm_mul_ps(_mm_loadu_ps(rows[r * 4 + 2]), vz))
+	const __m128 local_oz = _mm_add_ps(IMGUI_OVR_ROW_DOT(2, ox, oy, oz), _mm_loadu_ps(rows[11]));
+	const __m128 local_dz = IMGUI_OVR_ROW_DOT(2, dx, dy, dz);
+	const __m128 local_ox = _mm_add_ps(IMGUI_OVR_ROW_DOT(0, ox, oy, oz), _mm_loadu_ps(rows[3]));
+	const __m128 local_dx = IMGUI_OVR_ROW_DOT(0, dx, dy, dz);
+	const __m128 local_oy = _mm_add_ps(IMGUI_OVR_ROW_DOT(1, ox, oy, oz), _mm_loadu_ps(rows[7]));
+	const __m128 local_dy = IMGUI_OVR_ROW_DOT(1, dx, dy, dz);
+	#undef IMGUI_OVR_ROW_DOT
+
+	// where the ray crosses z = 0, parallel rays give inf or NaN which fail every comparison below
+	const __m128 vt = _mm_div_ps(_mm_sub_ps(_mm_setzero_ps(), local_oz), local_dz);
+	const __m128 vx = _mm_add_ps(local_ox, _mm_mul_ps(vt, local_dx));
+	const __m128 vy = _mm_add_ps(local_oy, _mm_mul_ps(vt, local_dy));
+
+	const __m128 sign = _mm_set1_ps(-0.0f), one = _mm_set1_ps(1.0f);
+	__m128 mask = _mm_and_ps(_mm_cmpge_ps(vt, _mm_setzero_ps()), _mm_cmplt_ps(vt, _mm_set1_ps(best->Distance)));
+	mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_andnot_ps(sign, vx), one));
+	mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_andnot_ps(sign, vy), one));
+	hits = _mm_movemask_ps(mask);
+	if (!hits) return;
+
+	_mm_storeu_ps(t, vt);
+	_mm_storeu_ps(x, vx);
+	_mm_storeu_ps(y, vy);
+#else
+	for (int lane = 0; lane < 4; lane++)
+	{
+		float local_o[3], local_d[3];
+		for (int r = 0; r < 3; r++)
+		{
+			local_o[r] = packet.Rows[r * 4 + 0][lane] * origin.x + packet.Rows[r * 4 + 1][lane] * origin.y + packet.Rows[r * 4 + 2][lane] * origin.z + packet.Rows[r * 4 + 3][lane];
+			local_d[r] = packet.Rows[r * 4 + 0][lane] * dir.x + packet.Rows[r * 4 + 1][lane] * dir.y + packet.Rows[r * 4 + 2][lane] * dir.z;
+		}
+		t[lane] = -local_o[2] / local_d[2];
+		x[lane] = local_o[0] + t[lane] * local_d[0];
+		y[lane] = local_o[1] + t[lane] * local_d[1];
+		if (t[lane] >= 0.0f && t[lane] < best->Distance && fabsf(x[lane]) <= 1.0f && fabsf(y[lane]) <= 1.0f)
+		{
+			hits |= 1 << lane;
+		}
+	}
+	if (!hits) return;
+#endif
+
+	for (int lane = 0; lane < 4; lane++)
+	{
+		if (!(hits & (1 << lane)) || t[lane] >= best->Distance) continue;
+		best->Panel = packet.Panels[lane];
+		best->Distance = t[lane];
+		best->Local = glm::vec2(x[lane], y[lane]);
+	}
+}
@@ -0,0 +1,74 @@
+// Ray hit testing against GUI panel quads for the Oculus Rift renderer (imgui_impl_ovr)
+// Each panel quad spans [-1, 1] on x and y of its local space, and is placed in the world by its model matrix.
+// The world-to-local transform of every panel is cached until its model matrix changes, rays are tested against
+// 4 panels at a time with SSE (one at a time where it isn't available), and above a handful of panels a BVH
+// skips the ones a ray can't reach.
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+// The nearest panel hit by a ray, see ImGui_ImplOvr_HitTester::CastRay()
+struct ImGui_ImplOvr_HitResult
+{
+	int Panel;			// index of the panel hit, -1 if the ray missed every panel
+	float Distance;		// distance along the ray to the hit point, in units of the ray direction's length
+	glm::vec2 Local;	// hit point in the panel's local space, within [-1, 1] on both axes
+};
+
+// Counts of the work done by a hit tester, see ImGui_ImplOvr_HitTester::GetStats()
+struct ImGui_ImplOvr_HitTestStats
+{
+	unsigned long long TransformUpdates;	// world-to-local transforms recomputed because a model matrix changed
+	unsigned long long BvhBuilds;			// BVH builds, after the number of panels changed
+	unsigned long long BvhRefits;			// BVH bounds updates, after panels moved
+	unsigned long long PacketTests;			// tests of a ray against a packet of 4 panels
+};
+
+// Hit tests rays against a set of panel quads, indexed from 0. Set the panel count and each panel's model matrix
+// whenever they change, and cast as many rays as needed in between.
+struct ImGui_ImplOvr_HitTester
+{
+	void SetPanelCount(int count);
+	int GetPanelCount() const { return (int)Models.size(); }
+	void SetPanel(int index, const glm::mat4& model);
+	ImGui_ImplOvr_HitResult CastRay(const glm::vec3& origin, const glm::vec3& dir, bool useBvh = true);
+	const ImGui_ImplOvr_HitTestStats& GetStats() const { return Stats; }
+
+private:
+	// World-to-local transforms of 4 panels, rows x, y and z of the affine inverse of their model matrices with
+	// one lane per panel: Rows[row * 4 + column][lane]. Unused lanes can never be hit. std::vector only guarantees
+	// 16 byte alignment from C++17 on, and not on 32-bit MSVC, so the rows are read with unaligned loads.
+	struct Packet
+	{
+		alignas(16) float Rows[12][4];
+		int Panels[4];
+	};
+
+	// A BVH node over panel bounds in world space. Inner nodes are followed by their first child, leaves test a
+	// single packet.
+	struct Node
+	{
+		glm::vec3 Min, Max;
+		int SecondChild;	// index of the second child, -1 for leaves
+		int Packet;			// index of the leaf's packet, -1 for inner nodes
+	};
+
+	void Update();
+	void Build();
+	int BuildNode(int begin, int end);
+	void Refit();
+	void WritePanel(int panel);
+	void TestPacket(const Packet& packet, const glm::vec3& origin, const glm::vec3& dir, ImGui_ImplOvr_HitResult* best);
+
+	std::vector<glm::mat4> Models;
+	std::vector<bool> Dirty;
+	std::vector<glm::vec3> BoundsMin, BoundsMax;
+	std::vector<int> Order;			// panel indices in packet order
+	std::vector<int> Slots;			// packet * 4 + lane of each panel
+	std::vector<Packet> Packets;
+	std::vector<Node> Nodes;		// empty if there are too few panels for a BVH to pay off
+	bool NeedsBuild = true, NeedsRefit = false;
+	ImGui_ImplOvr_HitTestStats Stats = {};
+};
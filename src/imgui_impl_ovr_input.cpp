@@ -0,0 +1,247 @@
+// Touch controller input polling thread for the Oculus Rift renderer (imgui_impl_ovr)
+// See imgui_impl_ovr_input.h
+
+#include "imgui_impl_ovr_input.h"
+#include "imgui_impl_ovr_profiler.h"
+
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <timeapi.h>
+#endif
+
+/**
+ * @brief Seconds on the steady clock, the time base of input events.
+ *
+ * @return The current time in seconds
+ */
+static double ImGui_ImplOvr_InputTime()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Reduce an input state to the digital inputs the renderer maps to ImGui, for both hands.
+ *
+ * @param state The input state
+ * @param thumbstickDeadzone How far the thumbstick has to be pushed in a direction for it to count as held
+ * @return The input mask, see ImGuiVrButton
+ */
+unsigned int ImGui_ImplOvr_GetButtons(const ovrInputState& state, float thumbstickDeadzone)
+{
+	unsigned int mask = 0;
+	for (int hand = ovrHand_Left; hand < ovrHand_Count; hand++)
+	{
+		const bool left = hand == ovrHand_Left;
+		unsigned int buttons = 0;
+		if (state.IndexTriggerRaw[hand] > 0.5f) buttons |= ImGuiVrButton_IndexTrigger;
+		if (state.HandTriggerRaw[hand] > 0.5f) buttons |= ImGuiVrButton_HandTrigger;
+		if (state.Buttons & (left ? ovrButton_LThumb : ovrButton_RThumb)) buttons |= ImGuiVrButton_Thumb;
+		if (state.Buttons & (left ? ovrButton_X : ovrButton_A)) buttons |= ImGuiVrButton_Lower;
+		if (state.Buttons & (left ? ovrButton_Y : ovrButton_B)) buttons |= ImGuiVrButton_Upper;
+		if (state.ThumbstickNoDeadzone[hand].y > thumbstickDeadzone) buttons |= ImGuiVrButton_StickUp;
+		if (state.ThumbstickNoDeadzone[hand].y < -thumbstickDeadzone) buttons |= ImGuiVrButton_StickDown;
+		if (state.ThumbstickNoDeadzone[hand].x < -thumbstickDeadzone) buttons |= ImGuiVrButton_StickLeft;
+		if (state.ThumbstickNoDeadzone[hand].x > thumbstickDeadzone) buttons |= ImGuiVrButton_StickRight;
+		mask |= buttons << (hand * IMGUI_OVR_INPUT_HAND_SHIFT);
+	}
+	return mask;
+}
+
+/**
+ * @brief Add an event to the back of the queue. Only call this from the producer thread.
+ *
+ * @param event The event
+ * @return False if the queue is full and the event was dropped
+ */
+bool ImGui_ImplOvr_InputQueue::Push(const ImGui_ImplOvr_InputEvent& event)
+{
+	const unsigned int tail = Tail.load(std::memory_order_relaxed);
+	if (tail - Head.load(std::memory_order_acquire) == IMGUI_OVR_INPUT_QUEUE_SIZE) return false;
+
+	Events[tail & (IMGUI_OVR_INPUT_QUEUE_SIZE - 1)] = event;
+	Tail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+/**
+ * @brief Read the event at the front of the queue without removing it. Only call this from the consumer thread.
+ *
+ * @param out_event Set to the event
+ * @return False if the queue is empty
+ */
+bool ImGui_ImplOvr_InputQueue::Peek(ImGui_ImplOvr_InputEvent* out_event) const
+{
+	const unsigned int head = Head.load(std::memory_order_relaxed);
+	if (head == Tail.load(std::memory_order_acquire)) return false;
+
+	*out_event = Events[head & (IMGUI_OVR_INPUT_QUEUE_SIZE - 1)];
+	return true;
+}
+
+/**
+ * @brief Remove the event at the front of the queue, which must not be empty. Only call this from the consumer thread.
+ */
+void ImGui_ImplOvr_InputQueue::Pop()
+{
+	Head.store(Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Check whether there are events to read. Only call this from the consumer thread.
+ *
+ * @return True if the queue is empty
+ */
+bool ImGui_ImplOvr_InputQueue::Empty() const
+{
+	return Head.load(std::memory_order_relaxed) == Tail.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Start sampling an input source on a new thread. Does nothing if the thread is already running.
+ *
+ * @param source The input source
+ * @param userData Passed to the input source
+ * @param rate How many times a second to sample the source
+ * @return True if the thread is running
+ */
+bool ImGui_ImplOvr_InputPoller::Start(ImGui_ImplOvr_InputSourceFunc source, void* userData, float rate)
+{
+	if (IsRunning()) return true;
+	if (!source || rate <= 0.f) return false;
+
+	Quit = false;
+	TargetRate = rate;
+	Thread = std::thread(&ImGui_ImplOvr_InputPoller::Run, this, source, userData, rate);
+	return true;
+}
+
+/**
+ * @brief Stop the polling thread and wait for it to exit. Events already queued can still be read.
+ */
+void ImGui_ImplOvr_InputPoller::Stop()
+{
+	if (!IsRunning()) return;
+
+	Quit = true;
+	Thread.join();
+}
+
+/**
+ * @brief The polling thread. Samples the source on a fixed schedule and queues an event whenever the digital
+ * inputs differ from the last sample.
+ *
+ * Waits for each sample by sleeping until IMGUI_OVR_INPUT_SPIN_US before it and spinning the rest of the way. On
+ * Windows the system timer's period is raised to 1 ms while polling, as sleeps otherwise round up to 15.6 ms and
+ * would hold polling near 64 Hz whatever the rate asked for.
+ *
+ * @param source The input source
+ * @param userData Passed to the input source
+ * @param rate How many times a second to sample the source
+ */
+void ImGui_ImplOvr_InputPoller::Run(ImGui_ImplOvr_InputSourceFunc source, void* userData, float rate)
+{
+	typedef std::chrono::steady_clock Clock;
+	const Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate));
+	const Clock::duration spin = std::chrono::microseconds(IMGUI_OVR_INPUT_SPIN_US);
+	Clock::time_point next = Clock::now();
+	unsigned int last = 0;
+	ImGui_ImplOvr_ProfileSetThreadName("input polling");
+
+	Clock::time_point rateStart = next;
+	unsigned long long rateSamples = 0;
+	AchievedRate = 0.f;
+
+#ifdef _WIN32
+	timeBeginPeriod(1);
+#endif
+
+	while (!Quit)
+	{
+		// the sleep below isn't part of the sample
+		{
+			IMGUI_OVR_PROFILE_SCOPE("ImGui_ImplOvr_InputPoller::sample");
+			ovrInputState state;
+			memset(&state, 0, sizeof(state));
+			if (source(userData, &state))
+			{
+				Samples++;
+				rateSamples++;
+				const unsigned int buttons = ImGui_ImplOvr_GetButtons(state, ThumbstickDeadzone);
+				if (buttons != last)
+				{
+					const ImGui_ImplOvr_InputEvent event = { ImGui_ImplOvr_InputTime(), buttons ^ last, buttons };
+					if (Queue.Push(event))
+					{
+						Events++;
+						last = buttons;
+					}
+					else
+					{
+						// try again next sample, the change is reported late rather than never
+						EventsDropped++;
+					}
+				}
+			}
+		}
+
+		// don't try to catch up on samples missed by a long stall
+		next += period;
+		const Clock::time_point now = Clock::now();
+		if (next < now)
+		{
+			next = now;
+		}
+
+		const double rateSeconds = std::chrono::duration<double>(now - rateStart).count();
+		if (rateSeconds >= IMGUI_OVR_INPUT_RATE_WINDOW)
+		{
+			AchievedRate = (float)(rateSamples / rateSeconds);
+			rateStart = now;
+			rateSamples = 0;
+		}
+
+		if (next - now > spin)
+		{
+			std::this_thread::sleep_until(next - spin);
+		}
+		while (Clock::now() < next)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+/**
+ * @brief Input source that plays back the script passed as its user data. The first sample starts the script,
+ * each sample gives the state of the last step that has taken effect, or a neutral state before the first.
+ *
+ * @param userData The ImGui_ImplOvr_ScriptedInput to play back
+ * @param out_state Set to the scripted input state
+ * @return Always true
+ */
+bool ImGui_ImplOvr_ScriptedInput::Source(void* userData, ovrInputState* out_state)
+{
+	ImGui_ImplOvr_ScriptedInput* script = static_cast<ImGui_ImplOvr_ScriptedInput*>(userData);
+
+	const double now = ImGui_ImplOvr_InputTime();
+	double start = script->StartTime;
+	if (start < 0.0)
+	{
+		script->StartTime = start = now;
+	}
+
+	memset(out_state, 0, sizeof(*out_state));
+	for (size_t i = 0; i < script->Steps.size() && script->Steps[i].Time <= now - start; i++)
+	{
+		*out_state = script->Steps[i].State;
+	}
+	out_state->TimeInSeconds = now;
+	return true;
+}
@@ -0,0 +1,110 @@
+// Touch controller input polling thread for the Oculus Rift renderer (imgui_impl_ovr)
+// Samples an input source (the Oculus SDK, or a script) much faster than the HMD frame rate, and queues an event
+// whenever a button, trigger or thumbstick direction changes, so presses shorter than a GUI tick aren't lost.
+
+#pragma once
+
+#include "imgui_impl_ovr.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Digital inputs of one hand, as the renderer maps them to ImGui. The left hand's are in the low 16 bits of an
+// input mask, the right hand's are shifted up by IMGUI_OVR_INPUT_HAND_SHIFT.
+enum ImGuiVrButton
+{
+	ImGuiVrButton_IndexTrigger	= 1 << 0,	// index trigger past half way
+	ImGuiVrButton_HandTrigger	= 1 << 1,	// hand trigger past half way
+	ImGuiVrButton_Thumb			= 1 << 2,	// thumbstick click
+	ImGuiVrButton_Lower			= 1 << 3,	// A or X
+	ImGuiVrButton_Upper			= 1 << 4,	// B or Y
+	ImGuiVrButton_StickUp		= 1 << 5,	// thumbstick outside the deadzone, in each direction
+	ImGuiVrButton_StickDown		= 1 << 6,
+	ImGuiVrButton_StickLeft		= 1 << 7,
+	ImGuiVrButton_StickRight	= 1 << 8
+};
+
+#define IMGUI_OVR_INPUT_HAND_SHIFT 16
+
+// Capacity of the event queue, a power of 2. Events are dropped if the GUI falls this far behind.
+#define IMGUI_OVR_INPUT_QUEUE_SIZE 256
+
+// How long before each sample the polling thread stops sleeping and spins instead, in microseconds. Sleeps overshoot
+// by up to the OS timer's period, which is 1 ms on Windows while polling, see ImGui_ImplOvr_InputPoller::Run().
+#ifdef _WIN32
+#define IMGUI_OVR_INPUT_SPIN_US 1500
+#else
+#define IMGUI_OVR_INPUT_SPIN_US 200
+#endif
+
+// Seconds of samples the achieved polling rate is measured over
+#define IMGUI_OVR_INPUT_RATE_WINDOW 1.0
+
+unsigned int ImGui_ImplOvr_GetButtons(const ovrInputState& state, float thumbstickDeadzone);
+
+// A change of one or more digital inputs
+struct ImGui_ImplOvr_InputEvent
+{
+	double Time;			// when the change was sampled, in seconds on the steady clock
+	unsigned int Changed;	// input mask of the inputs that changed
+	unsigned int Down;		// input mask of every input held after the change
+};
+
+// Lock-free queue of input events with a single producer (the polling thread) and a single consumer (the GUI)
+struct ImGui_ImplOvr_InputQueue
+{
+	bool Push(const ImGui_ImplOvr_InputEvent& event);
+	bool Peek(ImGui_ImplOvr_InputEvent* out_event) const;
+	void Pop();
+	bool Empty() const;
+
+private:
+	ImGui_ImplOvr_InputEvent Events[IMGUI_OVR_INPUT_QUEUE_SIZE];
+	std::atomic<unsigned int> Head = { 0 };	// next event to read, only written by the consumer
+	std::atomic<unsigned int> Tail = { 0 };	// next event to write, only written by the producer
+};
+
+// Samples an input source on its own thread at a fixed rate, queueing an event on every change
+struct ImGui_ImplOvr_InputPoller
+{
+	~ImGui_ImplOvr_InputPoller() { Stop(); }
+
+	bool Start(ImGui_ImplOvr_InputSourceFunc source, void* userData, float rate);
+	void Stop();
+	bool IsRunning() const { return Thread.joinable(); }
+
+	// read by the polling thread, so it can be changed while it runs
+	std::atomic<float> ThumbstickDeadzone = { 0.3f };
+
+	ImGui_ImplOvr_InputQueue Queue;
+	std::atomic<unsigned long long> Samples = { 0 };
+	std::atomic<unsigned long long> Events = { 0 };
+	std::atomic<unsigned long long> EventsDropped = { 0 };
+	std::atomic<float> AchievedRate = { 0.f };	// samples per second over the last IMGUI_OVR_INPUT_RATE_WINDOW
+	float TargetRate = 0.f;						// the rate passed to Start()
+
+private:
+	void Run(ImGui_ImplOvr_InputSourceFunc source, void* userData, float rate);
+
+	std::thread Thread;
+	std::atomic<bool> Quit = { false };
+};
+
+// An input source that plays back a script of input states, for driving the GUI without a controller. Pass
+// ImGui_ImplOvr_ScriptedInput::Source with the script as its user data to ImGui_ImplOvr_SetInputSource().
+struct ImGui_ImplOvr_ScriptedInput
+{
+	struct Step
+	{
+		double Time;			// seconds after the first sample that the state takes effect
+		ovrInputState State;
+	};
+
+	std::vector<Step> Steps;	// in order of time
+
+	static bool Source(void* userData, ovrInputState* out_state);
+
+private:
+	std::atomic<double> StartTime = { -1.0 };
+};
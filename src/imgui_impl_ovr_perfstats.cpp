@@ -0,0 +1,145 @@
+// Compositor performance stats for the Oculus Rift renderer (imgui_impl_ovr)
+// See imgui_impl_ovr_perfstats.h
+
+#include "imgui_impl_ovr_perfstats.h"
+
+#include <algorithm>
+
+/**
+ * @brief Add the compositor frames of one poll to the history, dropping the oldest entries once it's full.
+ *
+ * @param frameIndex The HMD frame being rendered
+ * @param stats What the runtime returned, most recent frame first
+ */
+void ImGui_ImplOvr_PerfStatsHistory::Add(long long frameIndex, const ovrPerfStats& stats)
+{
+	for (int i = std::min((int)stats.FrameStatsCount, (int)ovrMaxProvidedFrameStats) - 1; i >= 0; i--)
+	{
+		Entry& entry = Entries[Head];
+		entry.PolledFrameIndex = frameIndex;
+		entry.Stats = stats.FrameStats[i];
+		Head = (Head + 1) % IMGUI_OVR_PERF_STATS_HISTORY;
+		if (Count < IMGUI_OVR_PERF_STATS_HISTORY) Count++;
+	}
+
+	AdaptiveGpuPerformanceScale = stats.AdaptiveGpuPerformanceScale;
+	AswIsAvailable = stats.AswIsAvailable != ovrFalse;
+	if (stats.AnyFrameStatsDropped) StatsLost++;
+}
+
+/**
+ * @brief Forget every entry, e.g. after the runtime's counters were reset.
+ */
+void ImGui_ImplOvr_PerfStatsHistory::Clear()
+{
+	Head = Count = 0;
+	StatsLost = 0;
+}
+
+/**
+ * @brief Find the newest compositor frame that showed a given HMD frame.
+ *
+ * @param appFrameIndex The HMD frame index, as passed to ovr_EndFrame()
+ * @return The entry, or nullptr if no frame in the history showed it
+ */
+const ImGui_ImplOvr_PerfStatsHistory::Entry* ImGui_ImplOvr_PerfStatsHistory::Find(long long appFrameIndex) const
+{
+	for (int i = Count - 1; i >= 0; i--)
+	{
+		const Entry& entry = Get(i);
+		if (entry.Stats.AppFrameIndex == appFrameIndex) return &entry;
+	}
+	return nullptr;
+}
+
+/**
+ * @brief Get the percentiles of a timing, by nearest rank.
+ *
+ * @param values The timing of each frame in seconds, sorted in place
+ * @return The percentiles in milliseconds, all 0 if there are no values
+ */
+static ImGui_ImplOvr_PerfStatsPercentiles ImGui_ImplOvr_PerfStatsPercentilesOf(std::vector<float>& values)
+{
+	ImGui_ImplOvr_PerfStatsPercentiles percentiles = {};
+	if (values.empty()) return percentiles;
+
+	std::sort(values.begin(), values.end());
+	const size_t last = values.size() - 1;
+	percentiles.P50 = values[last * 50 / 100] * 1000.f;
+	percentiles.P90 = values[last * 90 / 100] * 1000.f;
+	percentiles.P99 = values[last * 99 / 100] * 1000.f;
+	percentiles.Max = values[last] * 1000.f;
+	return percentiles;
+}
+
+/**
+ * @brief Get how much one of the runtime's cumulative counters went up between two compositor frames.
+ *
+ * @param cur The counter in the later frame
+ * @param prev The counter in the earlier frame
+ * @return The increase, or the later count if the counter was reset in between, e.g. by ovr_ResetPerfStats()
+ */
+static int ImGui_ImplOvr_PerfStatsCounterIncrease(int cur, int prev)
+{
+	return cur >= prev ? cur - prev : cur;
+}
+
+/**
+ * @brief Summarise the history: how many frames were dropped or synthesized by ASW, and percentiles of each timing.
+ *
+ * @param out_summary Where to write the summary
+ */
+void ImGui_ImplOvr_PerfStatsHistory::Summarize(ImGui_ImplOvr_PerfStatsSummary* out_summary) const
+{
+	ImGui_ImplOvr_PerfStatsSummary& summary = *out_summary;
+	summary = ImGui_ImplOvr_PerfStatsSummary();
+	summary.Frames = Count;
+	summary.AdaptiveGpuPerformanceScale = AdaptiveGpuPerformanceScale;
+	summary.AswIsAvailable = AswIsAvailable;
+	summary.StatsLost = StatsLost;
+	if (Count == 0) return;
+
+	summary.FirstFrameIndex = Get(0).Stats.AppFrameIndex;
+	summary.LastFrameIndex = Get(Count - 1).Stats.AppFrameIndex;
+
+	// the runtime's counters are totals since the session started (or ovr_ResetPerfStats()), so sum their increases,
+	// counting from 0 again across a reset
+	for (int i = 0; i < Count; i++)
+	{
+		const ovrPerfStatsPerCompositorFrame& stats = Get(i).Stats;
+		if (stats.AswIsActive) summary.AswFrames++;
+		if (i == 0) continue;
+
+		const ovrPerfStatsPerCompositorFrame& prev = Get(i - 1).Stats;
+		summary.AppDroppedFrames += ImGui_ImplOvr_PerfStatsCounterIncrease(stats.AppDroppedFrameCount, prev.AppDroppedFrameCount);
+		summary.CompositorDroppedFrames += ImGui_ImplOvr_PerfStatsCounterIncrease(stats.CompositorDroppedFrameCount, prev.CompositorDroppedFrameCount);
+		summary.AswActivations += ImGui_ImplOvr_PerfStatsCounterIncrease(stats.AswActivatedToggleCount, prev.AswActivatedToggleCount);
+		summary.AswPresentedFrames += ImGui_ImplOvr_PerfStatsCounterIncrease(stats.AswPresentedFrameCount, prev.AswPresentedFrameCount);
+		summary.AswFailedFrames += ImGui_ImplOvr_PerfStatsCounterIncrease(stats.AswFailedFrameCount, prev.AswFailedFrameCount);
+	}
+
+	struct Timing
+	{
+		float ovrPerfStatsPerCompositorFrame::* Field;
+		ImGui_ImplOvr_PerfStatsPercentiles ImGui_ImplOvr_PerfStatsSummary::* Percentiles;
+	};
+	const Timing timings[] =
+	{
+		{ &ovrPerfStatsPerCompositorFrame::AppCpuElapsedTime, &ImGui_ImplOvr_PerfStatsSummary::AppCpu },
+		{ &ovrPerfStatsPerCompositorFrame::AppGpuElapsedTime, &ImGui_ImplOvr_PerfStatsSummary::AppGpu },
+		{ &ovrPerfStatsPerCompositorFrame::AppMotionToPhotonLatency, &ImGui_ImplOvr_PerfStatsSummary::AppMotionToPhoton },
+		{ &ovrPerfStatsPerCompositorFrame::AppQueueAheadTime, &ImGui_ImplOvr_PerfStatsSummary::AppQueueAhead },
+		{ &ovrPerfStatsPerCompositorFrame::CompositorCpuElapsedTime, &ImGui_ImplOvr_PerfStatsSummary::CompositorCpu },
+		{ &ovrPerfStatsPerCompositorFrame::CompositorGpuElapsedTime, &ImGui_ImplOvr_PerfStatsSummary::CompositorGpu },
+		{ &ovrPerfStatsPerCompositorFrame::CompositorLatency, &ImGui_ImplOvr_PerfStatsSummary::CompositorLatency }
+	};
+	for (const Timing& timing : timings)
+	{
+		Values.resize(Count);
+		for (int i = 0; i < Count; i++)
+		{
+			Values[i] = Get(i).Stats.*timing.Field;
+		}
+		summary.*timing.Percentiles = ImGui_ImplOvr_PerfStatsPercentilesOf(Values);
+	}
+}
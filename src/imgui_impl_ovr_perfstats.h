@@ -0,0 +1,46 @@
+// Compositor performance stats for the Oculus Rift renderer (imgui_impl_ovr)
+// The runtime reports the timing of each frame the compositor shows (ovr_GetPerfStats()), but only the last few
+// frames since the previous call. Polled once per HMD frame, they're kept in a history ring along with the HMD frame
+// they were polled in, and summarised as counts of dropped and ASW frames and percentiles of each timing.
+
+#pragma once
+
+#include "imgui_impl_ovr.h"
+
+#include <vector>
+
+// Compositor frames kept in the history, about 5.7 seconds at 90 Hz
+#define IMGUI_OVR_PERF_STATS_HISTORY 512
+
+// The stats of each compositor frame polled recently, oldest first
+struct ImGui_ImplOvr_PerfStatsHistory
+{
+	// A compositor frame. Stats.AppFrameIndex is the HMD frame it showed.
+	struct Entry
+	{
+		long long PolledFrameIndex;				// the HMD frame being rendered when the stats were polled
+		ovrPerfStatsPerCompositorFrame Stats;
+	};
+
+	void Add(long long frameIndex, const ovrPerfStats& stats);
+	void Clear();
+	int Size() const { return Count; }
+	const Entry& Get(int i) const { return Entries[(Head + IMGUI_OVR_PERF_STATS_HISTORY - Count + i) % IMGUI_OVR_PERF_STATS_HISTORY]; }
+	const Entry* Find(long long appFrameIndex) const;
+	void Summarize(ImGui_ImplOvr_PerfStatsSummary* out_summary) const;
+
+	// from the last poll
+	float AdaptiveGpuPerformanceScale = 1.f;
+	bool AswIsAvailable = false;
+
+	// polls where the runtime had shown more frames than it could report
+	unsigned long long StatsLost = 0;
+
+private:
+	Entry Entries[IMGUI_OVR_PERF_STATS_HISTORY];
+	int Head = 0;		// where the next entry goes
+	int Count = 0;
+
+	// scratch space for percentiles
+	mutable std::vector<float> Values;
+};
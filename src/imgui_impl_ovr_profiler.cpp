@@ -0,0 +1,361 @@
+// CPU frame phase profiler for the Oculus Rift renderer (imgui_impl_ovr)
+// See imgui_impl_ovr_profiler.h
+
+#include "imgui_impl_ovr_profiler.h"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+
+std::atomic<bool> g_ProfileEnabled = { false };
+
+// One recorded scope. The fields are atomics since a reader on another thread may copy a slot while its owner
+// overwrites it; such copies are detected and thrown away, see ImGui_ImplOvr_ProfileReadRing().
+struct ImGui_ImplOvr_ProfileSlot
+{
+	std::atomic<const char*> Name;
+	std::atomic<unsigned long long> Start;
+	std::atomic<unsigned long long> End;
+};
+
+// The events of one thread. Only the owning thread writes, any thread may read.
+struct ImGui_ImplOvr_ProfileRing
+{
+	ImGui_ImplOvr_ProfileSlot Slots[IMGUI_OVR_PROFILE_RING_SIZE];
+	std::atomic<unsigned long long> Reserved = { 0 };	// events started, the slot of the last may be half written
+	std::atomic<unsigned long long> Written = { 0 };	// events fully written
+	int Thread = 0;
+	std::string Name;									// guarded by g_ProfileRingsMutex
+};
+
+// Every thread's ring, in the order threads first recorded an event. Rings are never freed, so events of threads
+// that have exited can still be exported; the mutex is only taken to add a ring or to walk the list.
+static std::vector<std::unique_ptr<ImGui_ImplOvr_ProfileRing>> g_ProfileRings;
+static std::mutex g_ProfileRingsMutex;
+
+// The calling thread's ring, created by its first event
+static thread_local ImGui_ImplOvr_ProfileRing* t_ProfileRing = nullptr;
+
+// The name given to the calling thread before it had a ring
+static thread_local const char* t_ProfileThreadName = nullptr;
+
+/**
+ * @brief Get the calling thread's ring, creating it on first use.
+ *
+ * @return The ring
+ */
+static ImGui_ImplOvr_ProfileRing* ImGui_ImplOvr_ProfileThreadRing()
+{
+	if (!t_ProfileRing)
+	{
+		std::unique_ptr<ImGui_ImplOvr_ProfileRing> ring(new ImGui_ImplOvr_ProfileRing());
+		std::lock_guard<std::mutex> lock(g_ProfileRingsMutex);
+		ring->Thread = (int)g_ProfileRings.size();
+		if (t_ProfileThreadName) ring->Name = t_ProfileThreadName;
+		t_ProfileRing = ring.get();
+		g_ProfileRings.push_back(std::move(ring));
+	}
+	return t_ProfileRing;
+}
+
+/**
+ * @brief Nanoseconds on the steady clock since the profiler's epoch, the time base of every event.
+ *
+ * @return The current time
+ */
+unsigned long long ImGui_ImplOvr_ProfileNow()
+{
+	typedef std::chrono::steady_clock Clock;
+	static const Clock::time_point epoch = Clock::now();
+	return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count();
+}
+
+/**
+ * @brief Add an event to the calling thread's ring, overwriting its oldest event if the ring is full. Never blocks.
+ *
+ * @param name The name of the event. Must be a string literal, or otherwise outlive the profiler.
+ * @param start When the event started, see ImGui_ImplOvr_ProfileNow()
+ * @param end When the event ended
+ */
+void ImGui_ImplOvr_ProfileRecord(const char* name, unsigned long long start, unsigned long long end)
+{
+	ImGui_ImplOvr_ProfileRing* ring = ImGui_ImplOvr_ProfileThreadRing();
+	const unsigned long long index = ring->Written.load(std::memory_order_relaxed);
+
+	// claim the slot before touching it, so a reader copying the event it holds knows the copy may be torn
+	ring->Reserved.store(index + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	ImGui_ImplOvr_ProfileSlot& slot = ring->Slots[index & (IMGUI_OVR_PROFILE_RING_SIZE - 1)];
+	slot.Name.store(name, std::memory_order_relaxed);
+	slot.Start.store(start, std::memory_order_relaxed);
+	slot.End.store(end, std::memory_order_relaxed);
+	ring->Written.store(index + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Name the calling thread in exported traces. Doesn't create the thread's ring, so threads that never
+ * record an event cost nothing.
+ *
+ * @param name The name. Must be a string literal, or otherwise outlive the thread.
+ */
+void ImGui_ImplOvr_ProfileSetThreadName(const char* name)
+{
+	t_ProfileThreadName = name;
+	if (t_ProfileRing)
+	{
+		std::lock_guard<std::mutex> lock(g_ProfileRingsMutex);
+		t_ProfileRing->Name = name;
+	}
+}
+
+/**
+ * @brief Copy the events of a ring from a given index on, leaving out any the owning thread overwrote meanwhile.
+ *
+ * @param ring The ring
+ * @param from The index of the first event wanted, older events are skipped
+ * @param since Events that ended before this time are skipped
+ * @param out_events Where to append the events
+ * @return The index after the last event copied
+ */
+static unsigned long long ImGui_ImplOvr_ProfileReadRing(const ImGui_ImplOvr_ProfileRing& ring, unsigned long long from,
+	unsigned long long since, std::vector<ImGui_ImplOvr_ProfileEvent>* out_events)
+{
+	const unsigned long long written = ring.Written.load(std::memory_order_acquire);
+	if (written > IMGUI_OVR_PROFILE_RING_SIZE && from < written - IMGUI_OVR_PROFILE_RING_SIZE)
+	{
+		from = written - IMGUI_OVR_PROFILE_RING_SIZE;
+	}
+
+	const size_t first = out_events->size();
+	for (unsigned long long i = from; i < written; i++)
+	{
+		const ImGui_ImplOvr_ProfileSlot& slot = ring.Slots[i & (IMGUI_OVR_PROFILE_RING_SIZE - 1)];
+		const ImGui_ImplOvr_ProfileEvent event = { slot.Name.load(std::memory_order_relaxed),
+			slot.Start.load(std::memory_order_relaxed), slot.End.load(std::memory_order_relaxed), ring.Thread };
+		out_events->push_back(event);
+	}
+
+	// event i lives in the same slot as event i + IMGUI_OVR_PROFILE_RING_SIZE, which may have been claimed since
+	std::atomic_thread_fence(std::memory_order_acquire);
+	const unsigned long long reserved = ring.Reserved.load(std::memory_order_relaxed);
+	const unsigned long long valid = reserved > IMGUI_OVR_PROFILE_RING_SIZE ? reserved - IMGUI_OVR_PROFILE_RING_SIZE : 0;
+	size_t skip = valid > from ? (size_t)(valid - from) : 0;
+	if (skip > out_events->size() - first)
+	{
+		skip = out_events->size() - first;
+	}
+	out_events->erase(out_events->begin() + first, out_events->begin() + first + skip);
+
+	size_t kept = first;
+	for (size_t i = first; i < out_events->size(); i++)
+	{
+		if ((*out_events)[i].End >= since)
+		{
+			(*out_events)[kept++] = (*out_events)[i];
+		}
+	}
+	out_events->resize(kept);
+	return written;
+}
+
+/**
+ * @brief Copy the events of every thread that ended at or after a given time, as far back as the rings go.
+ *
+ * @param since The time, see ImGui_ImplOvr_ProfileNow(). 0 for every event still in the rings.
+ * @param out_events Where to append the events, grouped by thread and in order of when they ended
+ */
+void ImGui_ImplOvr_ProfileCollect(unsigned long long since, std::vector<ImGui_ImplOvr_ProfileEvent>* out_events)
+{
+	std::lock_guard<std::mutex> lock(g_ProfileRingsMutex);
+	for (const auto& ring : g_ProfileRings)
+	{
+		ImGui_ImplOvr_ProfileReadRing(*ring, 0, since, out_events);
+	}
+}
+
+/**
+ * @brief Copy the events of every thread recorded since the last call with the same cursor.
+ *
+ * @param cursor Where the last call left off, updated to where this one does
+ * @param out_events Where to append the events, grouped by thread and in order of when they ended
+ */
+void ImGui_ImplOvr_ProfileCollectNew(ImGui_ImplOvr_ProfileCursor* cursor, std::vector<ImGui_ImplOvr_ProfileEvent>* out_events)
+{
+	std::lock_guard<std::mutex> lock(g_ProfileRingsMutex);
+	cursor->Next.resize(g_ProfileRings.size(), 0);
+	for (size_t i = 0; i < g_ProfileRings.size(); i++)
+	{
+		const size_t before = out_events->size();
+		const unsigned long long from = cursor->Next[i];
+		const unsigned long long next = ImGui_ImplOvr_ProfileReadRing(*g_ProfileRings[i], from, 0, out_events);
+		const unsigned long long read = out_events->size() - before;
+		if (next - from > read)
+		{
+			cursor->Lost += next - from - read;
+		}
+		cursor->Next[i] = next;
+	}
+}
+
+/**
+ * @brief Write a string as a JSON string literal.
+ *
+ * @param file The file to write to
+ * @param str The string
+ */
+static void ImGui_ImplOvr_ProfileWriteString(FILE* file, const char* str)
+{
+	fputc('"', file);
+	for (; *str; str++)
+	{
+		if (*str == '"' || *str == '\\')
+		{
+			fputc('\\', file);
+			fputc(*str, file);
+		}
+		else if ((unsigned char)*str < 0x20)
+		{
+			fprintf(file, "\\u%04x", *str);
+		}
+		else
+		{
+			fputc(*str, file);
+		}
+	}
+	fputc('"', file);
+}
+
+/**
+ * @brief Write a metadata event naming each named thread, as elements of a trace event array.
+ *
+ * @param file The file to write to
+ * @param first True if nothing was written to the array yet, set to false once something is
+ */
+void ImGui_ImplOvr_ProfileWriteThreadNames(FILE* file, bool* first)
+{
+	std::lock_guard<std::mutex> lock(g_ProfileRingsMutex);
+	for (const auto& ring : g_ProfileRings)
+	{
+		if (ring->Name.empty()) continue;
+
+		fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", *first ? "" : ",", ring->Thread);
+		ImGui_ImplOvr_ProfileWriteString(file, ring->Name.c_str());
+		fprintf(file, "}}");
+		*first = false;
+	}
+}
+
+/**
+ * @brief Write events as complete ("X") events, as elements of a trace event array. Times are in microseconds.
+ *
+ * @param file The file to write to
+ * @param events The events
+ * @param first True if nothing was written to the array yet, set to false once something is
+ */
+void ImGui_ImplOvr_ProfileWriteEvents(FILE* file, const std::vector<ImGui_ImplOvr_ProfileEvent>& events, bool* first)
+{
+	for (const ImGui_ImplOvr_ProfileEvent& event : events)
+	{
+		fprintf(file, "%s\n{\"name\":", *first ? "" : ",");
+		ImGui_ImplOvr_ProfileWriteString(file, event.Name);
+		fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", event.Thread, event.Start / 1e3,
+			(event.End - event.Start) / 1e3);
+		*first = false;
+	}
+}
+
+/**
+ * @brief Write the events that ended at or after a given time as a Chrome trace.
+ *
+ * @param path The path of the trace
+ * @param since The time, see ImGui_ImplOvr_ProfileNow(). 0 for every event still in the rings.
+ * @return True if the trace was written
+ */
+bool ImGui_ImplOvr_ProfileWriteTrace(const char* path, unsigned long long since)
+{
+	FILE* file = fopen(path, "w");
+	if (!file)
+	{
+		fprintf(stderr, "ERROR: ImGui_ImplOvr_ProfileWriteTrace: can't create %s\n", path);
+		return false;
+	}
+
+	std::vector<ImGui_ImplOvr_ProfileEvent> events;
+	ImGui_ImplOvr_ProfileCollect(since, &events);
+
+	bool first = true;
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	ImGui_ImplOvr_ProfileWriteThreadNames(file, &first);
+	ImGui_ImplOvr_ProfileWriteEvents(file, events, &first);
+	fprintf(file, "\n]}\n");
+
+	fclose(file);
+	return true;
+}
+
+/**
+ * @brief Queue a task for the writer thread, starting the thread if it isn't running.
+ *
+ * @param task The task
+ */
+void ImGui_ImplOvr_ProfileWriter::Queue(std::function<void()> task)
+{
+	std::lock_guard<std::mutex> lock(Mutex);
+	if (!Thread.joinable())
+	{
+		Quit = false;
+		Thread = std::thread(&ImGui_ImplOvr_ProfileWriter::Run, this);
+	}
+	Tasks.push_back(std::move(task));
+	Wake.notify_one();
+}
+
+/**
+ * @brief Wait until every task queued so far has run.
+ */
+void ImGui_ImplOvr_ProfileWriter::Flush()
+{
+	std::unique_lock<std::mutex> lock(Mutex);
+	Idle.wait(lock, [this] { return Tasks.empty() && !Busy; });
+}
+
+/**
+ * @brief Run the tasks still queued, then end the writer thread. It starts again with the next task queued.
+ */
+void ImGui_ImplOvr_ProfileWriter::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		if (!Thread.joinable()) return;
+		Quit = true;
+		Wake.notify_one();
+	}
+	Thread.join();
+}
+
+/**
+ * @brief The writer thread. Runs queued tasks until told to quit with nothing left to run.
+ */
+void ImGui_ImplOvr_ProfileWriter::Run()
+{
+	ImGui_ImplOvr_ProfileSetThreadName("profile writer");
+
+	std::unique_lock<std::mutex> lock(Mutex);
+	for (;;)
+	{
+		Wake.wait(lock, [this] { return Quit || !Tasks.empty(); });
+		if (Tasks.empty()) break;
+
+		std::function<void()> task = std::move(Tasks.front());
+		Tasks.pop_front();
+		Busy = true;
+		lock.unlock();
+		task();
+		lock.lock();
+		Busy = false;
+		if (Tasks.empty()) Idle.notify_all();
+	}
+	Idle.notify_all();
+}
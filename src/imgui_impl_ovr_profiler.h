@@ -0,0 +1,90 @@
+// CPU frame phase profiler for the Oculus Rift renderer (imgui_impl_ovr)
+// Scoped timers write complete events into a ring buffer owned by the calling thread, so recording takes no locks
+// and threads never contend. Each ring keeps the latest IMGUI_OVR_PROFILE_RING_SIZE events, overwriting the oldest,
+// and can be read from another thread at any time to export the events as a Chrome trace (chrome://tracing,
+// https://ui.perfetto.dev). Timestamps come from the steady clock, in nanoseconds since the profiler's epoch.
+
+#pragma once
+
+#include "imgui_impl_ovr.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Events kept per thread, a power of 2. At 90 Hz and ~30 scopes a frame this holds about 12 seconds.
+#define IMGUI_OVR_PROFILE_RING_SIZE (1 << 15)
+
+// Time a scope, if profiling is enabled. The name must be a string literal.
+#define IMGUI_OVR_PROFILE_SCOPE(name) ImGui_ImplOvr_ProfileScope IMGUI_OVR_PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#define IMGUI_OVR_PROFILE_CONCAT(a, b) IMGUI_OVR_PROFILE_CONCAT2(a, b)
+#define IMGUI_OVR_PROFILE_CONCAT2(a, b) a##b
+
+extern std::atomic<bool> g_ProfileEnabled;
+
+unsigned long long ImGui_ImplOvr_ProfileNow();
+void ImGui_ImplOvr_ProfileRecord(const char* name, unsigned long long start, unsigned long long end);
+void ImGui_ImplOvr_ProfileSetThreadName(const char* name);
+
+// Records the time from its construction to its destruction as an event, see IMGUI_OVR_PROFILE_SCOPE()
+struct ImGui_ImplOvr_ProfileScope
+{
+	explicit ImGui_ImplOvr_ProfileScope(const char* name)
+		: Name(name), Enabled(g_ProfileEnabled.load(std::memory_order_relaxed)), Start(Enabled ? ImGui_ImplOvr_ProfileNow() : 0) {}
+	~ImGui_ImplOvr_ProfileScope() { if (Enabled) ImGui_ImplOvr_ProfileRecord(Name, Start, ImGui_ImplOvr_ProfileNow()); }
+
+	ImGui_ImplOvr_ProfileScope(const ImGui_ImplOvr_ProfileScope&) = delete;
+	ImGui_ImplOvr_ProfileScope& operator=(const ImGui_ImplOvr_ProfileScope&) = delete;
+
+	const char* Name;
+	bool Enabled;				// whether profiling was enabled when the scope began
+	unsigned long long Start;
+};
+
+// An event read back from a thread's ring
+struct ImGui_ImplOvr_ProfileEvent
+{
+	const char* Name;
+	unsigned long long Start, End;	// nanoseconds since the profiler's epoch
+	int Thread;						// the thread's index, in the order threads first recorded an event
+};
+
+// Where a reader left off in each thread's ring, so a stream only reads each event once
+struct ImGui_ImplOvr_ProfileCursor
+{
+	std::vector<unsigned long long> Next;	// the index of the next event to read, per thread
+	unsigned long long Lost = 0;			// events overwritten before they were read
+};
+
+void ImGui_ImplOvr_ProfileCollect(unsigned long long since, std::vector<ImGui_ImplOvr_ProfileEvent>* out_events);
+void ImGui_ImplOvr_ProfileCollectNew(ImGui_ImplOvr_ProfileCursor* cursor, std::vector<ImGui_ImplOvr_ProfileEvent>* out_events);
+void ImGui_ImplOvr_ProfileWriteThreadNames(FILE* file, bool* first);
+void ImGui_ImplOvr_ProfileWriteEvents(FILE* file, const std::vector<ImGui_ImplOvr_ProfileEvent>& events, bool* first);
+bool ImGui_ImplOvr_ProfileWriteTrace(const char* path, unsigned long long since);
+
+// Runs trace writes on a thread of its own, one at a time in the order they were queued, so the frame that queues one
+// doesn't wait on the disk. Tasks can read the rings like any other thread. The thread starts with the first task.
+struct ImGui_ImplOvr_ProfileWriter
+{
+	~ImGui_ImplOvr_ProfileWriter() { Stop(); }
+
+	void Queue(std::function<void()> task);
+	void Flush();
+	void Stop();
+
+private:
+	void Run();
+
+	std::thread Thread;
+	std::mutex Mutex;
+	std::condition_variable Wake;	// a task was queued, or the thread should quit
+	std::condition_variable Idle;	// the queue ran empty
+	std::deque<std::function<void()>> Tasks;
+	bool Busy = false;				// a task taken off the queue is running
+	bool Quit = false;
+};
@@ -0,0 +1,308 @@
+// Recording and replay of HMD device state for the Oculus Rift renderer (imgui_impl_ovr)
+// See imgui_impl_ovr_record.h
+
+#include "imgui_impl_ovr_record.h"
+
+#include <cstring>
+
+// Records are padded to this many bytes, so every record and payload is aligned when the file is memory mapped
+#define IMGUI_OVR_RECORD_ALIGN 8
+
+/**
+ * @brief Create a recording, replacing any file at the path, and write its header.
+ *
+ * @param path The path of the recording
+ * @return True if the recording was created
+ */
+bool ImGui_ImplOvr_DeviceRecorder::Open(const char* path)
+{
+	Close();
+
+	File = fopen(path, "wb");
+	if (!File)
+	{
+		fprintf(stderr, "ERROR: ImGui_ImplOvr_DeviceRecorder::Open: can't create %s\n", path);
+		return false;
+	}
+
+	ImGui_ImplOvr_RecordHeader header = {};
+	memcpy(header.Magic, IMGUI_OVR_RECORD_MAGIC, sizeof(header.Magic));
+	header.Version = IMGUI_OVR_RECORD_VERSION;
+	header.HeaderSize = sizeof(ImGui_ImplOvr_RecordHeader);
+	header.SnapshotSize = sizeof(ImGui_ImplOvr_DeviceSnapshot);
+	header.InputEventSize = sizeof(ImGui_ImplOvr_InputEvent);
+	fwrite(&header, sizeof(header), 1, File);
+	BytesWritten = sizeof(header);
+	FramesSinceFlush = 0;
+	return true;
+}
+
+/**
+ * @brief Finish the recording and close its file.
+ */
+void ImGui_ImplOvr_DeviceRecorder::Close()
+{
+	if (!File) return;
+
+	fclose(File);
+	File = nullptr;
+}
+
+/**
+ * @brief Append the device snapshot of an HMD frame.
+ *
+ * @param snapshot The snapshot
+ */
+void ImGui_ImplOvr_DeviceRecorder::WriteSnapshot(const ImGui_ImplOvr_DeviceSnapshot& snapshot)
+{
+	if (!File) return;
+
+	// the records of the frames before it are complete, flushing them now and then bounds what a crash loses
+	if (++FramesSinceFlush >= IMGUI_OVR_RECORD_FLUSH_FRAMES)
+	{
+		fflush(File);
+		FramesSinceFlush = 0;
+	}
+	WriteChunk(ImGuiVrRecord_Snapshot, &snapshot, sizeof(snapshot));
+}
+
+/**
+ * @brief Append the input events applied to ImGui on a GUI tick. An empty batch is still recorded, it marks a
+ * tick that read its buttons from polled events rather than from the snapshot.
+ *
+ * @param events The events
+ * @param count The number of events
+ */
+void ImGui_ImplOvr_DeviceRecorder::WriteInputEvents(const ImGui_ImplOvr_InputEvent* events, int count)
+{
+	WriteChunk(ImGuiVrRecord_InputEvents, events, (unsigned int)(count * sizeof(ImGui_ImplOvr_InputEvent)));
+}
+
+/**
+ * @brief Append a marker that the GUI was updated in the current HMD frame.
+ */
+void ImGui_ImplOvr_DeviceRecorder::WriteGuiTick()
+{
+	WriteChunk(ImGuiVrRecord_GuiTick, nullptr, 0);
+}
+
+/**
+ * @brief Append the hash of the input a GUI tick ended up with, once the tick's input has been applied to ImGui.
+ *
+ * @param hash The hash of the input panel's io.MousePos and io.NavInputs
+ */
+void ImGui_ImplOvr_DeviceRecorder::WriteTickHash(unsigned long long hash)
+{
+	WriteChunk(ImGuiVrRecord_TickHash, &hash, sizeof(hash));
+}
+
+/**
+ * @brief Append a record and pad it to the record alignment.
+ *
+ * @param type The ImGuiVrRecord type of the record
+ * @param data The payload
+ * @param size The size of the payload in bytes
+ */
+void ImGui_ImplOvr_DeviceRecorder::WriteChunk(unsigned int type, const void* data, unsigned int size)
+{
+	if (!File) return;
+
+	static const char padding[IMGUI_OVR_RECORD_ALIGN] = {};
+	const unsigned int padded = (size + IMGUI_OVR_RECORD_ALIGN - 1) & ~(IMGUI_OVR_RECORD_ALIGN - 1);
+	const ImGui_ImplOvr_RecordChunk chunk = { type, size };
+	fwrite(&chunk, sizeof(chunk), 1, File);
+	if (size > 0)
+	{
+		fwrite(data, size, 1, File);
+	}
+	fwrite(padding, padded - size, 1, File);
+	BytesWritten += sizeof(chunk) + padded;
+}
+
+/**
+ * @brief Open a recording for replay and check it was recorded with the same struct layouts.
+ *
+ * @param path The path of the recording
+ * @return True if the recording can be replayed
+ */
+bool ImGui_ImplOvr_DeviceReplay::Open(const char* path)
+{
+	Close();
+
+	File = fopen(path, "rb");
+	if (!File)
+	{
+		fprintf(stderr, "ERROR: ImGui_ImplOvr_DeviceReplay::Open: can't open %s\n", path);
+		return false;
+	}
+
+	ImGui_ImplOvr_RecordHeader header;
+	const bool read = fread(&header, sizeof(header), 1, File) == 1;
+	if (!read || memcmp(header.Magic, IMGUI_OVR_RECORD_MAGIC, sizeof(header.Magic)) != 0)
+	{
+		fprintf(stderr, "ERROR: ImGui_ImplOvr_DeviceReplay::Open: %s is not a device recording\n", path);
+		Close();
+		return false;
+	}
+	if (header.Version != IMGUI_OVR_RECORD_VERSION || header.SnapshotSize != sizeof(ImGui_ImplOvr_DeviceSnapshot) ||
+		header.InputEventSize != sizeof(ImGui_ImplOvr_InputEvent))
+	{
+		fprintf(stderr, "ERROR: ImGui_ImplOvr_DeviceReplay::Open: %s was recorded by an incompatible version (%u)\n", path, header.Version);
+		Close();
+		return false;
+	}
+
+	// later versions may extend the header, records start after it
+	fseek(File, header.HeaderSize, SEEK_SET);
+	Pending.Type = 0;
+	FramesRead = 0;
+	TicksChecked = 0;
+	Mismatches = 0;
+	return true;
+}
+
+/**
+ * @brief Close the recording.
+ */
+void ImGui_ImplOvr_DeviceReplay::Close()
+{
+	if (!File) return;
+
+	fclose(File);
+	File = nullptr;
+}
+
+/**
+ * @brief Read the device snapshot of the next HMD frame, skipping any input events of the last frame that
+ * weren't read.
+ *
+ * @param out_snapshot Set to the snapshot
+ * @return False at the end of the recording
+ */
+bool ImGui_ImplOvr_DeviceReplay::ReadFrame(ImGui_ImplOvr_DeviceSnapshot* out_snapshot)
+{
+	ImGui_ImplOvr_RecordChunk chunk;
+	while (ReadChunk(&chunk))
+	{
+		if (chunk.Type != ImGuiVrRecord_Snapshot || chunk.Size != sizeof(ImGui_ImplOvr_DeviceSnapshot))
+		{
+			if (!ReadPayload(chunk, nullptr, 0)) return false;
+			continue;
+		}
+
+		if (!ReadPayload(chunk, out_snapshot, sizeof(*out_snapshot))) return false;
+		FramesRead++;
+		return true;
+	}
+	return false;
+}
+
+/**
+ * @brief Read the input events of the next GUI tick in the current HMD frame.
+ *
+ * @param out_events Set to the events
+ * @return False if the tick read its buttons from the snapshot, or there are no more ticks in the frame
+ */
+bool ImGui_ImplOvr_DeviceReplay::ReadInputEvents(std::vector<ImGui_ImplOvr_InputEvent>* out_events)
+{
+	ImGui_ImplOvr_RecordChunk chunk;
+	if (!ReadChunk(&chunk)) return false;
+	if (chunk.Type != ImGuiVrRecord_InputEvents)
+	{
+		// the tick's input hash, or the next frame
+		Pending = chunk;
+		return false;
+	}
+
+	out_events->resize(chunk.Size / sizeof(ImGui_ImplOvr_InputEvent));
+	if (!ReadPayload(chunk, out_events->data(), (unsigned int)(out_events->size() * sizeof(ImGui_ImplOvr_InputEvent))))
+	{
+		out_events->clear();
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Check whether the GUI was updated in the current HMD frame. Call this once per frame, before reading
+ * the frame's input events.
+ *
+ * @return True if the GUI was updated
+ */
+bool ImGui_ImplOvr_DeviceReplay::ReadGuiTick()
+{
+	ImGui_ImplOvr_RecordChunk chunk;
+	if (!ReadChunk(&chunk)) return false;
+	if (chunk.Type != ImGuiVrRecord_GuiTick)
+	{
+		Pending = chunk;
+		return false;
+	}
+	return ReadPayload(chunk, nullptr, 0);
+}
+
+/**
+ * @brief Compare the input of the current GUI tick with the recording, once the replayed input has been applied to
+ * ImGui. The first tick that differs is reported, later ones are only counted.
+ *
+ * @param hash The hash of the input panel's io.MousePos and io.NavInputs
+ */
+void ImGui_ImplOvr_DeviceReplay::CheckTickHash(unsigned long long hash)
+{
+	// a tick recorded without any panel taking input, or cut short by a crash, has no hash
+	ImGui_ImplOvr_RecordChunk chunk;
+	if (!ReadChunk(&chunk)) return;
+	if (chunk.Type != ImGuiVrRecord_TickHash || chunk.Size != sizeof(unsigned long long))
+	{
+		Pending = chunk;
+		return;
+	}
+	unsigned long long recorded;
+	if (!ReadPayload(chunk, &recorded, sizeof(recorded))) return;
+
+	TicksChecked++;
+	if (hash != recorded)
+	{
+		if (Mismatches == 0)
+		{
+			fprintf(stderr, "ERROR: ImGui_ImplOvr_DeviceReplay::CheckTickHash: replay diverged from the recording at frame %llu, "
+				"the GUI input differs\n", FramesRead);
+		}
+		Mismatches++;
+	}
+}
+
+/**
+ * @brief Read the header of the next record, or take the one read ahead.
+ *
+ * @param out_chunk Set to the record header
+ * @return False at the end of the recording
+ */
+bool ImGui_ImplOvr_DeviceReplay::ReadChunk(ImGui_ImplOvr_RecordChunk* out_chunk)
+{
+	if (!File) return false;
+
+	if (Pending.Type != 0)
+	{
+		*out_chunk = Pending;
+		Pending.Type = 0;
+		return true;
+	}
+	return fread(out_chunk, sizeof(*out_chunk), 1, File) == 1;
+}
+
+/**
+ * @brief Read the start of a record's payload and skip the rest of it, along with its padding.
+ *
+ * @param chunk The record header
+ * @param data Where to read the payload to, can be nullptr if size is 0
+ * @param size How many bytes of the payload to read, at most chunk.Size
+ * @return False if the recording ends before the record does
+ */
+bool ImGui_ImplOvr_DeviceReplay::ReadPayload(const ImGui_ImplOvr_RecordChunk& chunk, void* data, unsigned int size)
+{
+	if (size > 0 && fread(data, size, 1, File) != 1) return false;
+
+	const unsigned int padded = (chunk.Size + IMGUI_OVR_RECORD_ALIGN - 1) & ~(IMGUI_OVR_RECORD_ALIGN - 1);
+	return padded == size || fseek(File, (long)(padded - size), SEEK_CUR) == 0;
+}
@@ -0,0 +1,99 @@
+// Recording and replay of HMD device state for the Oculus Rift renderer (imgui_impl_ovr)
+// Records every device snapshot and every batch of polled input events the renderer consumes, so a session can be
+// replayed without a headset and reproduce the same pointer and button input frame by frame.
+//
+// File format, all little endian and 8 byte aligned so a recording can be memory mapped and walked in place:
+//   ImGui_ImplOvr_RecordHeader
+//   records, each an ImGui_ImplOvr_RecordChunk followed by Size bytes of payload and padding to 8 bytes:
+//     ImGuiVrRecord_Snapshot:      one ImGui_ImplOvr_DeviceSnapshot, at the start of each HMD frame
+//     ImGuiVrRecord_GuiTick:       no payload, the GUI was updated in that frame
+//     ImGuiVrRecord_InputEvents:   the ImGui_ImplOvr_InputEvents applied to ImGui on a GUI tick of that frame
+//     ImGuiVrRecord_TickHash:      an unsigned long long hash of the input panel's io.MousePos and io.NavInputs once
+//                                  the GUI tick's input was applied, what a replay of the tick must reproduce
+// Records are only ever appended, a recording cut short by a crash is valid up to its last whole record. The file is
+// flushed every IMGUI_OVR_RECORD_FLUSH_FRAMES HMD frames, so a crash loses at most that many frames.
+
+#pragma once
+
+#include "imgui_impl_ovr.h"
+#include "imgui_impl_ovr_input.h"
+
+#include <cstdio>
+#include <vector>
+
+#define IMGUI_OVR_RECORD_MAGIC "IMOVRREC"
+#define IMGUI_OVR_RECORD_VERSION 2
+
+// HMD frames between flushes of a recording, about a second at 90 Hz
+#define IMGUI_OVR_RECORD_FLUSH_FRAMES 90
+
+enum ImGuiVrRecord
+{
+	ImGuiVrRecord_Snapshot = 1,
+	ImGuiVrRecord_InputEvents = 2,
+	ImGuiVrRecord_GuiTick = 3,
+	ImGuiVrRecord_TickHash = 4
+};
+
+struct ImGui_ImplOvr_RecordHeader
+{
+	char Magic[8];					// IMGUI_OVR_RECORD_MAGIC, not null terminated
+	unsigned int Version;			// IMGUI_OVR_RECORD_VERSION
+	unsigned int HeaderSize;		// sizeof(ImGui_ImplOvr_RecordHeader), records start here
+	unsigned int SnapshotSize;		// sizeof(ImGui_ImplOvr_DeviceSnapshot) when recorded, the SDK structs' layout must match
+	unsigned int InputEventSize;	// sizeof(ImGui_ImplOvr_InputEvent) when recorded
+	unsigned long long Reserved;
+};
+
+struct ImGui_ImplOvr_RecordChunk
+{
+	unsigned int Type;				// ImGuiVrRecord
+	unsigned int Size;				// payload bytes, not counting padding
+};
+
+// Appends device state to a recording as the renderer consumes it
+struct ImGui_ImplOvr_DeviceRecorder
+{
+	~ImGui_ImplOvr_DeviceRecorder() { Close(); }
+
+	bool Open(const char* path);
+	void Close();
+	bool IsOpen() const { return File != nullptr; }
+	void WriteSnapshot(const ImGui_ImplOvr_DeviceSnapshot& snapshot);
+	void WriteInputEvents(const ImGui_ImplOvr_InputEvent* events, int count);
+	void WriteGuiTick();
+	void WriteTickHash(unsigned long long hash);
+
+	unsigned long long BytesWritten = 0;
+
+private:
+	void WriteChunk(unsigned int type, const void* data, unsigned int size);
+
+	FILE* File = nullptr;
+	int FramesSinceFlush = 0;
+};
+
+// Streams a recording back one HMD frame at a time, so recordings of any length can be replayed
+struct ImGui_ImplOvr_DeviceReplay
+{
+	~ImGui_ImplOvr_DeviceReplay() { Close(); }
+
+	bool Open(const char* path);
+	void Close();
+	bool IsOpen() const { return File != nullptr; }
+	bool ReadFrame(ImGui_ImplOvr_DeviceSnapshot* out_snapshot);
+	bool ReadInputEvents(std::vector<ImGui_ImplOvr_InputEvent>* out_events);
+	bool ReadGuiTick();
+	void CheckTickHash(unsigned long long hash);
+
+	unsigned long long FramesRead = 0;
+	unsigned long long TicksChecked = 0;
+	unsigned long long Mismatches = 0;		// ticks whose input didn't hash to the recorded value
+
+private:
+	bool ReadChunk(ImGui_ImplOvr_RecordChunk* out_chunk);
+	bool ReadPayload(const ImGui_ImplOvr_RecordChunk& chunk, void* data, unsigned int size);
+
+	FILE* File = nullptr;
+	ImGui_ImplOvr_RecordChunk Pending = {};	// chunk header read ahead of its payload, Type 0 if none
+};
@@ -1,11 +1,22 @@
 #include "GL.h"
 
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include "Camera.h"
 #include "imgui.h"
 #include "VR.h"
 #include "imgui_impl_ovr.h"
+#include "imgui_impl_ovr_profiler.h"
 #include "imgui_impl_glfw.h"
+#include "SimHmdBackend.h"
+#ifdef _WIN32
+#include "OvrHmdBackend.h"
+#endif
+#ifdef __linux__
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
 
 // CONSTANTS
 const size_t WINDOW_WIDTH = 800;
@@ -16,9 +27,50 @@ const float FOV_DEGREES = 60;
 const float Z_NEAR = 0.1f;
 const float Z_FAR = 100;
 
+// submit the GUI canvas to the compositor as a quad layer instead of drawing it into the eye buffers; the controller
+// line is still drawn into the eye buffers, so the layer hides its tip where it meets the panel
+const bool GUI_AS_LAYER = false;
+
+// render both eyes in a single pass when the GL implementation supports it
+const bool SINGLE_PASS_STEREO = true;
+
+// sample Touch buttons on a separate thread this many times a second, so short clicks aren't lost between GUI
+// updates; 0 samples them once per frame
+const float INPUT_POLLING_RATE = 500.f;
+
+// range of the eye buffers' resolution, as a multiple of the HMD's recommended one, and the GPU time of the eye
+// passes to keep it under (0 for 70% of the HMD's frame time); the resolution drops when the eye passes run over
+const float MIN_EYE_RESOLUTION_SCALE = 0.6f;
+const float MAX_EYE_RESOLUTION_SCALE = 1.f;
+const float EYE_GPU_BUDGET_MS = 0.f;
+
+// show the compositor's perf stats and the renderer's own timings in a window on the main GUI panel
+const bool SHOW_PERF_STATS = true;
+
 // GLOBAL VARIABLES
-GLFWwindow* pWindow;
+GLFWwindow* pWindow = nullptr;
+
+// the Oculus runtime, or a simulated HMD with --sim
+HmdBackend* pHmd;
+
+// --headless renders a simulated HMD on a surfaceless EGL context, with no window or display server
+bool headless = false;
+#ifdef __linux__
+EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+EGLContext eglContext = EGL_NO_CONTEXT;
+#endif
+
+// set to leave the application loop, e.g. after the number of frames given with --frames
+bool quit = false;
+long long maxFrames = 0;
 glm::mat4 uiModelMatrix;
+glm::mat4 metricsModelMatrix;
+
+// second GUI panel showing ImGui metrics, beside the main one
+ImGui_ImplOvr_Context* pMetricsPanel;
+
+// set when replaying a recording given on the command line, the app exits once it runs out
+bool exitAfterReplay = false;
 
 // camera matrix, translated along z-axis for zoom back
 Camera camera;
@@ -40,7 +92,50 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 
 // END GLFW CALLBACKS
 
-bool initialize()
+bool initialize_headless()
+{
+#ifdef __linux__
+	// Mesa's surfaceless platform needs no window system at all, rendering goes to FBOs only
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+	if (getPlatformDisplay)
+	{
+		eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	}
+	if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, nullptr, nullptr))
+	{
+		std::cerr << "Could not init surfaceless EGL display!" << std::endl;
+		return false;
+	}
+
+	const EGLint contextAttribs[] =
+	{
+		EGL_CONTEXT_MAJOR_VERSION, (EGLint)GL_VER_MAJOR,
+		EGL_CONTEXT_MINOR_VERSION, (EGLint)GL_VER_MINOR,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+	eglBindAPI(EGL_OPENGL_API);
+	eglContext = eglCreateContext(eglDisplay, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttribs);
+	if (eglContext == EGL_NO_CONTEXT || !eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext))
+	{
+		std::cerr << "Could not create surfaceless EGL context!" << std::endl;
+		return false;
+	}
+
+	if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(eglGetProcAddress)))
+	{
+		std::cerr << "Failed to initialize GLAD" << std::endl;
+		return false;
+	}
+
+	return true;
+#else
+	std::cerr << "Headless mode needs EGL, it's only available on Linux" << std::endl;
+	return false;
+#endif
+}
+
+bool initialize_window()
 {
 	if (!glfwInit())
 	{
@@ -59,6 +154,9 @@ bool initialize()
 
 	glfwMakeContextCurrent(pWindow);
 
+	// turn off vsync and let the compositor "do its magic"
+	glfwSwapInterval(0);
+
 	if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress)))
 	{
 		std::cerr << "Failed to initialize GLAD" << std::endl;
@@ -68,7 +166,18 @@ bool initialize()
 	glfwSetFramebufferSizeCallback(pWindow, framebuffer_size_callback);
 	glfwSetKeyCallback(pWindow, key_callback);
 
+	return true;
+}
+
+bool initialize()
+{
+	if (!(headless ? initialize_headless() : initialize_window()))
+	{
+		return false;
+	}
+
 	uiModelMatrix = glm::translate(glm::mat4(1), glm::vec3(-1.f, 0, -1.f)) * glm::rotate(glm::mat4(1), glm::radians(30.f), glm::vec3(0, 1, 0));
+	metricsModelMatrix = glm::translate(glm::mat4(1), glm::vec3(1.f, 0, -1.2f)) * glm::rotate(glm::mat4(1), glm::radians(-30.f), glm::vec3(0, 1, 0));
 
 	return true;
 }
@@ -104,74 +213,249 @@ void init_imgui()
 
 
 	
-	ImGui_ImplOvr_Init(VR::vrSession, &VR::frameIndex);
+	// VAOs are cached per GL context, let the renderer tell them apart
+#ifdef __linux__
+	if (headless)
+		ImGui_ImplOvr_SetCurrentContextFunc([]() -> void* { return eglGetCurrentContext(); });
+	else
+#endif
+	ImGui_ImplOvr_SetCurrentContextFunc([]() -> void* { return glfwGetCurrentContext(); });
+
+	// text doesn't need the full HMD refresh rate, the GUI quad is still drawn every frame
+	ImGui_ImplOvr_SetGuiUpdateMode(ImGuiVrGuiUpdateMode_FixedRate, 45.f);
+	ImGui_ImplOvr_Init(VR::hmd, &VR::frameIndex);
+
+	// the pointer is read from the same tracking and input state the frame is rendered with
+	ImGui_ImplOvr_SetDeviceSnapshot(&VR::deviceSnapshot);
+
+	if (INPUT_POLLING_RATE > 0.f)
+	{
+		ImGui_ImplOvr_StartInputPolling(INPUT_POLLING_RATE);
+	}
 
-	ImGui_ImplGlfw_InitForOpenGL(pWindow, false);
+	if (pWindow)
+	{
+		ImGui_ImplGlfw_InitForOpenGL(pWindow, false);
+	}
+
+	// shares the font atlas and style of the main panel
+	pMetricsPanel = ImGui_ImplOvr_CreateContext(glm::ivec2(800, 600), metricsModelMatrix);
 }
 
 void process_input()
 {
-	if (glfwGetKey(pWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-		glfwSetWindowShouldClose(pWindow, true);
+	IMGUI_OVR_PROFILE_SCOPE("process_input");
+	if (pWindow && (glfwWindowShouldClose(pWindow) || glfwGetKey(pWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS))
+		quit = true;
+	if (exitAfterReplay && !ImGui_ImplOvr_IsReplaying())
+		quit = true;
+	if (maxFrames > 0 && VR::frameIndex >= maxFrames)
+		quit = true;
 }
 
 void render()
 {
-	ImGui_ImplOvr_RenderGUIQuad(VR::currentProjection, VR::currentView, uiModelMatrix);
+	if (!GUI_AS_LAYER)
+	{
+		ImGui_ImplOvr_RenderPanels(VR::currentProjection, VR::currentView);
+	}
 	ImGui_ImplOvr_RenderControllerLine(VR::currentProjection, VR::currentView);
 }
 
+void render_stereo()
+{
+	if (!GUI_AS_LAYER)
+	{
+		ImGui_ImplOvr_RenderPanelsStereo(VR::eyeProjections, VR::eyeViews);
+	}
+	ImGui_ImplOvr_RenderControllerLineStereo(VR::eyeProjections, VR::eyeViews);
+}
+
 void render_gui()
 {
+	IMGUI_OVR_PROFILE_SCOPE("render_gui");
 	ImGui::ShowTestWindow();
+	if (SHOW_PERF_STATS)
+	{
+		ImGui_ImplOvr_ShowPerfStatsWindow();
+
+		const DynamicResolution& resolution = VR::dynamicResolution;
+		ImGui::Begin("Eye resolution");
+		ImGui::Text("Scale %.2f (%d x %d), %llu changes", resolution.scale(), VR::layer.Viewport[0].Size.w,
+			VR::layer.Viewport[0].Size.h, resolution.changes());
+		ImGui::Text("Eye passes %.2f ms of %.2f ms", resolution.gpu_ms(), resolution.target_ms());
+		ImGui::End();
+	}
+}
+
+void render_metrics_gui()
+{
+	IMGUI_OVR_PROFILE_SCOPE("render_metrics_gui");
+	ImGui::SetNextWindowPos(ImVec2(0, 0));
+	ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+	ImGui::ShowMetricsWindow();
 }
 
 void application_loop()
 {
-	while (!glfwWindowShouldClose(pWindow))
+	ImGui_ImplOvr_SetProfileThreadName("main");
+
+	while (true)
 	{
 		process_input();
+		if (quit)
+			break;
+
+		// waits for the compositor, then samples the HMD and controllers once for the whole frame
+		VR::begin_frame();
 
-		// Start the Dear ImGui frame
-		ImGui_ImplGlfw_NewFrame();
-		ImGui_ImplOvr_NewFrame(uiModelMatrix);
-		ImGui::NewFrame();
+		// panels are rasterized no sharper than the eye buffers currently are
+		ImGui_ImplOvr_SetEyeResolutionScale(VR::dynamicResolution.scale());
 
-		render_gui();
+		// the pointer follows the controller every frame, even when the GUI isn't updated
+		ImGui_ImplOvr_UpdatePointer(uiModelMatrix);
 
-		ImGui_ImplOvr_Update();
+		if (ImGui_ImplOvr_ShouldUpdateGui())
+		{
+			IMGUI_OVR_PROFILE_SCOPE("update_gui");
 
-		// only need to render GUI once, not for each eye
-		ImGui::Render();
-		ImGui_ImplOvr_RenderDrawData(ImGui::GetDrawData());
-		    
-		VR::begin_frame();
+			// Start the Dear ImGui frame, without a window the renderer alone feeds ImGui
+			if (pWindow)
+			{
+				ImGui_ImplGlfw_NewFrame();
+			}
+			ImGui_ImplOvr_NewFrame(uiModelMatrix);
+			ImGui::NewFrame();
+
+			render_gui();
+
+			ImGui_ImplOvr_Update();
 
-		for (int eye = 0; eye < 2; eye++)
-		{	
-			VR::begin_eye(eye);
-			
-			render();
+			// only need to render GUI once, not for each eye
+			ImGui::Render();
+			ImGui_ImplOvr_RenderDrawData(ImGui::GetDrawData());
 
-			VR::end_eye(eye);
+			// the metrics panel gets its input from the renderer alone
+			ImGui_ImplOvr_SetCurrentContext(pMetricsPanel);
+			ImGui_ImplOvr_NewFrame(metricsModelMatrix);
+			ImGui::NewFrame();
+
+			render_metrics_gui();
+
+			ImGui::Render();
+			ImGui_ImplOvr_RenderDrawData(ImGui::GetDrawData());
+			ImGui_ImplOvr_SetCurrentContext(nullptr);
 		}
 
-		VR::end_frame();
+		if (VR::stereoBuffer)
+		{
+			IMGUI_OVR_PROFILE_SCOPE("render_eyes");
+			VR::begin_stereo();
+
+			render_stereo();
+
+			VR::end_stereo();
+		}
+		else
+		{
+			IMGUI_OVR_PROFILE_SCOPE("render_eyes");
+			for (int eye = 0; eye < 2; eye++)
+			{	
+				VR::begin_eye(eye);
+				
+				render();
+
+				VR::end_eye(eye);
+			}
+		}
+
+		const ovrLayerHeader* guiLayers[2] = {};
+		if (GUI_AS_LAYER)
+		{
+			guiLayers[0] = ImGui_ImplOvr_GetCanvasLayer(uiModelMatrix);
+			ImGui_ImplOvr_SetCurrentContext(pMetricsPanel);
+			guiLayers[1] = ImGui_ImplOvr_GetCanvasLayer(metricsModelMatrix);
+			ImGui_ImplOvr_SetCurrentContext(nullptr);
+		}
+		VR::end_frame(guiLayers, 2);
 		
-		glfwSwapBuffers(pWindow);
-		glfwPollEvents();
+		if (pWindow)
+		{
+			IMGUI_OVR_PROFILE_SCOPE("glfwSwapBuffers");
+			glfwSwapBuffers(pWindow);
+			glfwPollEvents();
+		}
+
+		ImGui_ImplOvr_EndProfileFrame();
 	}
 }
 
-int main()
+int main(int argc, char** argv)
 {
+	// --sim uses a simulated HMD instead of the Oculus runtime, --headless also renders without a window (Linux),
+	// --frames <n> exits after n frames, --record <file> records the tracking and input state of the session and
+	// --replay <file> plays one back, --trace <file> streams a Chrome trace of every frame and --flight-recorder
+	// <prefix> writes a trace of the last few seconds whenever a frame misses the HMD's frame budget
+	bool sim = false;
+	const char* recordPath = nullptr;
+	const char* replayPath = nullptr;
+	const char* tracePath = nullptr;
+	const char* flightRecorderPrefix = nullptr;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--sim") == 0)
+		{
+			sim = true;
+		}
+		else if (strcmp(argv[i], "--headless") == 0)
+		{
+			sim = headless = true;
+		}
+		else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+		{
+			maxFrames = atoll(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+		{
+			recordPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+		{
+			replayPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+		{
+			tracePath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--flight-recorder") == 0 && i + 1 < argc)
+		{
+			flightRecorderPrefix = argv[++i];
+		}
+	}
+
+#ifndef _WIN32
+	// LibOVR is Windows only
+	sim = true;
+#endif
+
 	if (!initialize())
 	{
 		return -1;
 	}
 	setup_opengl_state();
 
-	if (!VR::init(WINDOW_WIDTH, WINDOW_HEIGHT))
+#ifdef _WIN32
+	if (!sim)
+		pHmd = new OvrHmdBackend();
+	else
+#endif
+	pHmd = new SimHmdBackend();
+
+	DynamicResolutionConfig resolution;
+	resolution.minScale = MIN_EYE_RESOLUTION_SCALE;
+	resolution.maxScale = MAX_EYE_RESOLUTION_SCALE;
+	resolution.targetMs = EYE_GPU_BUDGET_MS;
+	if (!VR::init(pHmd, headless ? 0 : WINDOW_WIDTH, headless ? 0 : WINDOW_HEIGHT, resolution))
 	{
 		return -1;
 	}
@@ -179,16 +463,62 @@ int main()
 
 	init_imgui();
 
+	if (recordPath)
+	{
+		ImGui_ImplOvr_StartRecording(recordPath);
+	}
+	if (replayPath)
+	{
+		exitAfterReplay = ImGui_ImplOvr_StartReplay(replayPath);
+	}
+	if (tracePath)
+	{
+		ImGui_ImplOvr_StartProfileStream(tracePath);
+	}
+	if (flightRecorderPrefix)
+	{
+		ImGui_ImplOvr_SetFlightRecorder(flightRecorderPrefix, 1000.f / VR::hmdDesc.DisplayRefreshRate);
+	}
+
+	const ImGuiVrStereoMode stereoMode = SINGLE_PASS_STEREO ? ImGui_ImplOvr_GetStereoMode() : ImGuiVrStereoMode_None;
+	if (stereoMode != ImGuiVrStereoMode_None)
+	{
+		VR::init_stereo(stereoMode == ImGuiVrStereoMode_Multiview);
+	}
+
 	camera.pos.z = 0.1f;
 
 	application_loop();
 
+	// a replay that didn't reproduce the recorded input fails, so it can gate regression runs
+	unsigned long long replayTicks = 0;
+	const unsigned long long replayMismatches = ImGui_ImplOvr_GetReplayMismatches(&replayTicks);
+	if (replayPath)
+	{
+		std::cerr << "Replay: " << replayMismatches << " of " << replayTicks << " GUI ticks diverged from the recording" << std::endl;
+	}
+
 	// Cleanup
 	ImGui_ImplOvr_Shutdown();
-	ImGui_ImplGlfw_Shutdown();
+	if (pWindow)
+	{
+		ImGui_ImplGlfw_Shutdown();
+	}
 	ImGui::DestroyContext();
+	delete pHmd;
 
-	glfwDestroyWindow(pWindow);
-	glfwTerminate();
-	return 0;
+	if (pWindow)
+	{
+		glfwDestroyWindow(pWindow);
+		glfwTerminate();
+	}
+#ifdef __linux__
+	if (eglContext != EGL_NO_CONTEXT)
+	{
+		eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		eglDestroyContext(eglDisplay, eglContext);
+		eglTerminate(eglDisplay);
+	}
+#endif
+	return replayMismatches > 0 ? 1 : 0;
 }
\ No newline at end of file
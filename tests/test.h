@@ -0,0 +1,17 @@
+// Checks for the tests of the Oculus Rift renderer (imgui_impl_ovr)
+// Each test is a standalone executable on the simulated HMD. Failed checks are printed as they happen, and main()
+// returns how many failed, so ctest reports the test as failed if any did.
+
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+
+static int g_TestFailures = 0;
+
+#define TEST_CHECK(expr) \
+	do { if (!(expr)) { fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); g_TestFailures++; } } while (0)
+
+#define TEST_CHECK_NEAR(actual, expected, tolerance) \
+	do { const double a_ = (actual), e_ = (expected); if (!(std::fabs(a_ - e_) <= (tolerance))) { \
+		fprintf(stderr, "%s:%d: check failed: %s is %g, expected %g\n", __FILE__, __LINE__, #actual, a_, e_); g_TestFailures++; } } while (0)
@@ -0,0 +1,120 @@
+// The GUI canvas as a compositor quad layer (ImGui_ImplOvr_GetCanvasLayer())
+// Submits a frame of the eye layer and the canvas layer to the simulated HMD, and checks the quad the compositor
+// got is where the panel's model matrix puts it and as big as the drawn panel, twice its canvas size in units.
+
+#include "test.h"
+#include "bench.h"
+#include "GL.h"
+#include "imgui.h"
+#include "imgui_impl_ovr.h"
+#include "SimHmdBackend.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+int main()
+{
+	if (!Bench_CreateGLContext(true)) return 1;
+
+	SimHmdBackend hmd;
+	hmd.init();
+	long long frameIndex = 0;
+
+	ImGui::CreateContext();
+	ImGui::GetIO().Fonts->AddFontDefault();
+	ImGui_ImplOvr_SetCurrentContextFunc(Bench_GetCurrentGLContext);
+	ImGui_ImplOvr_SetGuiUpdateMode(ImGuiVrGuiUpdateMode_EveryFrame);
+	ImGui_ImplOvr_Init(&hmd, &frameIndex);
+
+	const glm::ivec2 canvasSize(1200, 900);
+	const float pixelsPerUnit = 800.f;
+	ImGui_ImplOvr_SetVirtualCanvasSize(canvasSize);
+	ImGui_ImplOvr_SetPixelsPerUnit(pixelsPerUnit);
+
+	// scaled as well as turned and moved, the scale ends up in the quad's size rather than its pose
+	const glm::mat4 model = glm::translate(glm::mat4(1), glm::vec3(0.5f, 1.2f, -1.5f))
+		* glm::rotate(glm::mat4(1), glm::radians(30.f), glm::vec3(0, 1, 0))
+		* glm::scale(glm::mat4(1), glm::vec3(1.5f));
+
+	// the eye layer, cleared to a color
+	ovrTextureSwapChainDesc desc = {};
+	desc.Type = ovrTexture_2D;
+	desc.Format = OVR_FORMAT_R8G8B8A8_UNORM_SRGB;
+	desc.ArraySize = 1;
+	desc.Width = 256;
+	desc.Height = 256;
+	desc.MipLevels = 1;
+	desc.SampleCount = 1;
+	ovrTextureSwapChain eyeChain = hmd.create_swap_chain(desc);
+	GLuint eyeFBO;
+	glGenFramebuffers(1, &eyeFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, eyeFBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+		hmd.get_swap_chain_buffer(eyeChain, hmd.get_swap_chain_current_index(eyeChain)), 0);
+	glClearColor(0.2f, 0.2f, 0.2f, 1.f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	hmd.commit_swap_chain(eyeChain);
+
+	ovrLayerEyeFov eyeLayer = {};
+	eyeLayer.Header.Type = ovrLayerType_EyeFov;
+	eyeLayer.Header.Flags = ovrLayerFlag_TextureOriginAtBottomLeft;
+	for (int eye = 0; eye < 2; eye++)
+	{
+		eyeLayer.ColorTexture[eye] = eyeChain;
+		eyeLayer.Viewport[eye].Size.w = desc.Width;
+		eyeLayer.Viewport[eye].Size.h = desc.Height;
+		eyeLayer.Fov[eye] = hmd.config().eyeFov[eye];
+		eyeLayer.RenderPose[eye].Orientation.w = 1.f;
+	}
+
+	// one GUI frame
+	hmd.wait_to_begin_frame(frameIndex);
+	hmd.begin_frame(frameIndex);
+	ImGui_ImplOvr_UpdatePointer(model);
+	ImGui_ImplOvr_NewFrame(model);
+	ImGui::NewFrame();
+	ImGui::Begin("Layer");
+	ImGui::Text("A quad layer");
+	ImGui::End();
+	ImGui_ImplOvr_Update();
+	ImGui::Render();
+	ImGui_ImplOvr_RenderDrawData(ImGui::GetDrawData());
+
+	const ovrLayerHeader* canvasLayer = ImGui_ImplOvr_GetCanvasLayer(model);
+	TEST_CHECK(canvasLayer != nullptr);
+
+	const ovrLayerHeader* layers[2] = { &eyeLayer.Header, canvasLayer };
+	TEST_CHECK(hmd.end_frame(frameIndex, layers, 2));
+
+	// the quad follows the eye layer, placed by the model matrix without its scale
+	const std::vector<SimLayer>& submitted = hmd.last_frame_layers();
+	TEST_CHECK(submitted.size() == 2);
+	if (submitted.size() == 2)
+	{
+		TEST_CHECK(submitted[0].header.Type == ovrLayerType_EyeFov);
+		TEST_CHECK(submitted[1].header.Type == ovrLayerType_Quad);
+
+		const ovrLayerQuad& quad = submitted[1].quad;
+		TEST_CHECK(quad.ColorTexture != nullptr);
+		TEST_CHECK_NEAR(quad.QuadPoseCenter.Position.x, model[3].x, 1e-5);
+		TEST_CHECK_NEAR(quad.QuadPoseCenter.Position.y, model[3].y, 1e-5);
+		TEST_CHECK_NEAR(quad.QuadPoseCenter.Position.z, model[3].z, 1e-5);
+
+		// q and -q are the same rotation
+		const glm::quat expected = glm::angleAxis(glm::radians(30.f), glm::vec3(0, 1, 0));
+		const ovrQuatf& actual = quad.QuadPoseCenter.Orientation;
+		const float dot = actual.x * expected.x + actual.y * expected.y + actual.z * expected.z + actual.w * expected.w;
+		TEST_CHECK_NEAR(std::fabs(dot), 1.0, 1e-5);
+
+		TEST_CHECK_NEAR(quad.QuadSize.x, 2.f * 1.5f * canvasSize.x / pixelsPerUnit, 1e-5);
+		TEST_CHECK_NEAR(quad.QuadSize.y, 2.f * 1.5f * canvasSize.y / pixelsPerUnit, 1e-5);
+	}
+
+	glDeleteFramebuffers(1, &eyeFBO);
+	hmd.destroy_swap_chain(eyeChain);
+	ImGui_ImplOvr_Shutdown();
+	ImGui::DestroyContext();
+	Bench_DestroyGLContext();
+	return g_TestFailures;
+}
@@ -0,0 +1,114 @@
+// Input polling (ImGui_ImplOvr_StartInputPolling())
+// Scripts a trigger press and release 4 ms apart, well inside one 90 Hz frame, while the right hand points at a
+// button covering the whole canvas. The polling thread must catch both changes, and the GUI must see them as one click.
+
+#include "test.h"
+#include "bench.h"
+#include "GL.h"
+#include "imgui.h"
+#include "imgui_impl_ovr.h"
+#include "imgui_impl_ovr_input.h"
+#include "SimHmdBackend.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cstdlib>
+
+// The press starts this long after polling does, and lasts this long
+#define TEST_PRESS_TIME 0.1
+#define TEST_PRESS_LENGTH 0.004
+
+// Rate the input source is polled at, and the HMD frames run, long enough at 90 Hz for a measure of the achieved rate
+#define TEST_POLLING_RATE 1000.f
+#define TEST_FRAMES 120
+
+/**
+ * @brief The head and the right hand look straight ahead, at the middle of the panel.
+ *
+ * @param userData Unused
+ * @param time Unused
+ * @param out_state Set to the poses
+ */
+static void Test_Poses(void* userData, double time, ovrTrackingState* out_state)
+{
+	out_state->HeadPose.ThePose.Orientation.w = 1.f;
+	out_state->HandPoses[ovrHand_Left].ThePose.Orientation.w = 1.f;
+	out_state->HandPoses[ovrHand_Right].ThePose.Orientation.w = 1.f;
+}
+
+int main()
+{
+	if (!Bench_CreateGLContext(true)) return 1;
+
+	SimHmdConfig config;
+	config.poses = Test_Poses;
+	config.throttle = true;
+	SimHmdBackend hmd(config);
+	hmd.init();
+	long long frameIndex = 0;
+
+	ImGui::CreateContext();
+	ImGui::GetIO().Fonts->AddFontDefault();
+	ImGui_ImplOvr_SetCurrentContextFunc(Bench_GetCurrentGLContext);
+	ImGui_ImplOvr_SetGuiUpdateMode(ImGuiVrGuiUpdateMode_EveryFrame);
+	ImGui_ImplOvr_Init(&hmd, &frameIndex);
+	ImGui_ImplOvr_SetInputHand(ovrHand_Right);
+
+	ImGui_ImplOvr_ScriptedInput script;
+	ImGui_ImplOvr_ScriptedInput::Step press = { TEST_PRESS_TIME, {} };
+	press.State.IndexTriggerRaw[ovrHand_Right] = 1.f;
+	ImGui_ImplOvr_ScriptedInput::Step release = { TEST_PRESS_TIME + TEST_PRESS_LENGTH, {} };
+	script.Steps.push_back(press);
+	script.Steps.push_back(release);
+	ImGui_ImplOvr_SetInputSource(ImGui_ImplOvr_ScriptedInput::Source, &script);
+	TEST_CHECK(ImGui_ImplOvr_StartInputPolling(TEST_POLLING_RATE));
+
+	const glm::mat4 model = glm::translate(glm::mat4(1), glm::vec3(0.f, 0.f, -1.f));
+	int clicks = 0;
+	for (int frame = 0; frame < TEST_FRAMES; frame++)
+	{
+		frameIndex++;
+		hmd.wait_to_begin_frame(frameIndex);
+		hmd.begin_frame(frameIndex);
+		ImGui_ImplOvr_UpdatePointer(model);
+		ImGui_ImplOvr_NewFrame(model);
+		ImGui::NewFrame();
+		ImGui::SetNextWindowPos(ImVec2(0.f, 0.f), ImGuiCond_Always);
+		ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize, ImGuiCond_Always);
+		ImGui::Begin("Click", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove);
+		if (ImGui::Button("Click me", ImVec2(-1.f, -1.f)))
+		{
+			clicks++;
+		}
+		ImGui::End();
+		ImGui_ImplOvr_Update();
+		ImGui::Render();
+		ImGui_ImplOvr_RenderDrawData(ImGui::GetDrawData());
+		hmd.end_frame(frameIndex, nullptr, 0);
+	}
+
+	ImGui_ImplOvr_InputPollingStats stats;
+	ImGui_ImplOvr_GetInputPollingStats(&stats);
+	ImGui_ImplOvr_StopInputPolling();
+
+	// both changes were sampled and queued, and replayed into ImGui on separate frames
+	TEST_CHECK(stats.Running);
+	TEST_CHECK(stats.Events == 2);
+	TEST_CHECK(stats.EventsDropped == 0);
+	TEST_CHECK(clicks == 1);
+
+	// a 4 ms press needs better than 250 Hz, coarse sleeps would hold polling far below that. The rate achieved depends
+	// on how loaded the machine is, so it's only checked when asked for, e.g. on an idle machine with a real GPU.
+	TEST_CHECK_NEAR(stats.TargetRate, TEST_POLLING_RATE, 0.0);
+	printf("input polling at %.0f Hz of %.0f Hz asked for\n", stats.AchievedRate, stats.TargetRate);
+	if (getenv("IMGUI_OVR_TEST_TIMING"))
+	{
+		TEST_CHECK(stats.AchievedRate > 1.f / TEST_PRESS_LENGTH);
+	}
+
+	ImGui_ImplOvr_SetInputSource(nullptr, nullptr);
+	ImGui_ImplOvr_Shutdown();
+	ImGui::DestroyContext();
+	Bench_DestroyGLContext();
+	return g_TestFailures;
+}
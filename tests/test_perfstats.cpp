@@ -0,0 +1,103 @@
+// Compositor perf stats (ImGui_ImplOvr_GetPerfStatsSummary())
+// Scripts the simulated compositor's counters: dropped frames, an ASW episode, and a reset of every counter followed
+// by another drop, as ovr_ResetPerfStats() would. The summary must count each event once, including across the reset.
+
+#include "test.h"
+#include "bench.h"
+#include "GL.h"
+#include "imgui.h"
+#include "imgui_impl_ovr.h"
+#include "SimHmdBackend.h"
+
+#define TEST_FRAMES 100
+
+// HMD frames ASW is active for, and the frame the counters are reset in
+#define TEST_ASW_BEGIN 50
+#define TEST_ASW_END 60
+#define TEST_RESET_FRAME 70
+
+/**
+ * @brief The app drops frames 10, 20, 30, 70 and 80, the compositor drops frame 40, ASW synthesizes frames 50 to 59,
+ * and every counter is reset in frame 70.
+ *
+ * @param userData Unused
+ * @param frameIndex The HMD frame the compositor shows
+ * @param out_stats The stats, with the counters carried over from the previous frame
+ */
+static void Test_PerfStats(void* userData, long long frameIndex, ovrPerfStatsPerCompositorFrame* out_stats)
+{
+	if (frameIndex == TEST_RESET_FRAME)
+	{
+		out_stats->AppDroppedFrameCount = 0;
+		out_stats->CompositorDroppedFrameCount = 0;
+		out_stats->AswActivatedToggleCount = 0;
+		out_stats->AswPresentedFrameCount = 0;
+		out_stats->AswFailedFrameCount = 0;
+	}
+
+	if (frameIndex == 10 || frameIndex == 20 || frameIndex == 30 || frameIndex == TEST_RESET_FRAME || frameIndex == 80)
+	{
+		out_stats->AppDroppedFrameCount++;
+	}
+	if (frameIndex == 40)
+	{
+		out_stats->CompositorDroppedFrameCount++;
+	}
+
+	if (frameIndex == TEST_ASW_BEGIN || frameIndex == TEST_ASW_END)
+	{
+		out_stats->AswActivatedToggleCount++;
+	}
+	out_stats->AswIsActive = frameIndex >= TEST_ASW_BEGIN && frameIndex < TEST_ASW_END ? ovrTrue : ovrFalse;
+	if (out_stats->AswIsActive)
+	{
+		out_stats->AswPresentedFrameCount++;
+	}
+}
+
+int main()
+{
+	if (!Bench_CreateGLContext(true)) return 1;
+
+	SimHmdConfig config;
+	config.perfStats = Test_PerfStats;
+	SimHmdBackend hmd(config);
+	hmd.init();
+	long long frameIndex = 0;
+
+	ImGui::CreateContext();
+	ImGui::GetIO().Fonts->AddFontDefault();
+	ImGui_ImplOvr_SetCurrentContextFunc(Bench_GetCurrentGLContext);
+	ImGui_ImplOvr_Init(&hmd, &frameIndex);
+
+	for (int frame = 0; frame < TEST_FRAMES; frame++)
+	{
+		frameIndex++;
+		hmd.wait_to_begin_frame(frameIndex);
+		hmd.begin_frame(frameIndex);
+		hmd.end_frame(frameIndex, nullptr, 0);
+		ImGui_ImplOvr_PollPerfStats();
+	}
+
+	ImGui_ImplOvr_PerfStatsSummary summary;
+	ImGui_ImplOvr_GetPerfStatsSummary(&summary);
+	TEST_CHECK(summary.Frames == TEST_FRAMES);
+	TEST_CHECK(summary.FirstFrameIndex == 1);
+	TEST_CHECK(summary.LastFrameIndex == TEST_FRAMES);
+	TEST_CHECK(summary.StatsLost == 0);
+
+	// the drops in frames 70 and 80 count from 0 again after the reset, rather than being lost below the old totals
+	TEST_CHECK(summary.AppDroppedFrames == 5);
+	TEST_CHECK(summary.CompositorDroppedFrames == 1);
+	TEST_CHECK(summary.AswFrames == TEST_ASW_END - TEST_ASW_BEGIN);
+	TEST_CHECK(summary.AswActivations == 2);
+	TEST_CHECK(summary.AswPresentedFrames == TEST_ASW_END - TEST_ASW_BEGIN);
+	TEST_CHECK(summary.AswFailedFrames == 0);
+	printf("%d frames, %d app dropped, %d compositor dropped, %d ASW, %d ASW activations\n", summary.Frames,
+		summary.AppDroppedFrames, summary.CompositorDroppedFrames, summary.AswFrames, summary.AswActivations);
+
+	ImGui_ImplOvr_Shutdown();
+	ImGui::DestroyContext();
+	Bench_DestroyGLContext();
+	return g_TestFailures;
+}